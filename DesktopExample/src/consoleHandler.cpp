@@ -2,37 +2,68 @@
 #include <string>
 #include <chrono>
 #include <string.h>
+#include <errno.h>
+#include <poll.h>
 #include <unistd.h> // write(), read(), close()
 
 #include "pdulib.h"
+#include "shutdown.h"
+#include "smsSender.h"
 
-std::string menu = "Menu\n" "  [sStT] send sms\n";
+std::string menu = "Menu\n" "  [sStT] send sms\n" "  q quit\n";
 void sendSMS(int sp,int i);
 void consoleHandler(int sp) {
     char linein[10];
+    int length = 0;
     std::cout << "Console handler starting\n";
-    while (true) {
-        std::cin.getline(linein,sizeof(linein));
-        switch (linein[0]) {
-            case 's':
-                sendSMS(sp,0);
-                break;
-            case 'S':
-                sendSMS(sp,1);
-                break;
-            case 't':
-                sendSMS(sp,2);
-                break;
-            case 'T':
-                sendSMS(sp,3);
-                break;
-            default:
-                std::cout << menu;
+    struct pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0}, {shutdownFd(), POLLIN, 0}};
+    // sleep until a key is pressed or shutdown
+    while (!shutdownRequested()) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (fds[1].revents & POLLIN)
+            break;
+        // read directly, not through std::cin, so that nothing is buffered behind poll's back
+        int n = read(STDIN_FILENO, &linein[length], sizeof(linein) - 1 - length);
+        if (n <= 0)
+            break;      // no console, carry on without it
+        length += n;
+        linein[length] = 0;
+        // every complete line read so far, several may arrive at once
+        char *eol;
+        while ((eol = strchr(linein, '\n')) != NULL || length == (int)sizeof(linein) - 1) {
+            switch (linein[0]) {
+                case 's':
+                    sendSMS(sp,0);
+                    break;
+                case 'S':
+                    sendSMS(sp,1);
+                    break;
+                case 't':
+                    sendSMS(sp,2);
+                    break;
+                case 'T':
+                    sendSMS(sp,3);
+                    break;
+                case 'q':
+                    requestShutdown();
+                    break;
+                default:
+                    std::cout << menu;
+            }
+            // keep anything typed after the end of line
+            length = eol ? length - (eol + 1 - linein) : 0;
+            memmove(linein, eol ? eol + 1 : linein, length);
+            linein[length] = 0;
         }
     }
+    std::cout << "Console handler finished\n";
 }
 
-extern PDU mypdu;
+extern SMSSender *smsSender;
 
 const char *to = "**********";   // place destination phonr number here
 const char *sca = "*********";   // place your SCA number here
@@ -43,13 +74,12 @@ const char *message[] = {
   "abcd🍖😃אבגד"  // surrogate pairs
   };
 
-char writeBuf[50];   // general purpose
+// queue the message, the result is reported by the sender thread
 void sendSMS(int sp, int i) {
-  mypdu.setSCAnumber(sca);
-  int len = mypdu.encodePDU(to,message[i]);
-  sprintf(writeBuf,"AT+CMGS=%d\r\n",len);
-  write(sp,writeBuf,strlen(writeBuf));
-    // should wait for ">" but just do a delay instead
-  sleep(1);
-  write(sp,mypdu.getSMS(),strlen(mypdu.getSMS()));
-} 
+  (void)sp;
+  int id = smsSender->submit(sca,to,message[i]);
+  if (id < 0)
+    std::cout << "SMS not queued\n";
+  else
+    std::cout << "SMS " << id << " queued\n";
+}
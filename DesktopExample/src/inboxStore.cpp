@@ -0,0 +1,598 @@
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <queue>
+#include <pdulib.h>
+#include "inboxStore.h"
+
+#define SEGMENT_MAGIC "PDUINBOX"
+#define INDEX_MAGIC "PDUINDEX"
+#define STORE_VERSION 1
+#define RECORD_ALIGN 8
+
+// the first bytes of each segment file, records follow
+struct SegmentHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t number;
+    uint32_t generation;    // incremented each time the segment is opened for appending
+    uint32_t sealedTail;    // end of the last record once the segment is full, 0 until then
+    uint32_t count;         // records, once sealed
+    uint32_t reserved[9];
+};
+static_assert(sizeof(SegmentHeader) == 64, "segment header layout");
+
+struct RecordHeader {
+    uint32_t length;        // whole record with padding, written last, 0 until the record is complete
+    uint32_t checksum;      // of the rest of the header, the sender and the text
+    uint32_t ordinal;       // 0 for the first record in the segment
+    uint32_t generation;    // of the segment when written
+    int64_t epoch;
+    int16_t zone;
+    uint8_t senderLength;
+    uint8_t reserved;
+    uint16_t textLength;
+    uint16_t reserved2;
+    // sender and text follow
+};
+static_assert(sizeof(RecordHeader) == 32, "record header layout");
+
+struct IndexHeader {
+    char magic[8];
+    uint32_t number;        // of the segment
+    uint32_t count;         // entries in each array
+    uint32_t tail;          // sealedTail of the segment
+    uint32_t reserved[3];
+    // count entries by time, then count by sender hash
+};
+static_assert(sizeof(IndexHeader) == 32, "index header layout");
+
+struct InboxStore::Segment {
+    uint32_t number;
+    int fd;
+    char *base;                 // INBOX_SEGMENT_SIZE mapped
+    SegmentHeader *header;
+    uint32_t tail;
+    uint32_t count;
+    void *index;                // the index file mapped, NULL for the active segment
+    size_t indexSize;
+    const IndexEntry *byTime;
+    const IndexEntry *bySender;
+};
+
+static uint32_t fnv(const void *data, size_t length, uint32_t h = 2166136261u) {
+    const unsigned char *p = (const unsigned char *)data;
+    for (size_t i = 0; i < length; i++)
+        h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+// a leading '+' is ignored, as the receipt index does
+static const char *senderDigits(const char *sender, int *length) {
+    if (*length > 0 && sender[0] == '+') {
+        sender++;
+        (*length)--;
+    }
+    return sender;
+}
+
+static uint32_t senderHash(const char *sender, int length) {
+    sender = senderDigits(sender, &length);
+    return fnv(sender, length);
+}
+
+static uint32_t timeKey(long long epoch) {
+    return epoch < 0 ? 0 : epoch > 0xffffffffLL ? 0xffffffffu : (uint32_t)epoch;
+}
+
+static uint32_t recordChecksum(const RecordHeader *r) {
+    size_t length = sizeof(RecordHeader) - 8 + r->senderLength + r->textLength;
+    return fnv((const char *)r + 8, length);
+}
+
+static bool entryLess(const InboxStore::IndexEntry &a, const InboxStore::IndexEntry &b) {
+    return a.key < b.key || (a.key == b.key && a.offset < b.offset);
+}
+
+static int writeAll(int fd, const void *data, size_t length) {
+    const char *p = (const char *)data;
+    while (length > 0) {
+        ssize_t n = write(fd, p, length);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        p += n;
+        length -= n;
+    }
+    return 0;
+}
+
+InboxStore::InboxStore() : active(NULL), tail(0), ordinal(0), generation(0) {
+    memset(&counters, 0, sizeof(counters));
+}
+
+InboxStore::~InboxStore() {
+    close();
+}
+
+std::string InboxStore::path(uint32_t number, const char *suffix) {
+    char name[32];
+    snprintf(name, sizeof(name), "/inbox-%08u.%s", number, suffix);
+    return dir + name;
+}
+
+InboxStore::Segment *InboxStore::openSegment(uint32_t number, bool create) {
+    std::string name = path(number, "log");
+    int fd = ::open(name.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_EXCL : 0), 0644);
+    if (fd < 0)
+        return NULL;
+    if (create) {
+        // reserve the blocks now, a full disk is then an error here and not SIGBUS on a later store
+        int e = posix_fallocate(fd, 0, INBOX_SEGMENT_SIZE);
+        if (e != 0) {
+            ::close(fd);
+            unlink(name.c_str());
+            errno = e;
+            return NULL;
+        }
+    }
+    else {
+        struct stat st;
+        if (fstat(fd, &st) < 0 || st.st_size != (off_t)INBOX_SEGMENT_SIZE) {
+            ::close(fd);
+            errno = EINVAL;
+            return NULL;
+        }
+    }
+    void *base = mmap(NULL, INBOX_SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        ::close(fd);
+        return NULL;
+    }
+    Segment *s = new Segment();
+    s->number = number;
+    s->fd = fd;
+    s->base = (char *)base;
+    s->header = (SegmentHeader *)base;
+    s->tail = sizeof(SegmentHeader);
+    s->count = 0;
+    s->index = NULL;
+    s->indexSize = 0;
+    s->byTime = s->bySender = NULL;
+    if (create) {
+        memcpy(s->header->magic, SEGMENT_MAGIC, 8);
+        s->header->version = STORE_VERSION;
+        s->header->number = number;
+        msync(s->base, sizeof(SegmentHeader), MS_SYNC);
+    }
+    else if (memcmp(s->header->magic, SEGMENT_MAGIC, 8) != 0 || s->header->version != STORE_VERSION
+            || s->header->number != number) {
+        closeSegment(s);
+        errno = EINVAL;
+        return NULL;
+    }
+    return s;
+}
+
+void InboxStore::closeSegment(Segment *s) {
+    if (s->index != NULL)
+        munmap(s->index, s->indexSize);
+    munmap(s->base, INBOX_SEGMENT_SIZE);
+    ::close(s->fd);
+    delete s;
+}
+
+/*
+    Walk the records from the start of a segment, up to limit, and stop at the
+    first that is not complete: no length, out of order, from an earlier
+    generation than the one before it, or a wrong checksum.
+    Returns the end of the last good record and its index entries.
+*/
+uint32_t InboxStore::scan(Segment *s, uint32_t limit, std::vector<IndexEntry> *time, std::vector<IndexEntry> *sender) {
+    uint32_t offset = sizeof(SegmentHeader);
+    uint32_t n = 0, lastGeneration = 0;
+    while (offset + sizeof(RecordHeader) <= limit) {
+        const RecordHeader *r = (const RecordHeader *)(s->base + offset);
+        uint32_t length = r->length;
+        if (length < sizeof(RecordHeader) || length % RECORD_ALIGN != 0 || length > limit - offset
+                || r->ordinal != n || r->generation < lastGeneration
+                || sizeof(RecordHeader) + r->senderLength + r->textLength > length
+                || r->checksum != recordChecksum(r))
+            break;
+        time->push_back({timeKey(r->epoch), offset});
+        sender->push_back({senderHash((const char *)(r + 1), r->senderLength), offset});
+        lastGeneration = r->generation;
+        offset += length;
+        n++;
+    }
+    s->count = n;
+    return offset;
+}
+
+// map the index of a sealed segment, -1 if there is none or it does not match the segment
+int InboxStore::loadIndex(Segment *s) {
+    int fd = ::open(path(s->number, "idx").c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    struct stat st;
+    size_t size = sizeof(IndexHeader) + 2 * sizeof(IndexEntry) * (size_t)s->header->count;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size != size) {
+        ::close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+        return -1;
+    const IndexHeader *h = (const IndexHeader *)map;
+    if (memcmp(h->magic, INDEX_MAGIC, 8) != 0 || h->number != s->number || h->count != s->header->count
+            || h->tail != s->header->sealedTail) {
+        munmap(map, size);
+        return -1;
+    }
+    if (s->index != NULL)
+        munmap(s->index, s->indexSize);     // rewritten after a failed seal
+    s->index = map;
+    s->indexSize = size;
+    s->byTime = (const IndexEntry *)(h + 1);
+    s->bySender = s->byTime + h->count;
+    s->count = h->count;
+    s->tail = h->tail;
+    return 0;
+}
+
+// sort the entries and write them beside the segment, replacing any index there was
+int InboxStore::writeIndex(Segment *s, std::vector<IndexEntry> &time, std::vector<IndexEntry> &sender) {
+    std::sort(time.begin(), time.end(), entryLess);
+    std::sort(sender.begin(), sender.end(), entryLess);
+    IndexHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, INDEX_MAGIC, 8);
+    h.number = s->number;
+    h.count = s->header->count;
+    h.tail = s->header->sealedTail;
+    // a whole new file renamed into place, so a crash leaves either the old index or the new one
+    std::string name = path(s->number, "idx");
+    std::string temporary = name + ".tmp";
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return -1;
+    if (writeAll(fd, &h, sizeof(h)) < 0 || writeAll(fd, time.data(), time.size() * sizeof(IndexEntry)) < 0
+            || writeAll(fd, sender.data(), sender.size() * sizeof(IndexEntry)) < 0 || fsync(fd) < 0) {
+        ::close(fd);
+        unlink(temporary.c_str());
+        return -1;
+    }
+    ::close(fd);
+    if (rename(temporary.c_str(), name.c_str()) < 0)
+        return -1;
+    int dfd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dfd >= 0) {
+        fsync(dfd);
+        ::close(dfd);
+    }
+    return loadIndex(s);
+}
+
+// a sealed segment is searched through its index, made again from the records if need be
+int InboxStore::openSealed(Segment *s) {
+    if (loadIndex(s) == 0)
+        return 0;
+    std::vector<IndexEntry> time, sender;
+    uint32_t end = scan(s, s->header->sealedTail, &time, &sender);
+    if (end != s->header->sealedTail || s->count != s->header->count) {
+        errno = EIO;    // damaged, not just an incomplete last record
+        return -1;
+    }
+    counters.rebuilt++;
+    return writeIndex(s, time, sender);
+}
+
+// the segment to append to, its indexes are built in memory from the records
+int InboxStore::openActive(Segment *s) {
+    std::vector<IndexEntry> time, sender;
+    tail = scan(s, INBOX_SEGMENT_SIZE, &time, &sender);
+    ordinal = s->count;
+    std::sort(time.begin(), time.end(), entryLess);
+    activeTime.swap(time);
+    activeSender.clear();
+    activeSender.reserve(sender.size());
+    for (const IndexEntry &e : sender)
+        activeSender.emplace(e.key, e.offset);
+    // records from now on are newer than anything left after the tail
+    generation = s->header->generation + 1;
+    s->header->generation = generation;
+    if (msync(s->base, sizeof(SegmentHeader), MS_SYNC) < 0)
+        return -1;
+    active = s;
+    return 0;
+}
+
+int InboxStore::open(const char *directory) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!segments.empty()) {
+        errno = EBUSY;
+        return -1;
+    }
+    dir = directory;
+    memset(&counters, 0, sizeof(counters));
+    for (uint32_t number = 0; number < INBOX_MAX_SEGMENTS; number++) {
+        if (access(path(number, "log").c_str(), F_OK) < 0)
+            break;
+        Segment *s = openSegment(number, false);
+        if (s == NULL) {
+            closeAll();
+            return -1;
+        }
+        segments.push_back(s);
+    }
+    for (size_t i = 0; i + 1 < segments.size(); i++) {
+        if (segments[i]->header->sealedTail == 0)
+            errno = EIO;    // only the last segment may be unsealed
+        if (segments[i]->header->sealedTail == 0 || openSealed(segments[i]) < 0) {
+            closeAll();
+            return -1;
+        }
+    }
+    Segment *last = segments.empty() ? NULL : segments.back();
+    if (last != NULL && last->header->sealedTail != 0) {
+        // sealed just before the next segment was made
+        if (openSealed(last) < 0) {
+            closeAll();
+            return -1;
+        }
+        last = NULL;
+    }
+    if (last == NULL) {
+        last = openSegment(segments.size(), true);
+        if (last == NULL) {
+            closeAll();
+            return -1;
+        }
+        segments.push_back(last);
+    }
+    if (openActive(last) < 0) {
+        closeAll();
+        return -1;
+    }
+    counters.recovered = ordinal;
+    // the start of the next record from the last time the store was open, not anything older
+    const RecordHeader *next = (const RecordHeader *)(last->base + tail);
+    counters.torn = tail + sizeof(RecordHeader) <= INBOX_SEGMENT_SIZE && next->ordinal == ordinal
+        && next->generation == generation - 1 && generation > 1;
+    return 0;
+}
+
+void InboxStore::closeAll() {
+    for (Segment *s : segments)
+        closeSegment(s);
+    segments.clear();
+    active = NULL;
+    activeTime.clear();
+    activeSender.clear();
+}
+
+void InboxStore::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closeAll();
+}
+
+/*
+    The active segment is full: sync it, mark it sealed, write its index from the
+    one in memory and start the next. A crash at any point leaves either a
+    sealed segment whose index is rebuilt on open, or one still active.
+*/
+int InboxStore::seal() {
+    if (segments.size() >= INBOX_MAX_SEGMENTS) {
+        errno = ENOSPC;
+        return -1;
+    }
+    Segment *s = active;
+    if (msync(s->base, tail, MS_SYNC) < 0)
+        return -1;
+    s->header->count = ordinal;
+    s->header->sealedTail = tail;
+    if (msync(s->base, sizeof(SegmentHeader), MS_SYNC) < 0)
+        return -1;
+    s->count = ordinal;
+    s->tail = tail;
+    std::vector<IndexEntry> sender;
+    sender.reserve(activeSender.size());
+    for (const auto &e : activeSender)
+        sender.push_back({e.first, e.second});
+    if (writeIndex(s, activeTime, sender) < 0)
+        return -1;
+    Segment *next = openSegment(segments.size(), true);
+    if (next == NULL)
+        return -1;
+    segments.push_back(next);
+    activeTime.clear();
+    activeSender.clear();
+    return openActive(next);
+}
+
+void InboxStore::indexActive(uint32_t time, uint32_t hash, uint32_t offset) {
+    IndexEntry e = {time, offset};
+    // mostly in time order already, only a late SMS moves anything
+    if (activeTime.empty() || !entryLess(e, activeTime.back()))
+        activeTime.push_back(e);
+    else
+        activeTime.insert(std::upper_bound(activeTime.begin(), activeTime.end(), e, entryLess), e);
+    activeSender.emplace(hash, offset);
+}
+
+InboxStore::Id InboxStore::append(const char *sender, const char *timeStamp, const char *text, int textLength) {
+    int zone = 0;
+    long long epoch = pduTimeStampToEpoch(timeStamp, &zone);
+    if (epoch < 0) {
+        epoch = time(NULL);
+        zone = 0;
+    }
+    if (textLength < 0)
+        textLength = strlen(text);
+    return append(sender, epoch, zone, text, textLength);
+}
+
+InboxStore::Id InboxStore::append(const char *sender, long long epoch, int zone, const char *text, int textLength) {
+    size_t senderLength = strlen(sender);
+    if (senderLength > 255 || textLength < 0 || textLength > 65535)
+        return 0;
+    uint32_t length = (sizeof(RecordHeader) + senderLength + textLength + RECORD_ALIGN - 1) & ~(RECORD_ALIGN - 1);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (active == NULL)
+        return 0;
+    if (length > INBOX_SEGMENT_SIZE - tail && seal() < 0)
+        return 0;
+    RecordHeader *r = (RecordHeader *)(active->base + tail);
+    memcpy(r + 1, sender, senderLength);
+    memcpy((char *)(r + 1) + senderLength, text, textLength);
+    r->ordinal = ordinal;
+    r->generation = generation;
+    r->epoch = epoch;
+    r->zone = zone;
+    r->senderLength = senderLength;
+    r->reserved = 0;
+    r->textLength = textLength;
+    r->reserved2 = 0;
+    r->checksum = recordChecksum(r);
+    // the length makes it a record, so it is stored after everything else
+    __atomic_store_n(&r->length, length, __ATOMIC_RELEASE);
+    uint32_t offset = tail;
+    tail += length;
+    ordinal++;
+    indexActive(timeKey(epoch), senderHash(sender, senderLength), offset);
+    return (Id)active->number << 32 | offset;
+}
+
+bool InboxStore::read(Segment *s, uint32_t offset, Message *m) {
+    uint32_t end = s == active ? tail : s->tail;
+    if (offset < sizeof(SegmentHeader) || offset % RECORD_ALIGN != 0 || offset + sizeof(RecordHeader) > end)
+        return false;
+    const RecordHeader *r = (const RecordHeader *)(s->base + offset);
+    if (r->length > end - offset || sizeof(RecordHeader) + r->senderLength + r->textLength > r->length)
+        return false;
+    m->id = (Id)s->number << 32 | offset;
+    m->epoch = r->epoch;
+    m->zone = r->zone;
+    m->sender = (const char *)(r + 1);
+    m->senderLength = r->senderLength;
+    m->text = m->sender + r->senderLength;
+    m->textLength = r->textLength;
+    return true;
+}
+
+bool InboxStore::get(Id id, Message *m) {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint32_t number = id >> 32;
+    if (number >= segments.size())
+        return false;
+    Segment *s = segments[number];
+    // an id not from append may point anywhere, only a whole record is returned
+    return read(s, (uint32_t)id, m) && ((const RecordHeader *)(s->base + (uint32_t)id))->checksum
+        == recordChecksum((const RecordHeader *)(s->base + (uint32_t)id));
+}
+
+unsigned long InboxStore::bySender(const char *sender, const Visitor &visit) {
+    int length = strlen(sender);
+    uint32_t hash = senderHash(sender, length);
+    sender = senderDigits(sender, &length);
+    unsigned long visited = 0;
+    std::lock_guard<std::mutex> lock(mutex);
+    // another sender with the same hash is skipped
+    auto match = [&](Segment *s, uint32_t offset) {
+        Message m;
+        if (!read(s, offset, &m))
+            return true;
+        int n = m.senderLength;
+        const char *digits = senderDigits(m.sender, &n);
+        if (n != length || memcmp(digits, sender, n) != 0)
+            return true;
+        visited++;
+        return visit(m);
+    };
+    for (Segment *s : segments) {
+        if (s == active) {
+            std::vector<uint32_t> offsets;
+            auto range = activeSender.equal_range(hash);
+            for (auto i = range.first; i != range.second; ++i)
+                offsets.push_back(i->second);
+            std::sort(offsets.begin(), offsets.end());
+            for (uint32_t offset : offsets)
+                if (!match(s, offset))
+                    return visited;
+            continue;
+        }
+        IndexEntry key = {hash, 0};
+        const IndexEntry *end = s->bySender + s->count;
+        for (const IndexEntry *e = std::lower_bound(s->bySender, end, key, entryLess); e < end && e->key == hash; e++)
+            if (!match(s, e->offset))
+                return visited;
+    }
+    return visited;
+}
+
+unsigned long InboxStore::byTime(long long from, long long to, const Visitor &visit) {
+    if (to <= from || to <= 0)
+        return 0;
+    IndexEntry first = {timeKey(from), 0};
+    uint32_t last = to > 0xffffffffLL ? 0xffffffffu : (uint32_t)(to - 1);
+    struct Cursor {
+        const IndexEntry *e, *end;
+        Segment *s;
+    };
+    // smallest time on top, then the order stored
+    auto later = [](const Cursor &a, const Cursor &b) {
+        if (a.e->key != b.e->key)
+            return a.e->key > b.e->key;
+        return a.s->number != b.s->number ? a.s->number > b.s->number : a.e->offset > b.e->offset;
+    };
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(later)> cursors(later);
+    unsigned long visited = 0;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Segment *s : segments) {
+        const IndexEntry *begin = s == active ? activeTime.data() : s->byTime;
+        const IndexEntry *end = begin + (s == active ? activeTime.size() : s->count);
+        const IndexEntry *e = std::lower_bound(begin, end, first, entryLess);
+        if (e < end && e->key <= last)
+            cursors.push({e, end, s});
+    }
+    while (!cursors.empty()) {
+        Cursor c = cursors.top();
+        cursors.pop();
+        Message m;
+        if (read(c.s, c.e->offset, &m)) {
+            visited++;
+            if (!visit(m))
+                break;
+        }
+        if (++c.e < c.end && c.e->key <= last)
+            cursors.push(c);
+    }
+    return visited;
+}
+
+int InboxStore::sync() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (active == NULL)
+        return 0;
+    return msync(active->base, tail, MS_SYNC);
+}
+
+InboxStore::Stats InboxStore::stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats s = counters;
+    s.messages = ordinal;
+    for (Segment *segment : segments)
+        if (segment != active)
+            s.messages += segment->count;
+    s.segments = segments.size();
+    return s;
+}
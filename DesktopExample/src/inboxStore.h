@@ -0,0 +1,106 @@
+#ifdef INBOX_STORE_INCLUDE
+#else
+#define INBOX_STORE_INCLUDE
+
+#include <stdint.h>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifndef INBOX_SEGMENT_SIZE
+#define INBOX_SEGMENT_SIZE (64UL << 20)   // bytes in each segment file, at most 4GB
+#endif
+#define INBOX_MAX_SEGMENTS 65536
+
+/*
+    Keeps received SMS in a directory of append only segment files, each mapped
+    into memory, so a stored message is read in place and never copied.
+    Each record holds the sender, the SCTS as UTC seconds and time zone, and the text.
+    A segment that is full is sealed: it is synced and an index file is written
+    beside it with 2 sorted arrays of 8 byte entries, by time and by a hash of the
+    sender, which are searched in place with a binary search. The segment being
+    appended to is indexed in memory.
+    Records are checksummed and numbered, and written before their header is
+    marked valid, so on open the log is scanned from the start of the last segment
+    and ends at the first record that is not complete. Anything after it is
+    ignored from then on. An index that is missing or damaged is rebuilt.
+    All calls may be made from any thread.
+*/
+class InboxStore {
+public:
+    typedef uint64_t Id;        // segment number in the high 32 bits, offset in the low
+    struct Message {
+        Id id;
+        long long epoch;        // SCTS in seconds since 1970 UTC, or when stored if it had none
+        int zone;               // SC time zone in quarters of an hour east of UTC
+        const char *sender;     // not zero terminated, in the mapping, valid while the store is open
+        int senderLength;
+        const char *text;       // UTF-8, not zero terminated
+        int textLength;
+    };
+    struct Stats {
+        unsigned long messages;
+        int segments;
+        unsigned long recovered;    // records in the last segment found on open
+        bool torn;                  // the last segment ended in an incomplete record, which was dropped
+        int rebuilt;                // indexes rebuilt on open
+    };
+    // as stored in an index file, sorted by key then offset
+    struct IndexEntry {
+        uint32_t key;           // time or sender hash
+        uint32_t offset;
+    };
+    // return false to stop. Called with the store locked, it must not call the store
+    typedef std::function<bool(const Message &)> Visitor;
+
+    InboxStore();
+    ~InboxStore();
+    // open or create the store in dir, which must exist. -1 on error, errno is set
+    int open(const char *dir);
+    void close();
+    /*
+        Add a message. timeStamp is as getTimeStamp, converted by pduTimeStampToEpoch.
+        Returns its id, 0 on error e.g. the text is too long or the disk is full
+    */
+    Id append(const char *sender, const char *timeStamp, const char *text, int textLength = -1);
+    // as above with the time already converted
+    Id append(const char *sender, long long epoch, int zone, const char *text, int textLength);
+    bool get(Id id, Message *m);
+    // every message from sender in the order stored, returns the number visited
+    unsigned long bySender(const char *sender, const Visitor &visit);
+    // every message with from <= epoch < to, oldest first
+    unsigned long byTime(long long from, long long to, const Visitor &visit);
+    // write everything appended so far to disk
+    int sync();
+    Stats stats();
+private:
+    struct Segment;
+    std::mutex mutex;
+    std::string dir;
+    std::vector<Segment *> segments;
+    Segment *active;
+    uint32_t tail;              // where the next record goes in the active segment
+    uint32_t ordinal;           // of the next record in the active segment
+    uint32_t generation;        // of the active segment, records of an earlier one after the tail are stale
+    // the active segment's indexes, sorted by time as records arrive, by sender hash
+    std::vector<IndexEntry> activeTime;
+    std::unordered_multimap<uint32_t, uint32_t> activeSender;
+    Stats counters;
+
+    std::string path(uint32_t number, const char *suffix);
+    Segment *openSegment(uint32_t number, bool create);
+    void closeSegment(Segment *s);
+    void closeAll();
+    uint32_t scan(Segment *s, uint32_t limit, std::vector<IndexEntry> *time, std::vector<IndexEntry> *sender);
+    int loadIndex(Segment *s);
+    int writeIndex(Segment *s, std::vector<IndexEntry> &time, std::vector<IndexEntry> &sender);
+    int openSealed(Segment *s);
+    int openActive(Segment *s);
+    int seal();
+    void indexActive(uint32_t time, uint32_t hash, uint32_t offset);
+    bool read(Segment *s, uint32_t offset, Message *m);
+};
+
+#endif
@@ -0,0 +1,183 @@
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include "lineRing.h"
+
+static_assert((LINE_RING_SLOTS & (LINE_RING_SLOTS - 1)) == 0, "LINE_RING_SLOTS must be a power of 2");
+
+LineRing::LineRing() : head(0), cachedTail(0), dropped(0), highWater(0), producerWaiting(false),
+                       tail(0), cachedHead(0), measured(0), latencyMax(0), latencyTotal(0), consumerWaiting(false) {
+    spaceFd = eventfd(0, EFD_CLOEXEC);
+    dataFd = eventfd(0, EFD_CLOEXEC);
+}
+
+LineRing::~LineRing() {
+    close(spaceFd);
+    close(dataFd);
+}
+
+// block until fd or cancelFd is readable or timeout, returns true if fd was signalled
+bool LineRing::wait(int fd, int cancelFd, int timeoutMs) {
+    struct pollfd fds[2] = {{fd, POLLIN, 0}, {cancelFd, POLLIN, 0}};
+    int ready;
+    do
+        ready = poll(fds, cancelFd >= 0 ? 2 : 1, timeoutMs);
+    while (ready < 0 && errno == EINTR);    // a signal, cancelFd tells if it matters
+    if (ready <= 0)
+        return false;
+    if (fds[0].revents & POLLIN) {
+        uint64_t count;
+        if (read(fd, &count, sizeof(count)) < 0) {}    // reset the eventfd
+    }
+    return (fds[1].revents & POLLIN) == 0;
+}
+
+// time left until deadline for poll, -1 to wait for ever
+static int remainingMs(long long deadline, int timeoutMs) {
+    if (timeoutMs < 0)
+        return -1;
+    long long remaining = (deadline - lineClock()) / 1000000;
+    return remaining > 0 ? (int)remaining : 0;
+}
+
+void LineRing::signal(int fd) {
+    uint64_t one = 1;
+    if (write(fd, &one, sizeof(one)) < 0) {}
+}
+
+char *LineRing::claim() {
+    unsigned long h = head.load(std::memory_order_relaxed);
+    if (h - cachedTail == LINE_RING_SLOTS) {
+        // looks full, check again with the current tail
+        cachedTail = tail.load(std::memory_order_acquire);
+        if (h - cachedTail == LINE_RING_SLOTS)
+            return NULL;
+    }
+    return slots[h & (LINE_RING_SLOTS - 1)].line;
+}
+
+char *LineRing::waitClaim(int cancelFd, int timeoutMs) {
+    long long deadline = lineClock() + (long long)timeoutMs * 1000000;
+    for (;;) {
+        char *slot = claim();
+        if (slot != NULL)
+            return slot;
+        producerWaiting.store(true);
+        // the consumer may have popped between claim and the flag, it would not have signalled
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        slot = claim();
+        if (slot != NULL) {
+            producerWaiting.store(false);
+            return slot;
+        }
+        int remaining = remainingMs(deadline, timeoutMs);
+        bool signalled = remaining != 0 && wait(spaceFd, cancelFd, remaining);
+        producerWaiting.store(false);
+        if (!signalled && claim() == NULL)
+            return NULL;
+    }
+}
+
+void LineRing::publish(int length, long long arrived) {
+    unsigned long h = head.load(std::memory_order_relaxed);
+    Slot &slot = slots[h & (LINE_RING_SLOTS - 1)];
+    slot.length = length;
+    slot.arrived = arrived;
+    slot.line[length] = 0;     // END MARKER
+    head.store(h + 1, std::memory_order_release);
+    unsigned long waiting = h + 1 - tail.load(std::memory_order_relaxed);
+    if (waiting > highWater.load(std::memory_order_relaxed))
+        highWater.store(waiting, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumerWaiting.load(std::memory_order_relaxed))
+        signal(dataFd);
+}
+
+bool LineRing::push(const char *line, int length) {
+    char *slot = claim();
+    if (slot == NULL) {
+        drop();
+        return false;
+    }
+    if (length > MAX_LINE_LENGTH)
+        length = MAX_LINE_LENGTH;
+    memcpy(slot, line, length);
+    publish(length, lineClock());
+    return true;
+}
+
+void LineRing::drop() {
+    dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+const char *LineRing::front() {
+    unsigned long t = tail.load(std::memory_order_relaxed);
+    if (t == cachedHead) {
+        cachedHead = head.load(std::memory_order_acquire);
+        if (t == cachedHead)
+            return NULL;
+    }
+    Slot &slot = slots[t & (LINE_RING_SLOTS - 1)];
+    if (measured == t) {    // first time this line is seen by the consumer
+        measured++;
+        if (slot.arrived != 0) {
+            long long latency = lineClock() - slot.arrived;
+            latencyTotal.store(latencyTotal.load(std::memory_order_relaxed) + latency, std::memory_order_relaxed);
+            if (latency > latencyMax.load(std::memory_order_relaxed))
+                latencyMax.store(latency, std::memory_order_relaxed);
+        }
+    }
+    return slot.line;
+}
+
+const char *LineRing::waitFront(int cancelFd, int timeoutMs) {
+    long long deadline = lineClock() + (long long)timeoutMs * 1000000;
+    for (;;) {
+        const char *line = front();
+        if (line != NULL)
+            return line;
+        consumerWaiting.store(true);
+        // the producer may have published between front and the flag, it would not have signalled
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        line = front();
+        if (line != NULL) {
+            consumerWaiting.store(false);
+            return line;
+        }
+        int remaining = remainingMs(deadline, timeoutMs);
+        bool signalled = remaining != 0 && wait(dataFd, cancelFd, remaining);
+        consumerWaiting.store(false);
+        if (!signalled)
+            return front();
+    }
+}
+
+int LineRing::frontLength() {
+    return slots[tail.load(std::memory_order_relaxed) & (LINE_RING_SLOTS - 1)].length;
+}
+
+void LineRing::pop() {
+    tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (producerWaiting.load(std::memory_order_relaxed))
+        signal(spaceFd);
+}
+
+int LineRing::size() {
+    unsigned long t = tail.load(std::memory_order_acquire);   // before head so never ahead of it
+    return head.load(std::memory_order_acquire) - t;
+}
+
+LineRing::Stats LineRing::stats() {
+    Stats s;
+    s.pushed = head.load(std::memory_order_acquire);
+    s.popped = tail.load(std::memory_order_acquire);
+    s.dropped = dropped.load(std::memory_order_relaxed);
+    s.highWater = highWater.load(std::memory_order_relaxed);
+    s.latencyMax = latencyMax.load(std::memory_order_relaxed);
+    s.latencyTotal = latencyTotal.load(std::memory_order_relaxed);
+    return s;
+}
@@ -0,0 +1,77 @@
+#ifdef LINE_RING_INCLUDE
+#else
+#define LINE_RING_INCLUDE
+
+#include <atomic>
+#include <chrono>
+
+#define MAX_LINE_LENGTH 334 // when CMFG=0
+#define LINE_RING_SLOTS 64  // must be a power of 2
+
+// time stamp for measuring latency, in nanoseconds
+inline long long lineClock() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+    Lock free queue of lines from the serial port, one producer and one consumer.
+    All slots are allocated up front, the producer builds each line in place.
+    When the ring is full the producer decides whether to wait (backpressure) or
+    drop the line, drops are counted.
+    Either side may block until the other has made progress. A side that is about
+    to sleep sets a flag and the other side only signals its eventfd when the flag
+    is set, so there is no system call per line while both are busy.
+*/
+class LineRing {
+public:
+    struct Stats {
+        unsigned long pushed;
+        unsigned long popped;
+        unsigned long dropped;
+        unsigned long highWater;    // most lines ever waiting
+        long long latencyMax;       // from serial read to consumer, nanoseconds
+        long long latencyTotal;     // divide by popped for the mean
+    };
+    LineRing();
+    ~LineRing();
+    // producer side
+    char *claim();              // slot to build the next line in, NULL if full
+    void publish(int length, long long arrived = 0);   // line in the claimed slot is complete, arrived from lineClock
+    char *waitClaim(int cancelFd, int timeoutMs = -1);  // as claim but wait for a slot, NULL on timeout or cancelFd readable
+    bool push(const char *line, int length);   // copy a line, false if full and counted as dropped
+    void drop();                // count a line the producer discarded
+    // consumer side
+    const char *front();        // oldest line, NULL if empty. Valid until pop
+    const char *waitFront(int cancelFd, int timeoutMs = -1);   // as front but wait for a line
+    int frontLength();
+    void pop();
+    // any thread
+    int size();
+    Stats stats();
+private:
+    struct Slot {
+        int length;
+        long long arrived;
+        char line[MAX_LINE_LENGTH + 1];
+    };
+    // head and tail on their own cache lines, each written by only one side
+    alignas(64) std::atomic<unsigned long> head;    // next slot to publish
+    unsigned long cachedTail;                       // producer's last view of tail
+    std::atomic<unsigned long> dropped;
+    std::atomic<unsigned long> highWater;
+    std::atomic<bool> producerWaiting;
+    int spaceFd;                                    // signalled by the consumer when producerWaiting
+    alignas(64) std::atomic<unsigned long> tail;    // next slot to pop
+    unsigned long cachedHead;                       // consumer's last view of head
+    unsigned long measured;                         // slots whose latency has been counted
+    std::atomic<long long> latencyMax;
+    std::atomic<long long> latencyTotal;
+    std::atomic<bool> consumerWaiting;
+    int dataFd;                                     // signalled by the producer when consumerWaiting
+    alignas(64) Slot slots[LINE_RING_SLOTS];
+
+    static bool wait(int fd, int cancelFd, int timeoutMs);
+    static void signal(int fd);
+};
+
+#endif
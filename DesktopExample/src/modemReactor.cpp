@@ -0,0 +1,244 @@
+#include <iostream>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "modemReactor.h"
+#include "serialPort.h"
+
+// sent to each modem in turn, each waits for OK or ERROR
+static const char *initCommands[] = {
+    "ATE0\r",       // no echo
+    "AT+CLIP=1\r",  // enable callerid
+    "AT+CMGF=0\r",  // SMS PDU mode
+    "AT+CSCA?\r"    // get SCA number
+};
+#define INIT_COMMANDS (int)(sizeof(initCommands)/sizeof(initCommands[0]))
+#define MAX_EVENTS 64
+
+ModemReactor::ModemReactor(int threads) : running(false) {
+    if (threads < 1)
+        threads = 1;
+    for (int i = 0; i < threads; i++) {
+        Worker *w = new Worker;
+        w->epfd = epoll_create1(EPOLL_CLOEXEC);
+        w->wakeFd = eventfd(0, EFD_CLOEXEC);
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = NULL;     // the wake up, not a modem
+        epoll_ctl(w->epfd, EPOLL_CTL_ADD, w->wakeFd, &ev);
+        workers.emplace_back(w);
+    }
+}
+
+ModemReactor::~ModemReactor() {
+    stop();
+    for (auto &w : workers) {
+        close(w->epfd);
+        close(w->wakeFd);
+    }
+}
+
+int ModemReactor::addPort(const char *path) {
+    int fd = openSerialPort(path, true);
+    if (fd < 0)
+        return -1;
+    return addFd(fd, path);
+}
+
+int ModemReactor::addFd(int fd, const char *name) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    Modem *m = new Modem;
+    m->fd = fd;
+    m->name = name;
+    m->lineLength = 0;
+    m->stage = 0;
+    m->nextLineSMS = false;
+    m->open = true;
+    m->lines = 0;
+    m->sms = 0;
+    // share the modems out among the threads
+    m->worker = modems.size() % workers.size();
+    Worker *w = workers[m->worker].get();
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = m;
+    if (epoll_ctl(w->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        delete m;
+        return -1;
+    }
+    modems.emplace_back(m);
+    return modems.size() - 1;
+}
+
+void ModemReactor::setSMSHandler(SMSHandler handler) {
+    onSMS = handler;
+}
+
+void ModemReactor::run() {
+    if (running)
+        return;
+    running = true;
+    for (auto &w : workers)
+        w->thread = std::thread(&ModemReactor::loop, this, w.get());
+}
+
+void ModemReactor::stop() {
+    if (!running)
+        return;
+    for (auto &w : workers) {
+        uint64_t one = 1;
+        if (write(w->wakeFd, &one, sizeof(one)) < 0) {}
+    }
+    for (auto &w : workers)
+        w->thread.join();
+    // open still tells which modems never hung up
+    for (auto &m : modems)
+        if (m->open && m->fd >= 0) {
+            close(m->fd);
+            m->fd = -1;
+        }
+    running = false;
+}
+
+ModemReactor::Stats ModemReactor::stats() {
+    Stats s;
+    memset(&s, 0, sizeof(s));
+    for (auto &m : modems) {
+        s.ports++;
+        s.lines += m->lines.load(std::memory_order_relaxed);
+        s.sms += m->sms.load(std::memory_order_relaxed);
+    }
+    // these are only stable once stopped
+    for (auto &m : modems) {
+        if (m->open)
+            s.open++;
+        if (m->stage >= INIT_COMMANDS)
+            s.ready++;
+    }
+    return s;
+}
+
+void ModemReactor::loop(Worker *w) {
+    struct epoll_event events[MAX_EVENTS];
+    // start initialising this thread's modems
+    for (auto &m : modems)
+        if (workers[m->worker].get() == w)
+            send(w, m.get(), initCommands[0]);
+    for (;;) {
+        int n = epoll_wait(w->epfd, events, MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        for (int i = 0; i < n; i++) {
+            Modem *m = (Modem *)events[i].data.ptr;
+            if (m == NULL)
+                return;     // stop
+            if (events[i].events & EPOLLOUT)
+                writable(w, m);
+            if (m->open && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+                readable(w, m);
+        }
+    }
+}
+
+void ModemReactor::readable(Worker *w, Modem *m) {
+    char buf[MAX_LINE_LENGTH * 2];
+    int n = read(m->fd, buf, sizeof(buf));
+    if (n <= 0) {
+        if (n < 0 && (errno == EAGAIN || errno == EINTR))
+            return;
+        closeModem(w, m);   // hung up, e.g. unplugged
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        m->line[m->lineLength++] = buf[i];
+        // check for lf or buffer full
+        if (buf[i] == 0x0a || m->lineLength == MAX_LINE_LENGTH) {
+            m->line[m->lineLength] = 0;     // END MARKER
+            onLine(w, m);
+            m->lineLength = 0;
+            if (!m->open)
+                return;
+        }
+    }
+}
+
+void ModemReactor::onLine(Worker *w, Modem *m) {
+    const char *response = m->line;
+    m->lines.store(m->lines.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (m->nextLineSMS) {
+        m->nextLineSMS = false;
+        if (m->pdu.decodePDU(response)) {
+            m->sms.store(m->sms.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            if (onSMS)
+                onSMS(*m, m->pdu);
+        }
+    }
+    else if (strncmp(response,"+CMT:",5) == 0)    // incoming SMS, PDU on the next line
+        m->nextLineSMS = true;
+    else if (strncmp(response,"+CSCA:",6) == 0) { // SCA number, between the quotes
+        const char *start = strchr(response,'"');
+        const char *end = start ? strchr(start + 1,'"') : NULL;
+        if (end && end - start - 1 < MAX_NUMBER_LENGTH) {
+            char sca[MAX_NUMBER_LENGTH];
+            memcpy(sca, start + 1, end - start - 1);
+            sca[end - start - 1] = 0;
+            m->pdu.setSCAnumber(sca);
+        }
+    }
+    else if (m->stage < INIT_COMMANDS && (strncmp(response,"OK",2) == 0 || strncmp(response,"ERROR",5) == 0)) {
+        if (++m->stage < INIT_COMMANDS)
+            send(w, m, initCommands[m->stage]);
+    }
+}
+
+void ModemReactor::send(Worker *w, Modem *m, const char *text) {
+    int length = strlen(text);
+    int done = 0;
+    if (m->out.empty()) {
+        done = write(m->fd, text, length);
+        if (done < 0)
+            done = 0;
+    }
+    if (done < length) {
+        // keep the rest until the port can take it
+        bool arm = m->out.empty();
+        m->out.append(text + done, length - done);
+        if (arm) {
+            struct epoll_event ev;
+            ev.events = EPOLLIN | EPOLLOUT;
+            ev.data.ptr = m;
+            epoll_ctl(w->epfd, EPOLL_CTL_MOD, m->fd, &ev);
+        }
+    }
+}
+
+void ModemReactor::writable(Worker *w, Modem *m) {
+    int done = write(m->fd, m->out.data(), m->out.size());
+    if (done < 0) {
+        if (errno != EAGAIN && errno != EINTR)
+            closeModem(w, m);
+        return;
+    }
+    m->out.erase(0, done);
+    if (m->out.empty()) {
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = m;
+        epoll_ctl(w->epfd, EPOLL_CTL_MOD, m->fd, &ev);
+    }
+}
+
+void ModemReactor::closeModem(Worker *w, Modem *m) {
+    epoll_ctl(w->epfd, EPOLL_CTL_DEL, m->fd, NULL);
+    close(m->fd);
+    m->open = false;
+    std::cout << m->name << " closed\n";
+}
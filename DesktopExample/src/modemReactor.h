@@ -0,0 +1,77 @@
+#ifdef MODEM_REACTOR_INCLUDE
+#else
+#define MODEM_REACTOR_INCLUDE
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pdulib.h>
+#include "lineRing.h"   // MAX_LINE_LENGTH
+
+/*
+    Drives any number of modems from a small fixed pool of threads.
+    Each thread has its own epoll instance and owns the modems given to it,
+    so a modem is only ever touched by one thread and needs no locking.
+    Each modem has its own line framer, PDU object and output buffer, all
+    file descriptors are non blocking.
+    The modems are initialised (echo off, caller id, PDU mode, SCA query) and
+    then incoming SMS are decoded and passed to the handler.
+*/
+class ModemReactor {
+public:
+    struct Modem {
+        int fd;
+        std::string name;
+        int worker;                     // index of the owning thread
+        PDU pdu;                        // codec for this modem only
+        char line[MAX_LINE_LENGTH + 1]; // line being framed
+        int lineLength;
+        std::string out;                // waiting for the port to accept it
+        int stage;                      // next initialisation command
+        bool nextLineSMS;               // +CMT seen, PDU follows
+        bool open;
+        std::atomic<unsigned long> lines;
+        std::atomic<unsigned long> sms;
+    };
+    struct Stats {
+        int ports;
+        int open;                   // not hung up
+        int ready;                  // initialisation finished
+        unsigned long lines;
+        unsigned long sms;          // decoded successfully
+    };
+    // called on the modem's own thread for each SMS decoded
+    typedef std::function<void(Modem &, PDU &)> SMSHandler;
+
+    ModemReactor(int threads);
+    ~ModemReactor();
+    // add ports before run, -1 if the port could not be opened
+    int addPort(const char *path);
+    int addFd(int fd, const char *name);    // an open serial port or pty, set to non blocking
+    void setSMSHandler(SMSHandler handler);
+    void run();     // start the threads and return
+    void stop();    // stop and join the threads, ports are closed
+    Stats stats();
+private:
+    struct Worker {
+        int epfd;
+        int wakeFd;     // readable when the thread must stop
+        std::thread thread;
+    };
+    std::vector<std::unique_ptr<Modem>> modems;
+    std::vector<std::unique_ptr<Worker>> workers;
+    SMSHandler onSMS;
+    bool running;
+
+    void loop(Worker *w);
+    void readable(Worker *w, Modem *m);
+    void writable(Worker *w, Modem *m);
+    void onLine(Worker *w, Modem *m);
+    void send(Worker *w, Modem *m, const char *text);
+    void closeModem(Worker *w, Modem *m);
+};
+
+#endif
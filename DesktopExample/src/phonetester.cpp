@@ -1,27 +1,30 @@
 // C++ headers
 #include <iostream>
 #include <thread>
-#include <queue>
 #include <string>
 
 // C library headers
 #include <stdio.h>
 #include <string.h>
+#include <signal.h>
+#include <poll.h>
+#include <errno.h>
+#include <sys/stat.h>
 
 // Linux headers
-#include <fcntl.h> // Contains file controls like O_RDWR
-#include <errno.h> // Error integer and strerror() function
-#include <termios.h> // Contains POSIX terminal control definitions
 #include <unistd.h> // write(), read(), close()
 #include <pdulib.h>
+#include "lineRing.h"
+#include "shutdown.h"
+#include "serialPort.h"
+#include "modemReactor.h"
+#include "smsSender.h"
+#include "inboxStore.h"
 
 int serial_port;
-std::queue<std::string> inputQueue;
-
-// Create new termios struct, we call it 'tty' for convention
-// No need for "= {0}" at the end as we'll immediately write the existing
-// config to this struct
-struct termios tty;
+LineRing inputRing;     // lines from serialHandler to startup, then unsolicited
+SMSSender *smsSender;   // queue of SMS to send, for any thread
+InboxStore *inbox;      // received SMS, NULL if the store could not be opened
 
 // threads prototypes
 void serialHandler(int);
@@ -29,57 +32,102 @@ void unsolicited(int sp);
 void startup(int sp);
 void consoleHandler(int sp);
 
-// Read in existing settings, and handle any error
-// NOTE: This is important! POSIX states that the struct passed to tcsetattr()
-// must have been initialized with a call to tcgetattr() overwise behaviour
-// is undefined
 PDU mypdu = PDU();
 
-// Check for errors
+#define REACTOR_THREADS 4   // most threads used for many modems
+#define INBOX_DIR "inbox"
+
+static void onSignal(int) {
+    requestShutdown();
+}
+
+// many modems, just report incoming SMS until shutdown
+static int runReactor(int ports, char *paths[]) {
+    int threads = std::thread::hardware_concurrency();
+    if (threads > REACTOR_THREADS)
+        threads = REACTOR_THREADS;
+    if (threads > ports)
+        threads = ports;
+    ModemReactor reactor(threads);
+    for (int i = 0; i < ports; i++)
+        if (reactor.addPort(paths[i]) < 0)
+            return 1;
+    reactor.setSMSHandler([](ModemReactor::Modem &m, PDU &pdu) {
+        // one write per message so lines from different threads do not mix
+        std::string s = m.name + " SMS from " + pdu.getSender() + " " + pdu.getTimeStamp() + "\n" + pdu.getText() + "\n";
+        std::cout << s << std::flush;
+        if (inbox)
+            inbox->append(pdu.getSender(), pdu.getTimeStamp(), pdu.getText());
+    });
+    reactor.run();
+    std::cout << ports << " ports on " << threads << " threads, ctrl c to stop\n";
+    while (!shutdownRequested()) {
+        struct pollfd pfd = {shutdownFd(), POLLIN, 0};
+        poll(&pfd, 1, -1);
+    }
+    reactor.stop();
+    ModemReactor::Stats stats = reactor.stats();
+    std::cout << "Ports " << stats.ports << " ready " << stats.ready << " still open " << stats.open
+              << " lines " << stats.lines << " SMS " << stats.sms << std::endl;
+    return 0;
+}
+
 int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        std::cout <<"Usage: pduapp serial_port\n\n";
+    if (argc < 2) {
+        std::cout <<"Usage: pduapp serial_port [serial_port ...]\n\n";
         return 1;
     }
+    initShutdown();
+    signal(SIGINT, onSignal);    // ctrl c
+    signal(SIGTERM, onSignal);
+    // received SMS are kept in the current directory
+    InboxStore store;
+    if ((mkdir(INBOX_DIR, 0755) == 0 || errno == EEXIST) && store.open(INBOX_DIR) == 0) {
+        InboxStore::Stats stats = store.stats();
+        std::cout << "Inbox " << stats.messages << " SMS";
+        if (stats.torn)
+            std::cout << ", an incomplete SMS was dropped";
+        std::cout << std::endl;
+        inbox = &store;
+    }
+    else
+        std::cout << "Inbox " INBOX_DIR " could not be opened, received SMS are not kept\n";
+    if (argc > 2)
+        return runReactor(argc - 1, &argv[1]);
 
     std::cout << argv[1] << std::endl; 
-    serial_port = open(argv[1], O_RDWR);
-    if (serial_port < 0) 
-        std::cout << "Error " << errno << " from open:" << strerror(errno) << std::endl;
-    else {
-        std::cout << argv[1] << " opened\n";
-        if(tcgetattr(serial_port, &tty) != 0) {
-            std::cout << "Error " << errno << "from tcgetattr: " << strerror(errno) << std::endl;
-        }
-        else {
-            // set 8 bits baud rate 9600 No parity, 1 stop , no flow control
-            tty.c_cflag &= ~PARENB;
-            tty.c_cflag &= ~CSTOPB;
-            tty.c_cflag &= ~CSIZE; // Clear all the size bits
-            tty.c_cflag |= CS8;
-            tty.c_cflag &= ~CRTSCTS; // Disable RTS/CTS hardware flow control
-            tty.c_lflag &= ~ICANON;  // disable canonical mode
-            tty.c_lflag &= ~ECHO; // Disable echo
-            tty.c_lflag &= ~ISIG; // Disable interpretation of INTR, QUIT and SUSP
-            tty.c_iflag &= ~ICRNL;  // do not translate cr to lf
-            tty.c_iflag &= ~IGNCR;  // do not ignore cr
-            // Set in/out baud rate to be 9600
-            cfsetispeed(&tty, B9600);
-            cfsetospeed(&tty, B9600);
-            // Save tty settings, also checking for error
-            if (tcsetattr(serial_port, TCSANOW, &tty) != 0) 
-                std::cout << "Error" << errno << " from tcsetattr: " << strerror(errno) << std::endl;
-            else {
-               std::cout << "Attributes all set\n";
-               std::thread t1(serialHandler,serial_port);
-               std::thread t2(startup,serial_port);
-               t2.join();  // wait until startup finished
-               std::thread t3(unsolicited,serial_port);
-               std::thread t4(consoleHandler,serial_port);
-               while (true) {}
-            }
+    serial_port = openSerialPort(argv[1]);
+    if (serial_port >= 0) {
+        std::cout << argv[1] << " opened, attributes all set\n";
+        SMSSender sender(serial_port);
+        smsSender = &sender;
+        sender.setResultHandler([](const SMSSender::Result &r) {
+            std::cout << "SMS " << r.id << " part " << r.part << "/" << r.parts;
+            if (r.status == SEND_OK)
+                std::cout << " sent, reference " << r.mr << std::endl;
+            else if (r.status == SEND_CMS_ERROR)
+                std::cout << " failed, +CMS ERROR " << r.error << std::endl;
+            else
+                std::cout << (r.status == SEND_TIMEOUT ? " timed out\n" : r.status == SEND_CANCELLED ? " cancelled\n" : " failed\n");
+        });
+        std::thread t1(serialHandler,serial_port);
+        std::thread t2(startup,serial_port);
+        t2.join();  // wait until startup finished
+        if (!shutdownRequested()) {
+            std::thread t3(unsolicited,serial_port);
+            std::thread t4(consoleHandler,serial_port);
+            std::thread t5(&SMSSender::run,&sender,shutdownFd());
+            // all threads sleep until there is work, here until they have all finished
+            t3.join();
+            t4.join();
+            t5.join();
         }
+        t1.join();
+        LineRing::Stats stats = inputRing.stats();
+        std::cout << "Lines " << stats.pushed << " dropped " << stats.dropped << " most waiting " << stats.highWater << std::endl;
+        if (stats.popped > 0)
+            std::cout << "Latency serial to handler mean " << stats.latencyTotal / stats.popped / 1000
+                      << "us max " << stats.latencyMax / 1000 << "us\n";
         close(serial_port);
     }
 }
-
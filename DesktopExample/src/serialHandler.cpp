@@ -1,6 +1,4 @@
 #include <iostream>
-#include <string>
-#include <queue>
 // C library headers
 //#include <stdio.h>
 //#include <string.h>
@@ -9,36 +7,76 @@
 //#include <fcntl.h> // Contains file controls like O_RDWR
 //#include <errno.h> // Error integer and strerror() function
 //#include <termios.h> // Contains POSIX terminal control definitions
+#include <errno.h>
+#include <poll.h>
 #include <unistd.h> // write(), read(), close()
+#include "lineRing.h"
+#include "shutdown.h"
+
+#define FULL_WAIT_MS 100    // how long to stop reading when the ring is full, before dropping lines
 
 // Allocate memory for read buffer, set size according to your needs
-#define MAX_LINE_LENGTH 334 // when CMFG=0
-static char linebuf[MAX_LINE_LENGTH+10];
 static char read_buf [MAX_LINE_LENGTH*2];
-int lineoffset = 0;
-//int lineNumber = 0;
-extern std::queue<std::string> inputQueue;
+static char scratch[MAX_LINE_LENGTH+1];     // a line that is being dropped
+extern LineRing inputRing;
 
 void serialHandler(int sp) {
-        // now endless loop to read and display incoming data
+        // now loop until shutdown to read and pass on incoming data
     std::cout << "serial thread started\n";
-    int inOffset;
-    while (true) {
-        int nSerIn = read(sp,read_buf,sizeof(read_buf));
-        if (nSerIn > 0) {
-//            fwrite(read_buf,1,nSerIn,stdout);
-            // buffer into individual lines
+    int nSerIn = 0;
+    int inOffset = 0;
+    long long arrived = 0;  // when read_buf was filled
+    char *line = NULL;      // slot the current line is built in
+    int lineoffset = 0;
+    struct pollfd fds[2] = {{sp, POLLIN, 0}, {shutdownFd(), POLLIN, 0}};
+    while (!shutdownRequested()) {
+        if (inOffset == nSerIn) {
+            // sleep until there is input or shutdown
+            if (poll(fds, 2, -1) < 0) {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            if (fds[1].revents & POLLIN)
+                break;
+            nSerIn = read(sp,read_buf,sizeof(read_buf));
+            arrived = lineClock();
             inOffset = 0;
-            while (inOffset < nSerIn) {
-                linebuf[lineoffset++] = read_buf[inOffset++];
-                // check for cr/lf or buffer full
-                // if so print contents and reset offset
-                if (linebuf[lineoffset-1] == 0x0a || lineoffset == MAX_LINE_LENGTH) {
-                    linebuf[lineoffset] = 0;    // END MARKER
-                    inputQueue.push(std::string(linebuf));
-                    lineoffset = 0;
+            if (nSerIn <= 0) {
+                if ((nSerIn == 0 && (fds[0].revents & POLLHUP)) || (nSerIn < 0 && errno != EINTR && errno != EAGAIN)) {
+                    std::cout << "serial port closed\n";   // e.g. modem unplugged
+                    requestShutdown();
+                    break;
                 }
-            }       
+                nSerIn = 0;
+                continue;
+            }
+        }
+        if (line == NULL) {
+            // backpressure, leave further input in the tty buffer until the consumer catches up
+            line = inputRing.waitClaim(shutdownFd(), FULL_WAIT_MS);
+            if (line == NULL) {
+                if (shutdownRequested())
+                    break;
+                line = scratch;     // consumer is stuck, drop this line
+            }
+        }
+        // buffer into individual lines
+        while (inOffset < nSerIn) {
+            line[lineoffset++] = read_buf[inOffset++];
+            // check for cr/lf, the AT+CMGS prompt (which has no cr/lf) or buffer full
+            // if so pass it on and reset offset
+            if (line[lineoffset-1] == 0x0a || lineoffset == MAX_LINE_LENGTH ||
+                    (lineoffset == 2 && line[0] == '>' && line[1] == ' ')) {
+                if (line == scratch)
+                    inputRing.drop();
+                else
+                    inputRing.publish(lineoffset, arrived);
+                line = NULL;
+                lineoffset = 0;
+                break;
+            }
         }
     }
+    std::cout << "serial thread finished\n";
 }
@@ -0,0 +1,55 @@
+#include <iostream>
+#include <string.h>
+#include <fcntl.h> // Contains file controls like O_RDWR
+#include <errno.h> // Error integer and strerror() function
+#include <termios.h> // Contains POSIX terminal control definitions
+#include <unistd.h> // write(), read(), close()
+#include "serialPort.h"
+
+bool configureSerialPort(int fd) {
+    // Create new termios struct, we call it 'tty' for convention
+    // No need for "= {0}" at the end as we'll immediately write the existing
+    // config to this struct
+    struct termios tty;
+    // Read in existing settings, and handle any error
+    // NOTE: This is important! POSIX states that the struct passed to tcsetattr()
+    // must have been initialized with a call to tcgetattr() overwise behaviour
+    // is undefined
+    if(tcgetattr(fd, &tty) != 0) {
+        std::cout << "Error " << errno << "from tcgetattr: " << strerror(errno) << std::endl;
+        return false;
+    }
+    // set 8 bits baud rate 9600 No parity, 1 stop , no flow control
+    tty.c_cflag &= ~PARENB;
+    tty.c_cflag &= ~CSTOPB;
+    tty.c_cflag &= ~CSIZE; // Clear all the size bits
+    tty.c_cflag |= CS8;
+    tty.c_cflag &= ~CRTSCTS; // Disable RTS/CTS hardware flow control
+    tty.c_lflag &= ~ICANON;  // disable canonical mode
+    tty.c_lflag &= ~ECHO; // Disable echo
+    tty.c_lflag &= ~ISIG; // Disable interpretation of INTR, QUIT and SUSP
+    tty.c_iflag &= ~ICRNL;  // do not translate cr to lf
+    tty.c_iflag &= ~IGNCR;  // do not ignore cr
+    // Set in/out baud rate to be 9600
+    cfsetispeed(&tty, B9600);
+    cfsetospeed(&tty, B9600);
+    // Save tty settings, also checking for error
+    if (tcsetattr(fd, TCSANOW, &tty) != 0) {
+        std::cout << "Error" << errno << " from tcsetattr: " << strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int openSerialPort(const char *path, bool nonBlocking) {
+    int fd = open(path, O_RDWR | O_NOCTTY | (nonBlocking ? O_NONBLOCK : 0));
+    if (fd < 0) {
+        std::cout << "Error " << errno << " from open:" << strerror(errno) << std::endl;
+        return -1;
+    }
+    if (!configureSerialPort(fd)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
@@ -0,0 +1,13 @@
+#ifdef SERIAL_PORT_INCLUDE
+#else
+#define SERIAL_PORT_INCLUDE
+
+/*
+    Open a serial port to a modem, 8 bits 9600 baud no parity, 1 stop, no flow control,
+    raw input. Returns the file descriptor, -1 on error (already reported on std::cout)
+*/
+int openSerialPort(const char *path, bool nonBlocking = false);
+// apply the same settings to a port that is already open, false on error
+bool configureSerialPort(int fd);
+
+#endif
@@ -0,0 +1,26 @@
+#include <atomic>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include "shutdown.h"
+
+static int stopFd = -1;
+static std::atomic<bool> stopping(false);
+
+void initShutdown() {
+    stopFd = eventfd(0, EFD_CLOEXEC);
+}
+
+void requestShutdown() {
+    uint64_t one = 1;
+    stopping.store(true);
+    if (write(stopFd, &one, sizeof(one)) < 0) {}  // only fails if the counter overflows
+}
+
+bool shutdownRequested() {
+    return stopping.load();
+}
+
+int shutdownFd() {
+    return stopFd;
+}
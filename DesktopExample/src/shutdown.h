@@ -0,0 +1,14 @@
+#ifdef SHUTDOWN_INCLUDE
+#else
+#define SHUTDOWN_INCLUDE
+
+/*
+    Orderly shutdown of all threads. Threads that block include shutdownFd()
+    in their poll, it becomes readable once shutdown has been requested and stays so.
+*/
+void initShutdown();        // call before any threads are started
+void requestShutdown();     // safe to call from a signal handler
+bool shutdownRequested();
+int shutdownFd();
+
+#endif
@@ -0,0 +1,350 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include "smsSender.h"
+#include "lineRing.h"   // lineClock
+
+#define CTRL_ESC "\x1b"     // abandons the prompt or a PDU not yet ended by CTRL/Z
+
+// all of it, the serial port may take it in pieces
+static void writeAll(int fd, const char *data, int length) {
+    while (length > 0) {
+        int n = write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        data += n;
+        length -= n;
+    }
+}
+
+SMSSender::SMSSender(int port) : sp(port), nextId(0), nextReference(0), nextMessageReference(0), senderWaiting(false),
+        pipelined(false), submitted(0), rejected(0), head(0), eventHead(0), eventTail(0), tail(0), state(IDLE),
+        deadline(0), writing(-1), mr(-1), sent(0), failed(0), timeouts(0), receipts(RECEIPT_TIMEOUT_S) {
+    wakeFd = eventfd(0, EFD_CLOEXEC);
+    for (unsigned long i = 0; i < SEND_QUEUE_SLOTS; i++)
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+SMSSender::~SMSSender() {
+    close(wakeFd);
+}
+
+void SMSSender::setResultHandler(ResultHandler handler) {
+    onResult = handler;
+}
+
+void SMSSender::setPipelined(bool on) {
+    pipelined = on;
+}
+
+SMSSender::Stats SMSSender::stats() {
+    Stats s;
+    s.submitted = submitted.load(std::memory_order_relaxed);
+    s.sent = sent.load(std::memory_order_relaxed);
+    s.failed = failed.load(std::memory_order_relaxed);
+    s.timeouts = timeouts.load(std::memory_order_relaxed);
+    s.rejected = rejected.load(std::memory_order_relaxed);
+    return s;
+}
+
+// signal the sender thread only if it is asleep, or about to be
+void SMSSender::wake() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (senderWaiting.load(std::memory_order_relaxed) && senderWaiting.exchange(false)) {
+        uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0) {}
+    }
+}
+
+// consecutive slots from any thread, returns the position of the first, -1 if full
+long SMSSender::reserve(int count) {
+    unsigned long pos = head.load(std::memory_order_relaxed);
+    for (;;) {
+        bool room = true;
+        for (int i = 0; i < count && room; i++)
+            room = slots[(pos + i) & (SEND_QUEUE_SLOTS - 1)].sequence.load(std::memory_order_acquire) == pos + i;
+        if (room) {
+            if (head.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+                return (long)pos;
+        }
+        else {
+            unsigned long now = head.load(std::memory_order_relaxed);
+            if (now == pos)
+                return -1;
+            pos = now;      // another producer got in first
+        }
+    }
+}
+
+int SMSSender::submit(const char *sca, const char *recipient, const char *message) {
+    PDU pdu;    // this submission's own codec
+    pdu.setSCAnumber(sca);
+    pdu.setStatusReport(true);
+    int parts = pdu.beginMultipart(recipient, message, nextReference.fetch_add(1, std::memory_order_relaxed) & 0xff);
+    if (parts <= 0 || parts > SEND_QUEUE_SLOTS) {
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+    // a slot for every part at once, so the parts are sent one after the other
+    long reserved = reserve(parts);
+    if (reserved < 0) {
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+    unsigned long pos = reserved;
+    // SEND_ID_LIMIT is a power of 2, so the ids carry on from 1 when the counter wraps
+    int id = (int)(nextId.fetch_add(1, std::memory_order_relaxed) % SEND_ID_LIMIT) + 1;
+    // a TP-MR for each part, the codec counts up from the first
+    pdu.setMessageReference(nextMessageReference.fetch_add(parts, std::memory_order_relaxed));
+    for (int i = 0; i < parts; i++) {
+        Slot *s = &slots[(pos + i) & (SEND_QUEUE_SLOTS - 1)];
+        s->id = id;
+        s->part = i + 1;
+        s->parts = parts;
+        strncpy(s->recipient, recipient, MAX_NUMBER_LENGTH - 1);
+        s->recipient[MAX_NUMBER_LENGTH - 1] = 0;
+        s->length = pdu.encodeNextPart(s->pdu, sizeof(s->pdu));
+        if (s->length > 0 && pduFrameSubmit(&s->frame, s->length, s->pdu) < 0)
+            s->length = -1;     // start reports SEND_ERROR
+        s->sequence.store(pos + i + 1, std::memory_order_release);
+    }
+    submitted.fetch_add(parts, std::memory_order_relaxed);
+    wake();
+    return id;
+}
+
+bool SMSSender::command(const char *line) {
+    size_t length = strlen(line);
+    if (length == 0 || length >= sizeof(slots[0].pdu))
+        return false;
+    long pos = reserve(1);
+    if (pos < 0)
+        return false;
+    Slot *s = &slots[pos & (SEND_QUEUE_SLOTS - 1)];
+    s->id = 0;
+    s->part = 0;
+    s->parts = 0;
+    s->length = (int)length;
+    memcpy(s->pdu, line, length + 1);
+    s->frame.segment[PDU_FRAME_COMMAND].iov_base = s->pdu;
+    s->frame.segment[PDU_FRAME_COMMAND].iov_len = length;
+    s->frame.segment[PDU_FRAME_PDU].iov_base = s->pdu + length;
+    s->frame.segment[PDU_FRAME_PDU].iov_len = 0;
+    s->frame.first = PDU_FRAME_COMMAND;
+    s->sequence.store(pos + 1, std::memory_order_release);
+    wake();
+    return true;
+}
+
+bool SMSSender::report(const char *pdu, Receipt *receipt) {
+    PDU codec;
+    PDUStatusReport r;
+    if (!codec.decodeStatusReport(pdu, &r))
+        return false;
+    unsigned long tag;
+    {
+        std::lock_guard<std::mutex> lock(receiptLock);
+        if (!receipts.match(&r, &tag))
+            return false;
+    }
+    receipt->id = (int)(tag / SEND_QUEUE_SLOTS) + 1;
+    receipt->part = (int)(tag % SEND_QUEUE_SLOTS) + 1;
+    receipt->state = pduDeliveryState(r.status);
+    receipt->status = r.status;
+    return true;
+}
+
+void SMSSender::response(const char *line) {
+    Event e;
+    e.value = 0;
+    if (line[0] == '>')
+        e.type = EVENT_PROMPT;
+    else if (strncmp(line, "OK", 2) == 0)
+        e.type = EVENT_OK;
+    else if (strncmp(line, "ERROR", 5) == 0)
+        e.type = EVENT_ERROR;
+    else if (strncmp(line, "+CMGS:", 6) == 0) {
+        e.type = EVENT_CMGS;
+        e.value = atoi(line + 6);
+    }
+    else if (strncmp(line, "+CMS ERROR:", 11) == 0) {
+        e.type = EVENT_CMS_ERROR;
+        e.value = atoi(line + 11);
+    }
+    else
+        return;     // nothing to do with sending
+    unsigned long h = eventHead.load(std::memory_order_relaxed);
+    if (h - eventTail.load(std::memory_order_acquire) == SEND_EVENT_SLOTS)
+        return;     // sender not running, nobody is waiting for it
+    events[h & (SEND_EVENT_SLOTS - 1)] = e;
+    eventHead.store(h + 1, std::memory_order_release);
+    wake();
+}
+
+void SMSSender::run(int cancelFd) {
+    struct pollfd fds[3] = {{wakeFd, POLLIN, 0}, {cancelFd, POLLIN, 0}, {-1, POLLOUT, 0}};
+    for (;;) {
+        // modem responses first, they may finish the current part
+        unsigned long t = eventTail.load(std::memory_order_relaxed);
+        while (t != eventHead.load(std::memory_order_acquire)) {
+            handle(events[t & (SEND_EVENT_SLOTS - 1)]);
+            eventTail.store(++t, std::memory_order_release);
+        }
+        Slot *s = &slots[tail & (SEND_QUEUE_SLOTS - 1)];
+        bool queued = s->sequence.load(std::memory_order_acquire) == tail + 1;
+        if (state == IDLE && queued) {
+            start(s);
+            continue;
+        }
+        long long now = lineClock();
+        if (state != IDLE && now >= deadline) {
+            if (state != WAIT_REPLY)
+                writeAll(sp, CTRL_ESC, 1);
+            finish(s, SEND_TIMEOUT, 0);
+            continue;
+        }
+        // sleep until a submission, a response, room for the rest of a frame, the deadline or cancelled
+        fds[2].fd = writing >= 0 ? sp : -1;
+        int timeout = state == IDLE ? -1 : (int)((deadline - now + 999999) / 1000000);
+        senderWaiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (eventHead.load(std::memory_order_relaxed) != t ||
+                (state == IDLE && s->sequence.load(std::memory_order_acquire) == tail + 1)) {
+            senderWaiting.store(false, std::memory_order_relaxed);
+            continue;
+        }
+        int ready = poll(fds, 3, timeout);
+        senderWaiting.store(false, std::memory_order_relaxed);
+        if (ready < 0 && errno != EINTR)
+            break;
+        if (ready > 0 && (fds[1].revents & POLLIN))
+            break;
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            uint64_t count;
+            if (read(wakeFd, &count, sizeof(count)) < 0) {}
+        }
+        if (ready > 0 && writing >= 0 && fds[2].revents != 0)
+            resume(s);
+    }
+    // report whatever will now never be sent
+    if (state == WAIT_PROMPT || state == WAIT_RESULT)
+        writeAll(sp, CTRL_ESC, 1);
+    for (;;) {
+        Slot *s = &slots[tail & (SEND_QUEUE_SLOTS - 1)];
+        if (state == IDLE && s->sequence.load(std::memory_order_acquire) != tail + 1)
+            break;
+        finish(s, SEND_CANCELLED, 0);
+    }
+}
+
+// send AT+CMGS for the part at the head of the queue, or the command
+void SMSSender::start(Slot *s) {
+    if (s->parts == 0) {
+        send(s, PDU_FRAME_COMMAND, WAIT_REPLY, COMMAND_TIMEOUT_MS);
+        return;
+    }
+    if (s->length <= 0) {
+        finish(s, SEND_ERROR, 0);   // could not be encoded
+        return;
+    }
+    mr = -1;
+    if (pipelined)
+        send(s, PDU_FRAME_PDU, WAIT_RESULT, RESULT_TIMEOUT_MS);   // the prompt is ignored
+    else
+        send(s, PDU_FRAME_COMMAND, WAIT_PROMPT, PROMPT_TIMEOUT_MS);
+}
+
+// write the frame up to segment last and wait in state next, what the port does not take now is resumed when it has room
+void SMSSender::send(Slot *s, int last, eState next, int timeoutMs) {
+    state = next;
+    deadline = lineClock() + timeoutMs * 1000000LL;
+    writing = last;
+    resume(s);
+}
+
+void SMSSender::resume(Slot *s) {
+    int left = pduFrameWrite(sp, &s->frame, writing);
+    if (left > 0)
+        return;     // run polls for room
+    writing = -1;
+    if (left < 0) {
+        if (s->parts > 0)
+            writeAll(sp, CTRL_ESC, 1);  // the modem may be waiting for the rest of the PDU
+        finish(s, SEND_ERROR, 0);
+    }
+}
+
+void SMSSender::handle(const Event &e) {
+    if (state == IDLE)
+        return;     // response to some other command
+    Slot *s = &slots[tail & (SEND_QUEUE_SLOTS - 1)];
+    switch (e.type) {
+        case EVENT_PROMPT:
+            if (state == WAIT_PROMPT && writing < 0)
+                send(s, PDU_FRAME_PDU, WAIT_RESULT, RESULT_TIMEOUT_MS);
+            break;
+        case EVENT_CMGS:
+            if (state == WAIT_RESULT)
+                mr = e.value;
+            break;
+        case EVENT_OK:
+            // an OK before +CMGS belongs to some other command
+            if ((state == WAIT_RESULT && mr >= 0) || state == WAIT_REPLY)
+                finish(s, SEND_OK, 0);
+            break;
+        case EVENT_ERROR:
+            // answers what the sender last wrote, other threads queue their commands too
+            if (state == WAIT_PROMPT || state == WAIT_RESULT || state == WAIT_REPLY)
+                finish(s, SEND_ERROR, 0);
+            break;
+        case EVENT_CMS_ERROR:
+            finish(s, SEND_CMS_ERROR, e.value);
+            break;
+    }
+}
+
+// report the part at the head of the queue and free its slot, a command is not reported
+void SMSSender::finish(Slot *s, eSendStatus status, int error) {
+    writing = -1;
+    if (s->parts == 0) {
+        state = IDLE;
+        s->sequence.store(tail + SEND_QUEUE_SLOTS, std::memory_order_release);
+        tail++;
+        return;
+    }
+    Result r;
+    r.id = s->id;
+    r.part = s->part;
+    r.parts = s->parts;
+    r.status = status;
+    r.mr = status == SEND_OK ? mr : -1;
+    r.error = error;
+    switch (status) {
+        case SEND_OK: {
+            sent.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(receiptLock);
+            receipts.add(mr, s->recipient, (unsigned long)(s->id - 1) * SEND_QUEUE_SLOTS + s->part - 1,
+                         lineClock() / 1000000000);
+            break;
+        }
+        case SEND_TIMEOUT:
+            timeouts.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case SEND_CANCELLED:
+            break;
+        default:
+            failed.fetch_add(1, std::memory_order_relaxed);
+    }
+    state = IDLE;
+    s->sequence.store(tail + SEND_QUEUE_SLOTS, std::memory_order_release);
+    tail++;
+    if (onResult)
+        onResult(r);
+}
@@ -0,0 +1,158 @@
+#ifdef SMS_SENDER_INCLUDE
+#else
+#define SMS_SENDER_INCLUDE
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <pdulib.h>
+#include <pduframe.h>
+#include <pdureceipts.h>
+
+#define SEND_QUEUE_SLOTS 64         // must be a power of 2, also the most parts in one message
+#define PROMPT_TIMEOUT_MS 5000      // AT+CMGS to the "> " prompt
+#define RESULT_TIMEOUT_MS 60000     // PDU to +CMGS and OK, includes the network
+#define COMMAND_TIMEOUT_MS 5000     // any other command to OK or ERROR
+#define SEND_EVENT_SLOTS 16         // modem responses not yet seen by the sender, must be a power of 2
+#define RECEIPT_TIMEOUT_S 259200    // parts sent are forgotten after 3 days without a final status report
+#define SEND_ID_LIMIT (0x80000000UL / SEND_QUEUE_SLOTS)   // ids wrap after this, id and part fit a 32 bit receipt tag
+
+enum eSendStatus {
+    SEND_OK,            // mr is the message reference from +CMGS
+    SEND_ERROR,         // the modem answered ERROR
+    SEND_CMS_ERROR,     // error is the +CMS ERROR code
+    SEND_TIMEOUT,       // no prompt or no result in time, the PDU was aborted with ESC
+    SEND_CANCELLED      // still queued at shutdown
+};
+
+/*
+    Sends SMS through a modem in PDU mode, one at a time as the modem allows.
+    Any number of threads may submit messages. Each submission is encoded with its
+    own PDU object in the submitting thread, straight into slots of a bounded lock
+    free queue, so nothing is shared between submitters.
+    The sender thread (run) writes AT+CMGS, waits for the "> " prompt, writes the
+    PDU and waits for +CMGS: <mr> and OK, or ERROR/+CMS ERROR, each with a timeout.
+    The frame of each part is made by the submitter too, so the sender thread only
+    calls writev, with nothing to format or copy.
+    Every part asks for a status report. TP-MR comes from one counter for the
+    sender, so parts queued together never share a reference, and each part sent
+    is remembered by its +CMGS reference and recipient until its report arrives.
+    It is told about modem output through response, called by whichever thread
+    reads the serial port, and sleeps on an eventfd whenever it has nothing to do.
+    Other commands are queued with command and written by the sender thread in
+    turn, so an OK or ERROR always belongs to whatever it last wrote.
+*/
+class SMSSender {
+public:
+    struct Result {
+        int id;             // as returned by submit
+        int part;           // 1 to parts
+        int parts;
+        eSendStatus status;
+        int mr;             // message reference, for status reports
+        int error;          // +CMS ERROR code
+    };
+    struct Receipt {
+        int id;             // as returned by submit
+        int part;
+        eDeliveryState state;
+        int status;         // TP-ST
+    };
+    struct Stats {
+        unsigned long submitted;    // parts
+        unsigned long sent;
+        unsigned long failed;       // ERROR or +CMS ERROR
+        unsigned long timeouts;
+        unsigned long rejected;     // submit failed, queue full or invalid
+    };
+    // called on the sender thread
+    typedef std::function<void(const Result &)> ResultHandler;
+
+    SMSSender(int sp);
+    ~SMSSender();
+    void setResultHandler(ResultHandler handler);
+    /*
+        Write AT+CMGS and the PDU together, in one writev, without waiting for the prompt.
+        Only for a modem that keeps what follows the command until it prompts. Off by default
+    */
+    void setPipelined(bool on);
+    /*
+        Encode a message of any length and queue all its parts, from any thread.
+        Returns an id passed back in the results and status reports, counting from 1 to
+        SEND_ID_LIMIT and then from 1 again. -1 if the message is invalid or
+        the queue has no room for all the parts
+    */
+    int submit(const char *sca, const char *recipient, const char *message);
+    /*
+        A status report, the PDU of a +CDS notification, from any thread.
+        Returns true with the part it reports on, false if it is not for a part sent here
+    */
+    bool report(const char *pdu, Receipt *receipt);
+    /*
+        Queue any other command, ending in CR, from any thread. It is written between
+        SMS parts and finished by OK or ERROR, nothing is reported.
+        Returns false if it is too long or the queue is full
+    */
+    bool command(const char *line);
+    // a line from the modem, any thread but only one at a time
+    void response(const char *line);
+    // the sender thread, returns when cancelFd is readable
+    void run(int cancelFd);
+    Stats stats();
+private:
+    enum eEvent {EVENT_PROMPT, EVENT_OK, EVENT_ERROR, EVENT_CMGS, EVENT_CMS_ERROR};
+    enum eState {IDLE, WAIT_PROMPT, WAIT_RESULT, WAIT_REPLY};
+    struct Slot {
+        std::atomic<unsigned long> sequence;    // position + 1 when full, position when free
+        int id;
+        int part;
+        int parts;                              // 0 for a command
+        int length;                             // for AT+CMGS
+        char recipient[MAX_NUMBER_LENGTH];      // for the status report
+        char pdu[PDU_BINARY_MAX_LENGTH * 2 + 2];  // printable, CTRL/Z and end marker, or the command
+        PDUFrame frame;                         // AT+CMGS and pdu, or the command alone
+    };
+    struct Event {
+        eEvent type;
+        int value;
+    };
+    int sp;
+    ResultHandler onResult;
+    std::atomic<unsigned int> nextId;   // wraps, reduced to an id by submit
+    std::atomic<unsigned short> nextReference;      // concatenation
+    std::atomic<unsigned char> nextMessageReference;  // TP-MR
+    std::atomic<bool> senderWaiting;
+    bool pipelined;
+    int wakeFd;
+    std::atomic<unsigned long> submitted;
+    std::atomic<unsigned long> rejected;
+    // producers
+    alignas(64) std::atomic<unsigned long> head;
+    // response side, single producer
+    alignas(64) std::atomic<unsigned long> eventHead;
+    Event events[SEND_EVENT_SLOTS];
+    // sender thread only
+    alignas(64) std::atomic<unsigned long> eventTail;
+    unsigned long tail;
+    eState state;
+    long long deadline;         // for the current state, from lineClock
+    int writing;                // last frame segment the port has not yet taken in full, -1 when none
+    int mr;
+    std::atomic<unsigned long> sent;
+    std::atomic<unsigned long> failed;
+    std::atomic<unsigned long> timeouts;
+    // parts sent, awaiting a status report
+    std::mutex receiptLock;
+    PDUReceiptIndex receipts;
+    alignas(64) Slot slots[SEND_QUEUE_SLOTS];
+
+    void wake();
+    long reserve(int count);
+    void start(Slot *s);
+    void send(Slot *s, int last, eState next, int timeoutMs);
+    void resume(Slot *s);
+    void finish(Slot *s, eSendStatus status, int error);
+    void handle(const Event &e);
+};
+
+#endif
@@ -1,11 +1,11 @@
 #include <iostream>
-#include <string>
-#include <queue>
 #include <chrono>
 #include <unistd.h> // write(), read(), close()
 #include <string.h>
+#include "lineRing.h"
+#include "shutdown.h"
 
-extern std::queue<std::string> inputQueue;
+extern LineRing inputRing;
 /*
     Initialization of modem where we send a command and expect a response
     usually OK within a set time
@@ -16,6 +16,7 @@ const char *atcommands[] = {
     "ATE1\r"
     ,"AT+CLIP=1\r" // enable callerid same A6/SIM900
     ,"AT+CMGF=0\r"  // SMS PDU mode  same
+    ,"AT+CNMI=2,2,0,1,0\r"  // SMS as +CMT, status reports as +CDS
 //    ,"AT+CSCA?\r"    // get SCSA number
 #if 0
     ,"AT+SAPBR=3,1,\"APN\",\"" DEFAULT_APN "\"\r" 
@@ -37,50 +38,52 @@ void startup(int sp) {
     int atindex = 0;
     bool running = true;
     bool virginState = true;    // modem already registered
-    std::string response = "";
+    const char *response = "";
     while (running) {
-        if (virginState || !inputQueue.empty()) {
-            if (!virginState) {   // normal running
-                response = inputQueue.front();
-                if (response.compare("\n") != 0)  // dont print empty line
-                    std::cout<< response << std::endl;
-                inputQueue.pop();
-            }
-            else
-                virginState = false;
+        bool haveLine = !virginState;
+        if (!virginState) {   // normal running, the line is read in place in the ring
+            response = inputRing.waitFront(shutdownFd());
+            if (response == NULL)
+                return;     // shutdown
+            if (strcmp(response,"\n") != 0)  // dont print empty line
+                std::cout<< response << std::endl;
+        }
+        else
+            virginState = false;
 //            std::cout << "Stage " << stage << std::endl;
-            switch (stage) {
-                case 0:  // waiting for CREG   
+        switch (stage) {
+            case 0:  // waiting for CREG   
 #if 0    // set to false if you manually reset the GSM device
-                    if (response.compare(0,6,"NORMAL") == 0) {
-                        stage = 0;
-                    }
-                    if (response.compare(0,8,"+CREG: 1") == 0) {
+                if (strncmp(response,"NORMAL",6) == 0) {
+                    stage = 0;
+                }
+                if (strncmp(response,"+CREG: 1",8) == 0) {
 #else   
-                    if (true) {
+                if (true) {
 #endif
-                        stage = 1;
-                        write(sp,atcommands[atindex],strlen(atcommands[atindex]));  // no echo
+                    stage = 1;
+                    write(sp,atcommands[atindex],strlen(atcommands[atindex]));  // no echo
+                    atindex++;
+                }
+                break;
+            case 1 ... LAST_CASE:
+                if (strncmp(response,"OK",2) == 0 || strncmp(response,"ERROR",5) == 0) {
+                     //   vTaskDelay(5000/portTICK_PERIOD_MS);
+                        sleep(1); 
+                        write(sp,atcommands[atindex],strlen(atcommands[atindex]));  // rest of commands
                         atindex++;
+                        stage++;
                     }
-                    break;
-                case 1 ... LAST_CASE:
-                    if (response.compare(0,2,"OK") == 0 || response.compare(0,5,"ERROR")== 0) {
-                         //   vTaskDelay(5000/portTICK_PERIOD_MS);
-                            sleep(1); 
-                            write(sp,atcommands[atindex],strlen(atcommands[atindex]));  // rest of commands
-                            atindex++;
-                            stage++;
-                        }
-                    break;
-                default:
-                    // got to end of list
-                    if (response.compare(0,2,"OK") == 0) {
-                        std::cout << "Startup finished\n";
-                        running = false;
-                    }
-                    break;
-            }
+                break;
+            default:
+                // got to end of list
+                if (strncmp(response,"OK",2) == 0) {
+                    std::cout << "Startup finished\n";
+                    running = false;
+                }
+                break;
         }
+        if (haveLine)
+            inputRing.pop();    // finished with the line
     }
 }
@@ -1,13 +1,19 @@
 #include <iostream>
 #include <string>
-#include <queue>
 #include <bitset>
 #include <unistd.h> // write(), read(), close()
 #include <string.h>
+#include <stdlib.h>
 #include "pdulib.h"
+#include "lineRing.h"
+#include "shutdown.h"
+#include "smsSender.h"
+#include "inboxStore.h"
 
-extern std::queue<std::string> inputQueue;
+extern LineRing inputRing;
 extern PDU mypdu;
+extern SMSSender *smsSender;
+extern InboxStore *inbox;
 
 std::string cgregstates[] = {
     "not registered",
@@ -19,81 +25,102 @@ std::string cgregstates[] = {
 };
 
 /*
-    Pop messages off the queue and process them
+    Take lines off the ring and process them in place
 */
 
 const char *atc = "+AT+CSCA?\r";
 
-void unsolicited(int sp) {
+void unsolicited(int /*sp, commands go through smsSender*/) {
     bool nextLineSMS = false;
+    bool nextLineReport = false;
     bool ipaddressprinted = false;
     std::cout << "Unsolicited started\n";
-    write (sp,atc,strlen(atc));
-    while (true) {
-        if (!inputQueue.empty()) {
-            std::string response = inputQueue.front();
-            inputQueue.pop();
-            std::cout << response << std::endl;
-            // check for known responses
-            if (response.compare(0,5,"+CLIP") == 0)    // caller id
-            {
-                // isolate number
-                std::cout << "Incoming call from ";
-                int start = response.find("\"");
-                std::cout << response.substr(start+1) << std::endl;
-            }
-            else if (response.compare(0,5,"+CMT:") == 0) { // incoming SMS
-                // isolate number
-                // +CMT: "",nn
-                std::cout << "Incoming SMS length ";
-                int value = std::stoi(response.substr(response.find(',')+1));
-                std::cout << value << std::endl;
-                nextLineSMS = true;
+    smsSender->command(atc);   // written between SMS, so its OK or ERROR is not taken for theirs
+    const char *response;
+    // sleep until a line arrives, NULL at shutdown
+    while ((response = inputRing.waitFront(shutdownFd())) != NULL) {
+        std::cout << response << std::endl;
+        smsSender->response(response);    // prompt and results of AT+CMGS
+        // check for known responses
+        if (strncmp(response,"+CLIP",5) == 0)    // caller id
+        {
+            // isolate number
+            std::cout << "Incoming call from ";
+            const char *start = strchr(response,'"');
+            std::cout << (start ? start+1 : "") << std::endl;
+        }
+        else if (strncmp(response,"+CMT:",5) == 0) { // incoming SMS
+            // isolate number
+            // +CMT: "",nn
+            std::cout << "Incoming SMS length ";
+            const char *comma = strchr(response,',');
+            int value = comma ? atoi(comma+1) : 0;
+            std::cout << value << std::endl;
+            nextLineSMS = true;
+        }
+        else if (strncmp(response,"+CDS:",5) == 0)  // status report, PDU on the next line
+            nextLineReport = true;
+        else if (nextLineReport) {
+            SMSSender::Receipt r;
+            if (smsSender->report(response, &r)) {
+                std::cout << "SMS " << r.id << " part " << r.part;
+                std::cout << (r.state == DELIVERY_COMPLETE ? " delivered" : r.state == DELIVERY_PENDING ? " pending" : " not delivered");
+                std::cout << ", status " << r.status << std::endl;
             }
-            else if (nextLineSMS) {
-                if (mypdu.decodePDU(response.c_str())) {
-                    std::cout << "SCA: " << mypdu.getSCAnumber() << std::endl;
-                    std::cout << "Time: " << mypdu.getTimeStamp() << std::endl;
-                    std::cout << "From: " << mypdu.getSender() << std::endl;
-                    std::cout << "Message: " << mypdu.getText() << std::endl;
-                }
-                nextLineSMS = false;
+            nextLineReport = false;
+        }
+        else if (nextLineSMS) {
+            if (mypdu.decodePDU(response)) {
+                std::cout << "SCA: " << mypdu.getSCAnumber() << std::endl;
+                std::cout << "Time: " << mypdu.getTimeStamp() << std::endl;
+                std::cout << "From: " << mypdu.getSender() << std::endl;
+                std::cout << "Message: " << mypdu.getText() << std::endl;
+                if (inbox)
+                    inbox->append(mypdu.getSender(), mypdu.getTimeStamp(), mypdu.getText());
             }
-            else if (response.compare(0,6,"+CSCA:") == 0) {  // get sca number
+            nextLineSMS = false;
+        }
+        else if (strncmp(response,"+CSCA:",6) == 0) {  // get sca number
 //                std::cout << "SCA number ";
-                int start = response.find('"')+1;
-                int end = response.find(',') -1;
-//                std::cout << response.substr(start,end-start) << std::endl;
-                mypdu.setSCAnumber(response.substr(start,end-start).c_str());
-//                std::cout << mypdu.getSCAnumber() << std::endl;
+            const char *start = strchr(response,'"');
+            const char *end = strchr(response,',');
+            if (start && end && end - 1 > start + 1) {
+                // between the quotes
+                mypdu.setSCAnumber(std::string(start+1,end-1-(start+1)).c_str());
             }
+//                std::cout << mypdu.getSCAnumber() << std::endl;
+        }
 #if 0
-            else if (response.compare(0,6,"+CIEV:") == 0) {
-                char *start = linebuf+7;
+        else if (response.compare(0,6,"+CIEV:") == 0) {
+            char *start = linebuf+7;
 //                char *end = strchr(start, ',');
 //                *end = 0;
-                Serial.print("Event ");
-                Serial.println(start);
-                // analyse event
-                if (strncmp("\"CALL\"",start,6)==0) {
-                    start = strchr(start,',');
-                    int value = atoi(++start);
-                    Serial.print("Call ");
-                    Serial.println( value == 0 ? F("disconnected") : F("connected"));
-                }
+            Serial.print("Event ");
+            Serial.println(start);
+            // analyse event
+            if (strncmp("\"CALL\"",start,6)==0) {
+                start = strchr(start,',');
+                int value = atoi(++start);
+                Serial.print("Call ");
+                Serial.println( value == 0 ? F("disconnected") : F("connected"));
             }
+        }
 #endif
-            else if (response.compare(0,7,"+CGREG:") == 0) {
-                int value = std::stoi(response.substr(response.find(' ')+1));
-                std::cout << "Network registration is ";
-                std::cout << cgregstates[value] << std::endl;
-                if (!ipaddressprinted) {
-                    write(sp,"AT+CIFSR\r",9);  // Get our ip address
-                    ipaddressprinted = true;
-                }
+        else if (strncmp(response,"+CGREG:",7) == 0) {
+            const char *space = strchr(response,' ');
+            int value = space ? atoi(space+1) : 4;
+            if (value < 0 || value > 5)
+                value = 4;  // unknown
+            std::cout << "Network registration is ";
+            std::cout << cgregstates[value] << std::endl;
+            if (!ipaddressprinted) {
+                smsSender->command("AT+CIFSR\r");  // Get our ip address
+                ipaddressprinted = true;
             }
-            else if (response.compare(0,11,"+HTTPACTION") == 0)
-                write(sp,"AT+HTTPREAD\r",12);
         }
+        else if (strncmp(response,"+HTTPACTION",11) == 0)
+            smsSender->command("AT+HTTPREAD\r");
+        inputRing.pop();    // finished with the line
     }
-}
\ No newline at end of file
+    std::cout << "Unsolicited finished\n";
+}
@@ -0,0 +1,153 @@
+/*
+    Throughput of encodePDU and decodePDU for the kinds of message met in practice:
+    GSM 7 bit, GSM 7 bit with escapes, UCS-2, UCS-2 with surrogate pairs (emoji),
+    Turkish with a national language shift table, typographic punctuation sent
+    transliterated, a part of a concatenated message, 8 bit data with application
+    ports and an alphanumeric sender.
+    Each case runs for at least the given time, the best of RUNS runs is reported.
+    Octets are those of the binary PDU including the SCA, for pduClassify (quoting
+    the cost of a message before sending it) those of the UTF-8 text.
+    Output is 1 line per case: version,operation,case,octets,messages/s,ns/octet
+    Optional argument: seconds per run, default 0.1
+*/
+#include <iostream>
+#include <chrono>
+#include <string.h>
+#include <stdlib.h>
+#include <pdulib.h>
+
+#ifndef PDULIB_VERSION
+#define PDULIB_VERSION "unknown"   // normally set from library.properties by the Makefile
+#endif
+#define RUNS 5
+
+static const char *sca = "+97254120032";
+static const char *recipient = "+972541234567";
+
+struct EncodeCase {
+  const char *name;
+  const char *text;
+};
+static const EncodeCase encodeCases[] = {
+  {"gsm7", "Hello, this is a plain GSM 7 bit message with nothing special in it at all."},
+  {"escapes", "Price {EUR} [10€] or ~5€ | see ^these^ \\ brackets [] {} €€€"},
+  {"ucs2", "שלום עולם, Привет мир, مرحبا بالعالم"},
+  {"emoji", "Party \U0001F389\U0001F356\U0001F603 time \U0001F680✨ ok \U0001F44D"},
+  // too long for UCS-2, fits 1 SMS with the Turkish single shift table
+  {"national", "Günaydın! Bugün saat üçte İstanbul'da buluşalım, ağabeyim de gelecek. Şimdilik hoşça kal."},
+  // curly quotes, dashes and an ellipsis, GSM 7 bit with setTransliterate
+  {"translit", "“Meeting moved” – it’s now at 10:30 — don’t be late… Café Złota"},
+  // 3 parts, encoded with beginMultipart and encodeNextPart
+  {"multipart", "This long message is split into several parts and each one carries a concatenation header. "
+                "This long message is split into several parts and each one carries a concatenation header. "
+                "This long message is split into several parts and each one carries a concatenation header. "
+                "This long message is split into several parts and each one carries a concatenation header."}
+};
+
+// SMS-DELIVER as received from a modem
+struct DecodeCase {
+  const char *name;
+  const char *pdu;
+};
+static const DecodeCase decodeCases[] = {
+  {"gsm7",
+   "07917952140230F2040C917952777777770000120121612373214BC8329BFD6681E8E8F41C949E83C220383B9C76838ED326E80612A7E9A076793E0F9FCBA07B9A8E06B9DF7474DA7D06CDE1E5713ACC06A5DDA0341D14A683C26CB60B"},
+  {"escapes",
+   "07917952140230F2040C917952777777770000120121612373214D50797A5C066D50C5AA7493026D7831D8A6BCF181DE72D0A657DB94411B20685E2E8336143ABA3C2F6F28A0CD0B249687C7EB327D0EDAF0363ED006B5498136E54D795306"},
+  {"ucs2",
+   "07917952140230F2040C917952777777770008120121612373214805E905DC05D505DD002005E205D505DC05DD002C0020041F044004380432043504420020043C04380440002C002006450631062D0628062700200628062706440639062706440645"},
+  {"emoji",
+   "07917952140230F2040C9179527777777700081201216123732136005000610072007400790020D83CDF89D83CDF56D83DDE03002000740069006D00650020D83DDE8027280020006F006B0020D83DDC4D"},
+  {"national",
+   "07917952140230F2440C91795277777777000021101216323712670324010138FADDE13C7993768740C2FAD9EF06CDC3613AC8BF19D3CBA04D724E0FBBC575F6891C0689EBECFA661E666FD26D1628BC3987C5E57CBA0D229741E732BB3C2EAF5DA0CD34DD26A7D9E93508FDDECC37E330681D66BB00"},
+  {"multipart",
+   "07917952140230F2440C91795277777777000012012161237321A00500032A0201A8E8F41CC47EBBCFA076793E0F9FCBA0F41C3487B3D37450DA4D7F83E6657B591E6683E061397D0E0ABBC9A072788C06BDDD65D0382C97A7CB735018347EBBC7617AD91DA6A7DF6E10BA1C2697E52E10159D9E83D86FF719D42ECFE7E17319949E83E670769A0E4ABBE96FD0BC6C2FCBC36C103C2CA7CF41613719540E8FD1A0B7BB0C1A87E5"},
+  // 8 bit data with 16 bit application ports
+  {"data",
+   "07917952140230F2040C917952777777770004120121612373212F0605041388138801020304050607080910111213141516171819202122232425262728293031323334353637383940"},
+  {"alphanumeric",
+   "07917952140230F2040BD0CDBC30EC5E030000120121612373213AD9775D0E7ABBCB207ABA5D068DDFE432283D07C564335ACDC60291DF20F79B0E9AA3C3F232284D07DDD3743428ECCEBFDD6517"},
+};
+
+static volatile long sink;   // keeps the results alive
+
+// messages/s and octets of one message, best of RUNS
+template <typename F>
+static double measure(double seconds, F message) {
+  double best = 0;
+  for (int run = 0; run < RUNS; run++) {
+    long count = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    do {
+      for (int i = 0; i < 64; i++)
+        sink += message();
+      count += 64;
+      elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < seconds);
+    double rate = count / elapsed.count();
+    if (rate > best)
+      best = rate;
+  }
+  return best;
+}
+
+static void report(const char *operation, const char *name, int octets, double rate) {
+  std::cout << PDULIB_VERSION << "," << operation << "," << name << "," << octets << ","
+            << (long)rate << "," << 1e9 / rate / octets << std::endl;
+}
+
+int main(int argc, char **argv) {
+  double seconds = argc > 1 ? atof(argv[1]) : 0.1;
+  PDU pdu;
+  pdu.setSCAnumber(sca);
+  std::cout << "version,operation,case,octets,messages/s,ns/octet" << std::endl;
+  for (const EncodeCase &c : encodeCases) {
+    bool multipart = strcmp(c.name, "multipart") == 0;
+    bool translit = strcmp(c.name, "translit") == 0;
+    pdu.setTransliterate(translit);
+    // octets of 1 message, all parts, without the CTRL/Z
+    int octets = 0;
+    if (multipart) {
+      pdu.beginMultipart(recipient, c.text, 42);
+      while (pdu.encodeNextPart() > 0)
+        octets += (strlen(pdu.getSMS()) - 1) / 2;
+    }
+    else if (pdu.encodePDU(recipient, c.text) > 0)
+      octets = (strlen(pdu.getSMS()) - 1) / 2;
+    if (octets == 0) {
+      std::cerr << c.name << " could not be encoded" << std::endl;
+      return 1;
+    }
+    double rate = measure(seconds, [&]() {
+      if (!multipart)
+        return pdu.encodePDU(recipient, c.text);
+      int total = 0;
+      pdu.beginMultipart(recipient, c.text, 42);
+      for (int length; (length = pdu.encodeNextPart()) > 0; )
+        total += length;
+      return total;
+    });
+    report("encode", c.name, octets, rate);
+  }
+  for (const EncodeCase &c : encodeCases) {
+    PDUTextInfo info;
+    int length = strlen(c.text);
+    bool translit = strcmp(c.name, "translit") == 0;
+    double rate = measure(seconds, [&]() {
+      return pduClassify(c.text, length, &info, NATIONAL_ALL, translit);
+    });
+    report("classify", c.name, length, rate);
+  }
+  for (const DecodeCase &c : decodeCases) {
+    if (!pdu.decodePDU(c.pdu)) {
+      std::cerr << c.name << " could not be decoded" << std::endl;
+      return 1;
+    }
+    double rate = measure(seconds, [&]() {
+      return pdu.decodePDU(c.pdu) ? 1 : 0;
+    });
+    report("decode", c.name, strlen(c.pdu) / 2, rate);
+  }
+  return 0;
+}
@@ -0,0 +1,111 @@
+/*
+    Microbenchmark of hex conversion of PDUs in both directions
+    Compares the per octet conversions used up to 0.4.7 with each of the
+    pduHexToBinary and pduBinaryToHex kernels, and the pduHexValidate
+    kernels that decodeView uses.
+    Output is 1 line per kernel: direction,name,bytes of hex per call,GB/s
+*/
+#include <iostream>
+#include <chrono>
+#include <string.h>
+#include <ctype.h>
+#include <pduhex.h>
+
+// the original PDU::gethex, upper case only
+static unsigned char legacyGethex(const char *pc)
+{
+  int i;
+  if (isdigit(*pc))
+    i = ((unsigned char)(*pc) - '0') * 16;
+  else
+    i = ((unsigned char)(*pc) - 'A' + 10) * 16;
+  pc++;
+  if (isdigit(*pc))
+    i += (unsigned char)(*pc) - '0';
+  else
+    i += (unsigned char)(*pc) - 'A' + 10;
+  return i;
+}
+
+static int legacyHexToBinary(const char *hex, int length, unsigned char *out) {
+  for (int i = 0; i < length; i += 2)
+    *out++ = legacyGethex(&hex[i]);
+  return length / 2;
+}
+
+// the original PDU::putHex
+static void legacyPutHex(unsigned char b, char *target) {
+  if ((b>>4) <= 9)
+    *target++ = (b>>4) + '0';
+  else
+    *target++ = (b>>4) + 'A' - 10;
+  if ((b&0xf) <= 9)
+    *target++ = (b&0xf) + '0';
+  else
+    *target++ = (b&0xf) + 'A' - 10;
+}
+
+// the original PDU::binaryToHex, staged through a copy
+static void legacyBinaryToHex(const unsigned char *in, int length, char *out) {
+  char tempbuf[256];
+  memcpy(tempbuf, in, length);
+  for (int i = 0; i < length; i++)
+    legacyPutHex(tempbuf[i], &out[i * 2]);
+}
+
+#define ROUNDS 2000000
+// a full length 7 bit SMS-DELIVER
+static const char *pdu = "07917952140230F2040C91795277777777000012012161335221A061F1985C369FD169F59ADD76BFE171F99C5EB7DFF1797D503824168D476452B964369D4F68543AA556AD576C561B168FC965F3199D56AFD96DF71B1E97CFE975FB1D9FD707854362D1784426954B66D3F98446A5536AD57AC566B561F1985C369FD169F59ADD76BFE171F99C5EB7DFF1797D503824168D476452B964369D4F68543AA556AD576C561B93CD68";
+
+static unsigned long sink;
+
+template <typename F>
+static void measure(const char *name, F convert) {
+  unsigned char out[256] = {0};
+  int length = strlen(pdu);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ROUNDS; i++) {
+    convert(pdu, length, out);
+    sink += out[i % (length / 2)];
+    asm volatile("" : : "r"(out) : "memory");   // keep the conversion in the loop
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "decode," << name << "," << length << "," << (double)length * ROUNDS / elapsed.count() / 1e9 << std::endl;
+}
+
+template <typename F>
+static void measureEncode(const char *name, F convert) {
+  unsigned char in[256];
+  char out[512];
+  int length = pduHexToBinary(pdu, strlen(pdu), in);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ROUNDS; i++) {
+    convert(in, length, out);
+    sink += out[i % (length * 2)];
+    asm volatile("" : : "r"(out) : "memory");
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "encode," << name << "," << length * 2 << "," << (double)length * 2 * ROUNDS / elapsed.count() / 1e9 << std::endl;
+}
+
+int main() {
+  std::cout << "direction,kernel,hex_bytes,GB/s" << std::endl;
+  measure("legacy", legacyHexToBinary);
+  measure("scalar", [](const char *h, int l, unsigned char *o) { return pduHexToBinary(h, l, o, HEX_KERNEL_SCALAR); });
+  if (pduHexKernelSupported(HEX_KERNEL_SSE2))
+    measure("sse2", [](const char *h, int l, unsigned char *o) { return pduHexToBinary(h, l, o, HEX_KERNEL_SSE2); });
+  if (pduHexKernelSupported(HEX_KERNEL_AVX2))
+    measure("avx2", [](const char *h, int l, unsigned char *o) { return pduHexToBinary(h, l, o, HEX_KERNEL_AVX2); });
+  measure("validate scalar", [](const char *h, int l, unsigned char *o) { o[0] = pduHexValidate(h, l, HEX_KERNEL_SCALAR); });
+  if (pduHexKernelSupported(HEX_KERNEL_SSE2))
+    measure("validate sse2", [](const char *h, int l, unsigned char *o) { o[0] = pduHexValidate(h, l, HEX_KERNEL_SSE2); });
+  if (pduHexKernelSupported(HEX_KERNEL_AVX2))
+    measure("validate avx2", [](const char *h, int l, unsigned char *o) { o[0] = pduHexValidate(h, l, HEX_KERNEL_AVX2); });
+  measureEncode("legacy", legacyBinaryToHex);
+  measureEncode("scalar", [](const unsigned char *b, int l, char *o) { pduBinaryToHex(b, l, o, HEX_KERNEL_SCALAR); });
+  if (pduHexKernelSupported(HEX_KERNEL_SSE2))
+    measureEncode("sse2", [](const unsigned char *b, int l, char *o) { pduBinaryToHex(b, l, o, HEX_KERNEL_SSE2); });
+  if (pduHexKernelSupported(HEX_KERNEL_AVX2))
+    measureEncode("avx2", [](const unsigned char *b, int l, char *o) { pduBinaryToHex(b, l, o, HEX_KERNEL_AVX2); });
+  return sink == 0xdeadbeef;
+}
@@ -0,0 +1,133 @@
+/*
+    Benchmark of InboxStore
+    Stores messages from many senders with SCTS a second apart in several time
+    zones, then reopens the store, recovering the segment being appended to,
+    and looks messages up by sender, by a minute of time and by id.
+    The store is made afresh in output/inboxbench.d, segments are 64MB.
+    Output is 1 line per operation: operation,messages,operations/s,us/operation
+    Optional arguments: messages to store, senders
+*/
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <pdulib.h>
+#include <inboxStore.h>
+
+#define STORE_DIR "output/inboxbench.d"
+#define LOOKUPS 10000
+#define SCTS_START 1633046400LL    // 2021-10-01 00:00 UTC
+
+static const char *texts[] = {
+  "Hello from the inbox benchmark",
+  "Your code is 123456",
+  "A long message that arrived in several parts and was put together before it was stored. "
+  "A long message that arrived in several parts and was put together before it was stored."
+};
+
+static unsigned long sink;
+
+static void sender(int n, char *out) {
+  snprintf(out, MAX_NUMBER_LENGTH, "+9725%08d", n);
+}
+
+static void report(const char *operation, unsigned long messages, unsigned long operations, double seconds) {
+  std::cout << operation << "," << messages << "," << (long)(operations / seconds) << ","
+            << seconds * 1e6 / operations << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  unsigned long messages = argc > 1 ? atol(argv[1]) : 2000000;
+  int senders = argc > 2 ? atoi(argv[2]) : 100000;
+  if (system("rm -rf " STORE_DIR) != 0 || mkdir(STORE_DIR, 0755) < 0) {
+    std::cerr << "cannot make " STORE_DIR << std::endl;
+    return 1;
+  }
+  std::cout << "operation,messages,operations/s,us/operation" << std::endl;
+  std::vector<InboxStore::Id> ids;
+  ids.reserve(messages);
+  {
+    InboxStore store;
+    if (store.open(STORE_DIR) < 0) {
+      std::cerr << "cannot open " STORE_DIR << std::endl;
+      return 1;
+    }
+    char number[MAX_NUMBER_LENGTH];
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < messages; i++) {
+      const char *text = texts[i % 3];
+      sender((i * 7919) % senders, number);
+      // zones -8 to +12 hours, every few messages arrives late
+      int zone = (int)(i % 21) * 4 - 32;
+      long long epoch = SCTS_START + i - (i % 10 == 0 ? 600 : 0);
+      InboxStore::Id id = store.append(number, epoch, zone, text, strlen(text));
+      if (id == 0) {
+        std::cerr << "append failed" << std::endl;
+        return 1;
+      }
+      ids.push_back(id);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    report("append", messages, messages, elapsed.count());
+    start = std::chrono::steady_clock::now();
+    store.sync();
+    elapsed = std::chrono::steady_clock::now() - start;
+    report("sync", messages, 1, elapsed.count());
+  }
+  InboxStore store;
+  auto start = std::chrono::steady_clock::now();
+  if (store.open(STORE_DIR) < 0) {
+    std::cerr << "cannot reopen " STORE_DIR << std::endl;
+    return 1;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  report("open", messages, 1, elapsed.count());
+  if (store.stats().messages != messages) {
+    std::cerr << "messages lost on reopen" << std::endl;
+    return 1;
+  }
+
+  char number[MAX_NUMBER_LENGTH];
+  unsigned long found = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < LOOKUPS; i++) {
+    sender((i * 104729L) % senders, number);
+    found += store.bySender(number, [](const InboxStore::Message &m) {
+      sink += m.textLength;
+      return true;
+    });
+  }
+  elapsed = std::chrono::steady_clock::now() - start;
+  report("bySender", messages, LOOKUPS, elapsed.count());
+  // 7919 is prime, so each sender has the same number of messages when they divide evenly
+  if (messages % senders == 0 && senders % 7919 != 0 && found != LOOKUPS * (messages / senders)) {
+    std::cerr << "bySender found " << found << " expected " << LOOKUPS * (messages / senders) << std::endl;
+    return 1;
+  }
+
+  found = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < LOOKUPS; i++) {
+    long long from = SCTS_START + (long long)((i * 104729UL) % messages);
+    found += store.byTime(from, from + 60, [](const InboxStore::Message &m) {
+      sink += m.textLength;
+      return true;
+    });
+  }
+  elapsed = std::chrono::steady_clock::now() - start;
+  report("byTime", messages, LOOKUPS, elapsed.count());
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < LOOKUPS * 100; i++) {
+    InboxStore::Message m;
+    if (store.get(ids[(i * 104729UL) % messages], &m))
+      sink += m.senderLength;
+  }
+  elapsed = std::chrono::steady_clock::now() - start;
+  report("get", messages, LOOKUPS * 100, elapsed.count());
+  return sink == 0 || found == 0;
+}
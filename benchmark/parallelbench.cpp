@@ -0,0 +1,64 @@
+/*
+    Scaling benchmark of PDUParallelDecoder
+    Decodes a backlog of SMS-DELIVER PDUs, a mix of GSM 7 bit, UCS-2 and
+    concatenated parts, with 1 thread up to 1 per CPU.
+    Output is 1 line per thread count: threads,pdus,seconds,PDUs/s,speedup
+    Optional arguments: number of PDUs, highest thread count
+*/
+#include <iostream>
+#include <chrono>
+#include <stdlib.h>
+#include <vector>
+#include <pduparallel.h>
+
+static const char *samples[] = {
+  "07917952140230F2040C9179527777777700001201216123732106CA405B8D6000",
+  "07917952939899F9240C917952630247660000120151113404210A814D79C3DBF8C2E231",
+  "07917952140230F2040C917952777777770008120170016131212200680065006C006C006F003000A505D02660D83CDCA1D83DDE0005E905DC05D505DD",
+  "07917952140230F2040C91795277777777000812012161238121180061006200630064D83CDF56D83DDE0305D005D105D205D3",
+  "07917952140230F2040C91795277777777000012012161335221A061F1985C369FD169F59ADD76BFE171F99C5EB7DFF1797D503824168D476452B964369D4F68543AA556AD576C561B168FC965F3199D56AFD96DF71B1E97CFE975FB1D9FD707854362D1784426954B66D3F98446A5536AD57AC566B561F1985C369FD169F59ADD76BFE171F99C5EB7DFF1797D503824168D476452B964369D4F68543AA556AD576C561B93CD68",
+  "0791795214325476440C9179521032547600001210121633251236050003050202C2E170381C0E87C3E170381C0E87C3E170381C0E87C3E170381C0E87C3E170381C0E87C3E170381C0E03"
+};
+
+int main(int argc, char **argv) {
+  int count = argc > 1 ? atoi(argv[1]) : 1000000;
+  int most = argc > 2 ? atoi(argv[2]) : std::thread::hardware_concurrency();
+  if (most < 1)
+    most = 1;
+  std::vector<const char *> pdus(count);
+  for (int i = 0; i < count; i++)
+    pdus[i] = samples[(i * 7) % (sizeof(samples) / sizeof(samples[0]))];
+  std::vector<unsigned char> status(count);
+  std::unique_ptr<char[][MAX_NUMBER_LENGTH]> sender(new char[count][MAX_NUMBER_LENGTH]);
+  std::unique_ptr<char[][TIMESTAMP_LENGTH]> timeStamp(new char[count][TIMESTAMP_LENGTH]);
+  std::vector<size_t> offset(count);
+  std::vector<unsigned short> length(count);
+  std::vector<char> arena((size_t)count * 64);
+  double single = 0;
+  std::cout << "threads,pdus,seconds,PDUs/s,speedup" << std::endl;
+  // 1, 2, 4 ... and finally most
+  for (int threads = 1; ; threads = threads * 2 < most ? threads * 2 : most) {
+    PDUParallelDecoder decoder(threads);
+    PDUBatch batch = {};
+    batch.status = status.data();
+    batch.sender = sender.get();
+    batch.timeStamp = timeStamp.get();
+    batch.textOffset = offset.data();
+    batch.textLength = length.data();
+    batch.arena = arena.data();
+    batch.arenaSize = arena.size();
+    auto start = std::chrono::steady_clock::now();
+    int ok = decoder.decode(pdus.data(), count, &batch);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (ok != count) {
+      std::cerr << "only " << ok << " of " << count << " decoded" << std::endl;
+      return 1;
+    }
+    if (threads == 1)
+      single = elapsed.count();
+    std::cout << threads << "," << count << "," << elapsed.count() << "," << count / elapsed.count() << "," << single / elapsed.count() << std::endl;
+    if (threads == most)
+      break;
+  }
+  return 0;
+}
@@ -0,0 +1,143 @@
+/*
+    Throughput benchmark of ModemReactor
+    Opens pseudo terminals as simulated modems, each answers the initialisation
+    commands and then sends a burst of +CMT unsolicited SMS as fast as the
+    reactor takes them. Timing starts once every modem is initialised.
+    Output is 1 line: ports,threads,messages,seconds,msgs/s
+    Optional arguments: number of ports, SMS per port, reactor threads
+*/
+#include <iostream>
+#include <chrono>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <modemReactor.h>
+#include <serialPort.h>
+
+static const char *samples[] = {
+  "07917952140230F2040C9179527777777700001201216123732106CA405B8D6000",
+  "07917952140230F2040C917952777777770008120170016131212200680065006C006C006F003000A505D02660D83CDCA1D83DDE0005E905DC05D505DD",
+  "0791795214325476440C9179521032547600001210121633251236050003050202C2E170381C0E87C3E170381C0E87C3E170381C0E87C3E170381C0E87C3E170381C0E87C3E170381C0E03"
+};
+
+struct SimModem {
+  int fd;         // pty master, the reactor has the slave
+  std::string in; // command being received
+  bool ready;     // all commands answered
+};
+
+// all of it, waiting when the pty is full
+static bool writeAll(int fd, const std::string &s) {
+  size_t done = 0;
+  while (done < s.size()) {
+    int n = write(fd, s.data() + done, s.size() - done);
+    if (n > 0)
+      done += n;
+    else if (n < 0 && errno == EAGAIN) {
+      struct pollfd pfd = {fd, POLLOUT, 0};
+      poll(&pfd, 1, 1000);
+    }
+    else if (n < 0 && errno != EINTR)
+      return false;
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  int ports = argc > 1 ? atoi(argv[1]) : 256;
+  int perPort = argc > 2 ? atoi(argv[2]) : 100;
+  int threads = argc > 3 ? atoi(argv[3]) : std::thread::hardware_concurrency();
+  if (ports < 1 || perPort < 1 || threads < 1)
+    return 1;
+  ModemReactor reactor(threads);
+  std::vector<SimModem> sims(ports);
+  int epfd = epoll_create1(0);
+  for (int i = 0; i < ports; i++) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+      std::cerr << "cannot open pty " << i << ": " << strerror(errno) << std::endl;
+      return 1;
+    }
+    // the slave side is what the reactor sees as a serial port
+    int slave = openSerialPort(ptsname(master), true);
+    if (slave < 0 || reactor.addFd(slave, ptsname(master)) < 0)
+      return 1;
+    sims[i].fd = master;
+    sims[i].ready = false;
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u32 = i;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, master, &ev);
+  }
+  std::atomic<long> decoded(0);
+  reactor.setSMSHandler([&decoded](ModemReactor::Modem &, PDU &) {
+    decoded.fetch_add(1, std::memory_order_relaxed);
+  });
+  reactor.run();
+
+  // answer commands until all modems are ready
+  int ready = 0;
+  struct epoll_event events[64];
+  while (ready < ports) {
+    int n = epoll_wait(epfd, events, 64, 5000);
+    if (n <= 0) {
+      std::cerr << "only " << ready << " of " << ports << " modems initialised" << std::endl;
+      return 1;
+    }
+    for (int e = 0; e < n; e++) {
+      SimModem &sim = sims[events[e].data.u32];
+      char buf[256];
+      int got = read(sim.fd, buf, sizeof(buf));
+      for (int i = 0; i < got; i++) {
+        if (buf[i] != '\r') {
+          sim.in += buf[i];
+          continue;
+        }
+        std::string reply = "\r\n";
+        if (sim.in == "AT+CSCA?")
+          reply += "+CSCA: \"+97254120032\",145\r\n\r\n";
+        reply += "OK\r\n";
+        if (sim.in == "AT+CSCA?" && !sim.ready) {
+          sim.ready = true;
+          ready++;
+        }
+        sim.in.clear();
+        writeAll(sim.fd, reply);
+      }
+    }
+  }
+
+  // burst of SMS from every modem, interleaved so all threads are busy
+  auto start = std::chrono::steady_clock::now();
+  long total = (long)ports * perPort;
+  for (int m = 0; m < perPort; m++)
+    for (int i = 0; i < ports; i++) {
+      std::string sms = "+CMT: ,30\r\n";
+      sms += samples[(i + m) % (sizeof(samples) / sizeof(samples[0]))];
+      sms += "\r\n";
+      if (!writeAll(sims[i].fd, sms))
+        return 1;
+    }
+  while (decoded.load(std::memory_order_relaxed) < total) {
+    if (std::chrono::steady_clock::now() - start > std::chrono::seconds(60)) {
+      std::cerr << "only " << decoded.load() << " of " << total << " decoded" << std::endl;
+      return 1;
+    }
+    usleep(100);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  reactor.stop();
+  std::cout << "ports,threads,messages,seconds,msgs/s" << std::endl;
+  std::cout << ports << "," << threads << "," << total << "," << elapsed.count() << "," << total / elapsed.count() << std::endl;
+  for (auto &sim : sims)
+    close(sim.fd);
+  close(epfd);
+  return 0;
+}
@@ -0,0 +1,98 @@
+/*
+    Matching status reports to the SMS awaiting them with PDUReceiptIndex,
+    against a linear search of the same entries, for increasing numbers of SMS
+    in flight. Each operation is the match of the final report for the oldest
+    SMS and the add of a new one, so the number in flight stays the same.
+    Built with a large RECEIPT_MAX_PENDING, see the Makefile.
+    Output is 1 line per case: method,pending,operations/s,ns/operation
+*/
+#include <iostream>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <pdureceipts.h>
+
+#define ROUNDS 2000000
+#define RECIPIENTS 1000
+
+static char recipients[RECIPIENTS][MAX_NUMBER_LENGTH];
+static unsigned long sink;
+
+// what an application without the index would do
+struct LinearEntry {
+  bool inUse;
+  unsigned char reference;
+  char recipient[MAX_NUMBER_LENGTH];
+  unsigned long tag;
+};
+static LinearEntry linear[RECEIPT_MAX_PENDING];
+
+static void linearAdd(unsigned char reference, const char *recipient, unsigned long tag) {
+  for (int i = 0; i < RECEIPT_MAX_PENDING; i++)
+    if (!linear[i].inUse) {
+      linear[i].inUse = true;
+      linear[i].reference = reference;
+      strcpy(linear[i].recipient, recipient);
+      linear[i].tag = tag;
+      return;
+    }
+}
+
+static bool linearMatch(unsigned char reference, const char *recipient, unsigned long *tag) {
+  for (int i = 0; i < RECEIPT_MAX_PENDING; i++)
+    if (linear[i].inUse && linear[i].reference == reference && strcmp(linear[i].recipient, recipient) == 0) {
+      *tag = linear[i].tag;
+      linear[i].inUse = false;
+      return true;
+    }
+  return false;
+}
+
+static void report(const char *method, int pending, int rounds, double seconds) {
+  std::cout << method << "," << pending << "," << (long)(rounds / seconds) << ","
+            << seconds * 1e9 / rounds << std::endl;
+}
+
+int main() {
+  for (int i = 0; i < RECIPIENTS; i++)
+    snprintf(recipients[i], MAX_NUMBER_LENGTH, "+9725412%05d", i * 7);
+  std::cout << "method,pending,operations/s,ns/operation" << std::endl;
+  static PDUReceiptIndex index;
+  for (int pending = 16; pending <= RECEIPT_MAX_PENDING; pending *= 4) {
+    // SMS n goes to recipient n % RECIPIENTS with reference n % 256, as 1 modem would number them
+    for (int n = 0; n < pending; n++)
+      index.add(n & 0xff, recipients[n % RECIPIENTS], n, 0);
+    auto start = std::chrono::steady_clock::now();
+    for (int n = pending; n < pending + ROUNDS; n++) {
+      unsigned long tag;
+      int old = n - pending;
+      sink += index.match(old & 0xff, recipients[old % RECIPIENTS], true, &tag) ? tag : 0;
+      index.add(n & 0xff, recipients[n % RECIPIENTS], n, 0);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    report("index", pending, ROUNDS, elapsed.count());
+    for (int n = ROUNDS; n < pending + ROUNDS; n++) {   // empty it for the next case
+      unsigned long tag;
+      index.match(n & 0xff, recipients[n % RECIPIENTS], true, &tag);
+    }
+
+    for (int n = 0; n < pending; n++)
+      linearAdd(n & 0xff, recipients[n % RECIPIENTS], n);
+    int rounds = ROUNDS / pending + 1000;   // it gets slow
+    start = std::chrono::steady_clock::now();
+    for (int n = pending; n < pending + rounds; n++) {
+      unsigned long tag;
+      int old = n - pending;
+      sink += linearMatch(old & 0xff, recipients[old % RECIPIENTS], &tag) ? tag : 0;
+      linearAdd(n & 0xff, recipients[n % RECIPIENTS], n);
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    report("linear", pending, rounds, elapsed.count());
+    memset(linear, 0, sizeof(linear));
+  }
+  if (index.pending() != 0 || index.getStats()->unknown != 0) {
+    std::cerr << "receipts not matched" << std::endl;
+    return 1;
+  }
+  return sink == 0;
+}
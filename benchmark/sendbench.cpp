@@ -0,0 +1,164 @@
+/*
+    Throughput benchmark of SMSSender
+    A simulated modem on a pseudo terminal answers AT+CMGS with the prompt and
+    each PDU with +CMGS: <mr> and OK, optionally after a delay standing in for the
+    network. Several producer threads submit a mix of single and multipart
+    messages at the same time.
+    Output is 1 line: producers,messages,parts,delay_us,pipelined,seconds,parts/s
+    Optional arguments: producer threads, messages per producer, modem delay in microseconds,
+    1 to write each PDU with its AT+CMGS without waiting for the prompt
+*/
+#include <iostream>
+#include <chrono>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <lineRing.h>
+#include <smsSender.h>
+#include <serialPort.h>
+
+static const char *messages[] = {
+  "Hello from the send benchmark",
+  "J£mjòø {escapes} [here] ~",
+  "abcd🍖😃אבגד",
+  "A long message that does not fit into a single SMS so it is sent as several parts. "
+  "A long message that does not fit into a single SMS so it is sent as several parts. "
+  "A long message that does not fit into a single SMS so it is sent as several parts."
+};
+
+static void writeAll(int fd, const std::string &s) {
+  size_t done = 0;
+  while (done < s.size()) {
+    int n = write(fd, s.data() + done, s.size() - done);
+    if (n > 0)
+      done += n;
+    else if (n < 0 && errno != EINTR && errno != EAGAIN)
+      return;
+  }
+}
+
+// answers commands and PDUs until the port is closed or cancelled
+static void modem(int fd, int cancelFd, int delay) {
+  std::string in;
+  int mr = 0;
+  struct pollfd fds[2] = {{fd, POLLIN, 0}, {cancelFd, POLLIN, 0}};
+  for (;;) {
+    if (poll(fds, 2, -1) < 0 && errno != EINTR)
+      return;
+    if (fds[1].revents & POLLIN)
+      return;
+    char buf[512];
+    int n = read(fd, buf, sizeof(buf));
+    if (n <= 0)
+      continue;
+    for (int i = 0; i < n; i++) {
+      if (buf[i] == '\r' && in.compare(0, 7, "AT+CMGS") == 0) {
+        writeAll(fd, "\r\n> ");
+        in.clear();
+      }
+      else if (buf[i] == 0x1a) {   // end of PDU
+        if (delay > 0)
+          usleep(delay);
+        writeAll(fd, "\r\n+CMGS: " + std::to_string(mr++ & 0xff) + "\r\n\r\nOK\r\n");
+        in.clear();
+      }
+      else if (buf[i] != '\r' && buf[i] != '\n')
+        in += buf[i];
+    }
+  }
+}
+
+// frames the modem output into lines for the sender, as serialHandler does
+static void reader(int fd, int cancelFd, SMSSender *sender) {
+  char line[MAX_LINE_LENGTH + 1];
+  int length = 0;
+  struct pollfd fds[2] = {{fd, POLLIN, 0}, {cancelFd, POLLIN, 0}};
+  for (;;) {
+    if (poll(fds, 2, -1) < 0 && errno != EINTR)
+      return;
+    if (fds[1].revents & POLLIN)
+      return;
+    char buf[512];
+    int n = read(fd, buf, sizeof(buf));
+    for (int i = 0; i < n; i++) {
+      line[length++] = buf[i];
+      if (buf[i] == '\n' || length == MAX_LINE_LENGTH || (length == 2 && line[0] == '>' && line[1] == ' ')) {
+        line[length] = 0;
+        sender->response(line);
+        length = 0;
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  int producers = argc > 1 ? atoi(argv[1]) : 4;
+  int perProducer = argc > 2 ? atoi(argv[2]) : 2000;
+  int delay = argc > 3 ? atoi(argv[3]) : 0;
+  bool pipelined = argc > 4 && atoi(argv[4]) != 0;
+  if (producers < 1 || perProducer < 1)
+    return 1;
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+    std::cerr << "cannot open pty: " << strerror(errno) << std::endl;
+    return 1;
+  }
+  int slave = openSerialPort(ptsname(master));
+  if (slave < 0)
+    return 1;
+  int cancelFd = eventfd(0, 0);
+  SMSSender sender(slave);
+  sender.setPipelined(pipelined);
+  std::atomic<long> results(0);
+  std::atomic<long> failures(0);
+  sender.setResultHandler([&](const SMSSender::Result &r) {
+    if (r.status != SEND_OK)
+      failures.fetch_add(1, std::memory_order_relaxed);
+    results.fetch_add(1, std::memory_order_relaxed);
+  });
+  std::thread modemThread(modem, master, cancelFd, delay);
+  std::thread readerThread(reader, slave, cancelFd, &sender);
+  std::thread senderThread(&SMSSender::run, &sender, cancelFd);
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; p++)
+    threads.emplace_back([&, p]() {
+      for (int i = 0; i < perProducer; i++)
+        // queue full, wait for the modem
+        while (sender.submit("+97254120032", "+972541234567", messages[(p + i) % (sizeof(messages) / sizeof(messages[0]))]) < 0)
+          usleep(100);
+    });
+  for (auto &t : threads)
+    t.join();
+  long parts = sender.stats().submitted;
+  while (results.load(std::memory_order_relaxed) < parts)
+    usleep(100);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  uint64_t one = 1;
+  if (write(cancelFd, &one, sizeof(one)) < 0) {}
+  senderThread.join();
+  readerThread.join();
+  modemThread.join();
+  if (failures.load() > 0) {
+    std::cerr << failures.load() << " parts failed" << std::endl;
+    return 1;
+  }
+  std::cout << "producers,messages,parts,delay_us,pipelined,seconds,parts/s" << std::endl;
+  std::cout << producers << "," << (long)producers * perProducer << "," << parts << "," << delay << "," << pipelined << ","
+            << elapsed.count() << "," << parts / elapsed.count() << std::endl;
+  close(slave);
+  close(master);
+  close(cancelFd);
+  return 0;
+}
@@ -0,0 +1,100 @@
+/*
+    Microbenchmark of GSM 7 bit septet packing and unpacking
+    Compares the per octet loops used up to 0.4.7 with each of the
+    pduPackSeptets and pduUnpackSeptets kernels, on a full 160 septet message.
+    The kernels are also measured after a 6 octet UDH, where the septets
+    do not start on an octet boundary. The old loops could not do that.
+    Output is 1 line per kernel: direction,name,start septet,Mseptets/s
+*/
+#include <iostream>
+#include <chrono>
+#include <string.h>
+#include <pduseptet.h>
+
+#define ROUNDS 2000000
+#define SEPTETS 160
+
+// the original loop of utf8_to_packed7bit, reads 1 septet past the end
+static int legacyPack(const unsigned char *gsm7bit, int len7bit, unsigned char *pdu) {
+  int r = 0;
+  int w = 0;
+  while (r < len7bit) {
+    pdu[w] = ((gsm7bit[r] >> (w % 7)) & 0x7F) | ((gsm7bit[r + 1] << (7 - (w % 7))) & 0xFF);
+    if ((w % 7) == 6) r++;
+    r++;
+    w++;
+  }
+  return w;
+}
+
+// the original loop of pdu_to_ascii, on binary instead of hex
+static int legacyUnpack(const unsigned char *pdu, int pdulength, unsigned char *ascii7bit) {
+  int w = 0;
+  int ovflow = 0;
+  for (int r = 0; r < pdulength; r++) {
+    if (r % 7 == 0) {
+      ascii7bit[w++] = pdu[r] & 0x7F;
+    }
+    else if (r % 7 == 6) {
+      ascii7bit[w++] = ((pdu[r] << 6) | (pdu[r - 1] >> 2)) & 0x7F;
+      ascii7bit[w++] = (pdu[r] >> 1) & 0x7F;
+      ovflow++;
+    }
+    else {
+      ascii7bit[w++] = ((pdu[r] << (r % 7)) | (pdu[r - 1] >> (7 + 1 - (r % 7)))) & 0x7F;
+    }
+  }
+  return w - ovflow;
+}
+
+static unsigned long sink;
+
+template <typename F>
+static void measure(const char *direction, const char *name, int start, F run) {
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < ROUNDS; i++)
+    sink += run(i);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+  std::cout << direction << "," << name << "," << start << "," << (double)SEPTETS * ROUNDS / elapsed.count() / 1e6 << std::endl;
+}
+
+int main() {
+  static unsigned char septets[SEPTETS + 1], packed[160], unpacked[SEPTETS + 8];
+  struct { eSeptetKernel kernel; const char *name; } kernels[] = {
+    {SEPTET_KERNEL_SCALAR, "scalar"}, {SEPTET_KERNEL_SWAR, "swar"}, {SEPTET_KERNEL_BMI2, "bmi2"}
+  };
+  const int starts[] = {0, 7};  // no UDH, 6 octet UDH and 1 fill bit
+  for (int i = 0; i < SEPTETS; i++)
+    septets[i] = (i * 37) & 0x7f;
+  std::cout << "direction,kernel,start,Mseptets/s" << std::endl;
+  measure("pack", "legacy", 0, [&](int i) {
+    legacyPack(septets, SEPTETS, packed);
+    asm volatile("" : : "r"(packed) : "memory");   // keep the work in the loop
+    return packed[i % 140];
+  });
+  for (int start : starts)
+    for (auto &k : kernels)
+      if (pduSeptetKernelSupported(k.kernel))
+        measure("pack", k.name, start, [&](int i) {
+          pduPackSeptets(septets, SEPTETS, packed, start, k.kernel);
+          asm volatile("" : : "r"(packed) : "memory");
+          return packed[i % 140];
+        });
+  pduPackSeptets(septets, SEPTETS, packed, 0);
+  measure("unpack", "legacy", 0, [&](int i) {
+    legacyUnpack(packed, 140, unpacked);
+    asm volatile("" : : "r"(unpacked) : "memory");
+    return unpacked[i % SEPTETS];
+  });
+  for (int start : starts) {
+    pduPackSeptets(septets, SEPTETS, packed, start);
+    for (auto &k : kernels)
+      if (pduSeptetKernelSupported(k.kernel))
+        measure("unpack", k.name, start, [&](int i) {
+          pduUnpackSeptets(packed, start, SEPTETS, unpacked, k.kernel);
+          asm volatile("" : : "r"(unpacked) : "memory");
+          return unpacked[i % SEPTETS];
+        });
+  }
+  return sink == 0xdeadbeef;
+}
@@ -0,0 +1,136 @@
+/*
+    Check that PDU objects on different threads do not disturb each other.
+    Each job encodes a mix of texts, single and concatenated, and decodes a mix
+    of received PDUs, with its own PDU object, collecting every PDU, sender,
+    timestamp and text it produces. The jobs are first run one after another,
+    then all at once on THREADS threads, and the output of each must be
+    identical. Every text must also decode back to itself, the SMS-SUBMITs
+    being turned into SMS-DELIVERs as an SC would.
+    Output is 1 line: threads,operations,seconds,result
+    Optional argument: rounds per job
+*/
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+#include <pdulib.h>
+
+#define THREADS 8
+
+static const char *sca = "+97254120032";
+static const char *recipient = "+972541234567";
+
+static const char *texts[] = {
+  "Hello, this is a plain GSM 7 bit message with nothing special in it at all.",
+  "Price {EUR} [10€] or ~5€ | see ^these^ \\ brackets [] {} €€€",
+  "שלום עולם, Привет мир, مرحبا بالعالم",
+  "Party \U0001F389\U0001F356\U0001F603 time \U0001F680✨ ok \U0001F44D",
+  "Günaydın! Bugün saat üçte İstanbul'da buluşalım, ağabeyim de gelecek. Şimdilik hoşça kal.",
+  // 1 SMS with the Turkish locking shift table, each € a single septet of 3 UTF-8 bytes
+  "ş€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€"
+  "€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€€",
+  "This long message is split into several parts and each one carries a concatenation header. "
+  "This long message is split into several parts and each one carries a concatenation header. "
+  "Surrogate pairs \U0001F389\U0001F356 may not be split between the parts of a UCS-2 message, "
+  "so this one has a few of them \U0001F603\U0001F680\U0001F44D near where the parts end."
+};
+
+// SMS-DELIVER as received from a modem, GSM 7 bit, UCS-2 with surrogate pairs and a concatenated part
+static const char *received[] = {
+  "07917952140230F2040C9179527777777700001201216123732106CA405B8D6000",
+  "07917952939899F9240C917952630247660000120151113404210A814D79C3DBF8C2E231",
+  "07917952140230F2040C917952777777770008120170016131212200680065006C006C006F003000A505D02660D83CDCA1D83DDE0005E905DC05D505DD",
+  "07917952140230F2040C91795277777777000812012161238121180061006200630064D83CDF56D83DDE0305D005D105D205D3",
+  "0791795214325476440C9179521032547600001210121633251236050003050202C2E170381C0E87C3E170381C0E87C3E170381C0E87C3E170381C0E87C3E170381C0E87C3E170381C0E03"
+};
+
+#define TEXTS (sizeof(texts) / sizeof(texts[0]))
+#define RECEIVED (sizeof(received) / sizeof(received[0]))
+
+// the SMS-DELIVER an SC would make of an SMS-SUBMIT without validity period, returns its length
+static int toDeliver(const unsigned char *submit, unsigned char *out) {
+  static const unsigned char scts[7] = {0x21, 0x10, 0x12, 0x16, 0x32, 0x37, 0x12};
+  int w = 0;
+  out[w++] = (submit[0] & 0x40) | 0x04;     // UDHI, no more messages to send
+  int address = 2 + (submit[2] + 1) / 2;    // length, type and digits of the recipient
+  memcpy(&out[w], &submit[2], address);
+  w += address;
+  int r = 2 + address;
+  out[w++] = submit[r];                     // PID
+  out[w++] = submit[r + 1];                 // DCS
+  memcpy(&out[w], scts, 7);
+  w += 7;
+  int udl = submit[r + 2];
+  int octets = (submit[r + 1] & 0x0c) == 0 ? (udl * 7 + 7) / 8 : udl;
+  out[w++] = udl;
+  memcpy(&out[w], &submit[r + 3], octets);
+  return w + octets;
+}
+
+// encode text, in parts if need be, and decode each part again
+static bool roundTrip(PDU &pdu, const char *text, std::string *pdus) {
+  unsigned char deliver[PDU_BINARY_MAX_LENGTH];
+  std::string decoded;
+  pdu.beginMultipart(recipient, text, 42);
+  for (int length; (length = pdu.encodeNextPartBinary()) > 0; ) {
+    pdus->append((const char *)pdu.getBinary(), length);
+    if (!pdu.decodeBinary(deliver, toDeliver(pdu.getBinary(), deliver), false))
+      return false;
+    decoded += pdu.getText();
+  }
+  return decoded == text;
+}
+
+static std::string job(int seed, int rounds, bool *ok) {
+  PDU pdu;
+  pdu.setSCAnumber(sca);
+  std::string out;
+  for (int k = 0; k < rounds; k++) {
+    const char *text = texts[(k + seed) % TEXTS];
+    if (pdu.encodePDU(recipient, text) > 0)
+      out += pdu.getSMS();
+    if (!roundTrip(pdu, text, &out))
+      *ok = false;
+    if (pdu.decodePDU(received[(k * 3 + seed) % RECEIVED])) {
+      out += pdu.getSender();
+      out += pdu.getTimeStamp();
+      out += pdu.getText();
+    }
+    else
+      *ok = false;
+  }
+  return out;
+}
+
+int main(int argc, char **argv) {
+  int rounds = argc > 1 ? atoi(argv[1]) : 20000;
+  std::vector<std::string> serial(THREADS), parallel(THREADS);
+  bool ok = true;
+  for (int i = 0; i < THREADS; i++)
+    serial[i] = job(i, rounds, &ok);
+  if (!ok) {
+    std::cerr << "a text did not decode back to itself" << std::endl;
+    return 1;
+  }
+  std::vector<std::thread> threads;
+  bool threadOk[THREADS];
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < THREADS; i++) {
+    threadOk[i] = true;
+    threads.emplace_back([&, i]() { parallel[i] = job(i, rounds, &threadOk[i]); });
+  }
+  for (std::thread &t : threads)
+    t.join();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  for (int i = 0; i < THREADS; i++)
+    if (!threadOk[i] || parallel[i] != serial[i])
+      ok = false;
+  // an encode, a round trip and a decode per round
+  std::cout << "threads,operations,seconds,result" << std::endl;
+  std::cout << THREADS << "," << (long)THREADS * rounds * 3 << "," << elapsed.count() << ","
+            << (ok ? "identical" : "DIFFERENT") << std::endl;
+  return ok ? 0 : 1;
+}
@@ -24,6 +24,23 @@ do
 		cd pdulib
 		ln -s ../../../../src/pdulib.cpp pdulib.cpp
 		ln -s ../../../../src/pdulib.h pdulib.h
+		ln -s ../../../../src/pdubasic.h pdubasic.h
+		ln -s ../../../../src/pduhex.cpp pduhex.cpp
+		ln -s ../../../../src/pduhex.h pduhex.h
+		ln -s ../../../../src/pduseptet.cpp pduseptet.cpp
+		ln -s ../../../../src/pduseptet.h pduseptet.h
+		ln -s ../../../../src/pduascii.cpp pduascii.cpp
+		ln -s ../../../../src/pduascii.h pduascii.h
+		ln -s ../../../../src/pdunational.cpp pdunational.cpp
+		ln -s ../../../../src/pdunational.h pdunational.h
+		ln -s ../../../../src/pdutranslit.cpp pdutranslit.cpp
+		ln -s ../../../../src/pdutranslit.h pdutranslit.h
+		ln -s ../../../../src/pduframe.cpp pduframe.cpp
+		ln -s ../../../../src/pduframe.h pduframe.h
+		ln -s ../../../../src/pdureassembler.cpp pdureassembler.cpp
+		ln -s ../../../../src/pdureassembler.h pdureassembler.h
+		ln -s ../../../../src/pdureceipts.cpp pdureceipts.cpp
+		ln -s ../../../../src/pdureceipts.h pdureceipts.h
 	else
 		echo "Not creating symlinks"
 	fi
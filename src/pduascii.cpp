@@ -0,0 +1,118 @@
+/**
+ * @file pduascii.cpp
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief Fast scan of plain ASCII text for the message classifier
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * The SIMD kernels test a block of characters against the plain ranges at once
+ * and stop at the first block holding anything else, the scalar code then finds
+ * the exact position. Bytes of 0x80 and above compare as negative and so fall
+ * outside every range.
+ * The kernel is chosen at run time according to the CPU.
+ */
+
+#include <pduascii.h>
+#ifdef PDU_ASCII_SIMD
+#include <immintrin.h>
+#endif
+
+// space to Z, _, a to z, LF and CR
+static inline bool plain(unsigned char c) {
+  return (unsigned char)(c - ' ') <= 'Z' - ' ' || c == '_' ||
+         (unsigned char)(c - 'a') <= 'z' - 'a' || c == '\n' || c == '\r';
+}
+
+static int asciiRunScalar(const char *text, int length) {
+  int i = 0;
+  while (i < length && plain(text[i]))
+    i++;
+  return i;
+}
+
+#ifdef PDU_ASCII_SIMD
+__attribute__((target("sse2")))
+static int asciiRunSSE2(const char *text, int length) {
+  int i = 0;
+  for (; i + 16 <= length; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)&text[i]);
+    __m128i ok = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(' ' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    ok = _mm_or_si128(ok, _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('z' + 1))));
+    ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+    ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+    ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+    int mask = _mm_movemask_epi8(ok);
+    if (mask != 0xffff)
+      return i + __builtin_ctz(~mask);
+  }
+  return i + asciiRunScalar(&text[i], length - i);
+}
+
+__attribute__((target("avx2")))
+static int asciiRunAVX2(const char *text, int length) {
+  int i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)&text[i]);
+    __m256i ok = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(' ' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+    ok = _mm256_or_si256(ok, _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), v)));
+    ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+    ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+    ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')));
+    unsigned mask = _mm256_movemask_epi8(ok);
+    if (mask != 0xffffffff)
+      return i + __builtin_ctz(~mask);
+  }
+  // finish with the SSE2 kernel, which handles its own remainder
+  _mm256_zeroupper();   // else every SSE instruction after this pays for the dirty upper halves
+  return i + asciiRunSSE2(&text[i], length - i);
+}
+
+static eAsciiKernel bestKernel() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return ASCII_KERNEL_AVX2;
+  if (__builtin_cpu_supports("sse2"))
+    return ASCII_KERNEL_SSE2;
+  return ASCII_KERNEL_SCALAR;
+}
+
+// decided once at load time and never changed
+static const eAsciiKernel autoKernel = bestKernel();
+#endif
+
+bool pduAsciiKernelSupported(eAsciiKernel kernel) {
+#ifdef PDU_ASCII_SIMD
+  switch (kernel) {
+    case ASCII_KERNEL_AVX2:
+      return autoKernel == ASCII_KERNEL_AVX2;
+    case ASCII_KERNEL_SSE2:
+      return autoKernel != ASCII_KERNEL_SCALAR;
+    default:
+      return true;
+  }
+#else
+  return kernel == ASCII_KERNEL_AUTO || kernel == ASCII_KERNEL_SCALAR;
+#endif
+}
+
+int pduAsciiRun(const char *text, int length, eAsciiKernel kernel) {
+#ifdef PDU_ASCII_SIMD
+  if (kernel == ASCII_KERNEL_AUTO)
+    kernel = autoKernel;
+  else if (!pduAsciiKernelSupported(kernel))
+    kernel = ASCII_KERNEL_SCALAR;
+  switch (kernel) {
+    case ASCII_KERNEL_AVX2:
+      return asciiRunAVX2(text, length);
+    case ASCII_KERNEL_SSE2:
+      return asciiRunSSE2(text, length);
+    default:
+      break;
+  }
+#else
+  (void)kernel;
+#endif
+  return asciiRunScalar(text, length);
+}
@@ -0,0 +1,45 @@
+/**
+ * @file pduascii.h
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief Fast scan of plain ASCII text for the message classifier
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ * @
+ */
+
+#ifdef PDU_ASCII_INCLUDE
+#else
+#define PDU_ASCII_INCLUDE
+
+// SIMD kernels are only built for x86 with gcc/clang, all others use the scalar code
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PDU_ASCII_SIMD
+#endif
+
+enum eAsciiKernel {
+  ASCII_KERNEL_AUTO,      // best supported by this CPU
+  ASCII_KERNEL_SCALAR,
+  ASCII_KERNEL_SSE2,      // 16 characters at a time
+  ASCII_KERNEL_AVX2       // 32 characters at a time
+};
+
+/**
+ * @brief Length of the run of plain characters at the start of a text.
+ * Plain characters are the ASCII characters that are in the GSM 7 bit default
+ * alphabet without an escape, i.e. each is 1 septet or 1 UCS-2 unit: letters,
+ * digits, space, CR, LF and most punctuation but not ` [ \ ] ^ { | } ~
+ *
+ * @param text The text, need not be zero terminated
+ * @param length Number of characters to scan
+ * @param kernel Force a kernel, for benchmarks. An unsupported kernel falls back to the scalar code
+ * @return int Number of plain characters before the first other character, or length
+ */
+int pduAsciiRun(const char *text, int length, eAsciiKernel kernel = ASCII_KERNEL_AUTO);
+/**
+ * @brief Check if the CPU supports a kernel
+ */
+bool pduAsciiKernelSupported(eAsciiKernel kernel);
+
+#endif
@@ -0,0 +1,1627 @@
+/**
+ * @file pdubasic.h
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief The methods of BasicPDU, included by pdulib.h
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * The codec is a template so that each build only has the code its traits
+ * ask for. Every trait is a compile time constant, a branch on one is removed
+ * by the compiler and a method that is never called is never instantiated.
+ * The default PDU is instantiated once, in pdulib.cpp.
+ */
+
+#ifdef PDU_BASIC_INCLUDE
+#else
+#define PDU_BASIC_INCLUDE
+
+#include <string.h>
+#include <pduhex.h>
+#include <pduseptet.h>
+#include <pdunational.h>
+#include <pdutranslit.h>
+
+/*
+    decode 1 UTF-8 character of at most length bytes
+    returns its length in bytes, -1 if it is not valid UTF-8 (overlong, surrogate, out of range or truncated)
+*/
+inline int pduUtf8Decode(const char *text, int length, unsigned long *cp) {
+  unsigned char c = text[0];
+  unsigned long min;
+  int n;
+  if (c < 0x80) {
+    *cp = c;
+    return 1;
+  }
+  if (c < 0xC2)
+    return -1;    // continuation byte, or overlong 2 byte sequence
+  if (c < 0xE0) {
+    n = 2;
+    *cp = c & 0x1F;
+    min = 0x80;
+  }
+  else if (c < 0xF0) {
+    n = 3;
+    *cp = c & 0x0F;
+    min = 0x800;
+  }
+  else if (c < 0xF5) {
+    n = 4;
+    *cp = c & 0x07;
+    min = 0x10000;
+  }
+  else
+    return -1;
+  if (n > length)
+    return -1;
+  for (int i = 1; i < n; i++) {
+    if ((text[i] & 0xC0) != 0x80)
+      return -1;
+    *cp = (*cp << 6) | (text[i] & 0x3F);
+  }
+  if (*cp < min || *cp > 0x10FFFF || (*cp >= 0xD800 && *cp <= 0xDFFF))
+    return -1;
+  return n;
+}
+
+// septets left in an SMS for text after a UDH of udhlength octets and its fill bits
+inline int pduSeptetBudget(int udhlength) {
+  return MAX_SMS_LENGTH_7BIT - (udhlength * 8 + 6) / 7;
+}
+
+template <class Traits>
+BasicPDU<Traits>::BasicPDU(){
+  mpMessage = NULL;
+  nationalLanguages = NATIONAL_ALL;
+  lockingShift = NATIONAL_DEFAULT;
+  singleShift = NATIONAL_DEFAULT;
+  transliteration = false;
+  transliterating = false;
+  nextReference = 0;
+  lastReference = 0;
+  statusReport = false;
+}
+template <class Traits>
+BasicPDU<Traits>::~BasicPDU(){}
+
+/*
+  Save recipient phone number, check that it is numeric
+  return true if valid
+  Save in smssubmit
+  byte 0 length in nibbles
+*/
+template <class Traits>
+bool BasicPDU<Traits>::setAddress(const char *address,eAddressType at,eLengthType lt)
+{
+  bool rc = false;
+  if (*address == '+')
+    address++;  // ignore leading +
+  addressLength = strlen(address);
+  if ( addressLength < Traits::numberLength)
+  {
+    rc = true;
+    if (lt==NIBBLES)
+      smsSubmit[smsOffset++] = addressLength;
+    else
+      smsSubmit[smsOffset++] = ((addressLength+1)/2)+1; // add 1 for length
+    switch (at) {
+      case INTERNATIONAL_NUMERIC:
+        smsSubmit[smsOffset++] = INTERNATIONAL_NUMBER;
+        stringToBCD(address,&smsSubmit[smsOffset]);
+        smsOffset += (strlen(address)+1)/2;
+        break;
+      case NATIONAL_NUMERIC:
+        smsSubmit[smsOffset++] = NATIONAL_NUMBER;
+        stringToBCD(address,&smsSubmit[smsOffset]);
+        smsOffset += (strlen(address)+1)/2;
+        break;
+      default:
+        return false;
+    }
+  }
+ // recvalid = rc;
+  return rc;
+}
+
+// convert 2 printable digits to 1 BCD byte
+template <class Traits>
+void BasicPDU<Traits>::stringToBCD(const char *number, char *pdu)
+{
+  int j, targetindex=0;
+  if (*number == '+')  // ignore leading +
+    number++;
+  for (j = 0; j < addressLength; j++)
+  {
+    if ((j & 1) == 1) // odd, upper
+    {
+      pdu[targetindex] &= 0x0f; 
+      pdu[targetindex] += (*number++ - '0') << 4;
+      targetindex++;
+    }
+    else
+    {
+      // prime in case this is the last byte
+      pdu[targetindex] = 0xf0;
+//      pdu[targetindex] &= 0xf0;  // clear lower
+      pdu[targetindex] += *number++ - '0';
+    }
+  }
+}
+
+template <class Traits>
+void BasicPDU<Traits>::digitSwap(const char *number, char *pdu) {
+  int j, targetindex=0;
+  if (*number == '+')  // ignore leading +
+    number++;
+  for (j = 0; j < addressLength; j++) {
+    if ((j & 1) == 1) // odd, upper
+    {
+      pdu[targetindex] = *number++;
+      targetindex += 2;
+    }
+    else {  // even lower
+      pdu[targetindex+1] = *number++;
+    }
+  }
+  if ((addressLength & 1) == 1) {
+    pdu[targetindex] = 'F';
+    targetindex += 2;
+  }
+  pdu[targetindex++] = 0;
+}
+
+/*
+    Input is UTF-8, characters not in the GSM 7 bit alphabet and invalid bytes are skipped
+    unless transliterating, when those with a close match are replaced by it
+    length is the number of input bytes to convert
+*/
+template <class Traits>
+int BasicPDU<Traits>::convert_utf8_to_gsm7bit(const char *utf8, char *a7bit, int length) {
+  int w = 0;
+  for (int r = 0; r < length; ) {
+    unsigned long cp;
+    int bytes = pduUtf8Decode(&utf8[r], length - r, &cp);
+    if (bytes < 0) {
+      r++;
+      continue;
+    }
+    r += bytes;
+    int septet = Traits::national ? pduNationalSeptet(cp, lockingShift, singleShift) : pduGsm7Septet(cp);
+    if (septet >= 256) {
+      a7bit[w++] = 27;    // escape to extension table
+      a7bit[w++] = septet - 256;
+    }
+    else if (septet >= 0)
+      a7bit[w++] = septet;
+    else if (Traits::transliteration && transliterating)
+      w += pduTransliterate(cp, (unsigned char *)&a7bit[w]);
+  }
+  return w;
+}
+
+
+/*
+    returns number of bytes of text that fit into budget septets (7 bit) or ucs2 units (16 bit)
+    an escape sequence, surrogate pair or transliteration is never split
+*/
+template <class Traits>
+int BasicPDU<Traits>::segmentLength(const char *text, eDCS dcs, int budget) {
+  int r = 0;
+  int cost, bytes;
+  while (text[r] != 0) {
+    if (dcs == ALPHABET_7BIT) {
+      unsigned long cp;
+      bytes = pduUtf8Decode(&text[r], 4, &cp);   // stops at the end marker, never a continuation byte
+      if (bytes < 0) {    // invalid utf8, skipped when encoding
+        bytes = 1;
+        cost = 0;
+      }
+      else {
+        int septet = Traits::national ? pduNationalSeptet(cp, lockingShift, singleShift) : pduGsm7Septet(cp);
+        if (septet < 0) {
+          unsigned char replacement[TRANSLIT_MAX_SEPTETS];
+          cost = Traits::transliteration && transliterating ? pduTransliterate(cp, replacement) : 0;
+        }
+        else
+          cost = septet >= 256 ? 2 : 1;
+      }
+    }
+    else {
+      unsigned long cp;
+      bytes = pduUtf8Decode(&text[r], 4, &cp);
+      if (bytes < 0) {    // invalid utf8, skipped when encoding
+        bytes = 1;
+        cost = 0;
+      }
+      else
+        cost = cp >= 0x10000 ? 2 : 1;   // becomes a surrogate pair
+    }
+    if (cost > budget)
+      break;
+    budget -= cost;
+    r += bytes;
+  }
+  return r;
+}
+
+/*
+    build SMS-SUBMIT up to and including the DCS octet
+    returns offset where the length parameter to +CMGS starts from, -1 if a number is too long
+*/
+template <class Traits>
+int BasicPDU<Traits>::submitHeader(const char *recipient, eDCS dcs, bool udh) {
+  int beginning;
+  bool intl = *recipient == '+';
+  smsOffset = 0;
+  if (!setAddress(scanumber,INTERNATIONAL_NUMERIC,OCTETS)) // set SCSA address
+    return -1;
+  beginning = smsOffset;     // length parameter to +CMGS starts from
+  unsigned char type = PSU_SMS_SUBMIT;   // no validation period
+  if (udh)
+    type |= UDH_EXIST;
+  if (statusReport)
+    type |= PDU_STATUS_REPORT_REQUEST;
+  smsSubmit[smsOffset++] = type;
+  lastReference = nextReference++;   // wraps at 255
+  smsSubmit[smsOffset++] = lastReference;
+  if (!setAddress(recipient,intl ? INTERNATIONAL_NUMERIC : NATIONAL_NUMERIC,NIBBLES))
+    return -1;
+  smsSubmit[smsOffset++] = 0;   // PID
+  switch (dcs) {
+    case ALPHABET_7BIT:
+      smsSubmit[smsOffset++] = DCS_7BIT_ALPHABET_MASK;
+      break;
+    case ALPHABET_8BIT:
+      smsSubmit[smsOffset++] = DCS_8BIT_ALPHABET_MASK;
+      break;
+    case ALPHABET_16BIT:
+      smsSubmit[smsOffset++] = DCS_16BIT_ALPHABET_MASK;
+      break;
+    default:
+      break;
+  }
+  return beginning;
+}
+
+/*
+    add length and user data to the header built by submitHeader
+    if udhlength is not 0 the UDH has to be filled in by the caller
+    for 8 bit data text is the octets, copied as they are
+    returns length of the binary SMS-SUBMIT
+*/
+template <class Traits>
+int BasicPDU<Traits>::encodeSegment(const char *text, int length, eDCS dcs, int udhlength) {
+  int udl = smsOffset++;
+  char *ud = &smsSubmit[smsOffset];
+  int octets = udhlength;
+  if (dcs == ALPHABET_7BIT) {
+    char gsm7bit[MAX_SMS_LENGTH_7BIT];
+    int headerSeptets = (udhlength * 8 + 6) / 7;   // includes fill bits
+    int septets = convert_utf8_to_gsm7bit(text, gsm7bit, length);
+    octets = pduPackSeptets((const unsigned char *)gsm7bit, septets, (unsigned char *)ud, headerSeptets);
+    smsSubmit[udl] = headerSeptets + septets;  // length in septets
+  }
+  else if (dcs == ALPHABET_8BIT) {
+    memcpy(&ud[octets], text, length);
+    octets += length;
+    smsSubmit[udl] = octets;   // length in octets
+  }
+  else {
+    int r = 0;
+    while (r < length) {
+      unsigned long cp;
+      int inputlen = pduUtf8Decode(&text[r], length - r, &cp);
+      if (inputlen < 0) {   // skip invalid utf8
+        r++;
+        continue;
+      }
+      if (cp >= 0x10000) {  // surrogate pair
+        cp -= 0x10000;
+        unsigned short hi = 0xD800 | (cp >> 10), lo = 0xDC00 | (cp & 0x3ff);
+        ud[octets++] = hi >> 8;
+        ud[octets++] = hi & 0xff;
+        ud[octets++] = lo >> 8;
+        ud[octets++] = lo & 0xff;
+      }
+      else {
+        ud[octets++] = cp >> 8;
+        ud[octets++] = cp & 0xff;
+      }
+      r += inputlen;
+    }
+    smsSubmit[udl] = octets;   // length in octets
+  }
+  return smsOffset + octets;
+}
+
+/*
+    octets of UDH needed by the message being encoded, including UDHL, 0 if none
+*/
+template <class Traits>
+int BasicPDU<Traits>::udhLength(bool concatenated) {
+  int length = 0;
+  if (lockingShift != NATIONAL_DEFAULT)
+    length += UDH_SHIFT_LENGTH;
+  if (singleShift != NATIONAL_DEFAULT)
+    length += UDH_SHIFT_LENGTH;
+  if (concatenated)
+    length += mpReference > 0xff ? UDH_CSM_16_LENGTH : UDH_CSM_8_LENGTH;
+  else if (length > 0)
+    length++;   // UDHL
+  return length;
+}
+
+// fill in the UDH measured by udhLength
+template <class Traits>
+void BasicPDU<Traits>::writeUDH(char *udh, int udhlength, bool concatenated) {
+  *udh++ = udhlength - 1;   // UDHL
+  if (concatenated) {
+    if (mpReference > 0xff) {
+      *udh++ = IEI_CSM_16;
+      *udh++ = 4;   // IEL
+      *udh++ = mpReference >> 8;
+    }
+    else {
+      *udh++ = IEI_CSM_8;
+      *udh++ = 3;   // IEL
+    }
+    *udh++ = mpReference & 0xff;
+    *udh++ = mpTotal;
+    *udh++ = mpPart;
+  }
+  if (lockingShift != NATIONAL_DEFAULT) {
+    *udh++ = IEI_LOCKING_SHIFT;
+    *udh++ = 1;   // IEL
+    *udh++ = lockingShift;
+  }
+  if (singleShift != NATIONAL_DEFAULT) {
+    *udh++ = IEI_SINGLE_SHIFT;
+    *udh++ = 1;   // IEL
+    *udh++ = singleShift;
+  }
+}
+
+// convert the binary SMS-SUBMIT to printable and add ctrl z, out may be smsSubmit itself
+template <class Traits>
+void BasicPDU<Traits>::binaryToHex(int length, char *out) {
+  pduBinaryToHex((const unsigned char *)smsSubmit, length, out);
+  out[length*2] = 0x1a;  // add ctrl z
+  out[(length*2)+1] = 0;  // add end marker
+}
+
+/* creates an buffer in SMS SUBMIT format and returns length, -1 if invalid in anyway
+    https://bluesecblog.wordpress.com/2016/11/16/sms-submit-tpdu-structure/
+*/
+template <class Traits>
+int BasicPDU<Traits>::encodeBinary(const char *recipient, const char *message)
+{
+  PDUTextInfo info;
+  int textlength = strlen(message);
+  // too long for a single SMS, use beginMultipart instead
+  if (pduClassify(message, textlength, &info, languages(), transliteration && Traits::transliteration) != 1)
+    return -1;
+  eDCS dcs = info.alphabet;
+  if (dcs == ALPHABET_16BIT && !Traits::ucs2)
+    return -1;
+  lockingShift = info.lockingShift;
+  singleShift = info.singleShift;
+  transliterating = info.transliterated > 0;
+  int udhlength = udhLength(false);
+  tpduOffset = submitHeader(recipient, dcs, udhlength > 0);
+  if (tpduOffset < 0)
+    return -1;
+  if (udhlength > 0)
+    writeUDH(&smsSubmit[smsOffset + 1], udhlength, false);  // skip over UDL
+  submitLength = encodeSegment(message, textlength, dcs, udhlength);
+  return submitLength - tpduOffset;
+}
+
+template <class Traits>
+int BasicPDU<Traits>::encodePDU(const char *recipient, const char *message)
+{
+  static_assert(Traits::printable, "no room for a printable PDU, use encodeBinary or an output buffer");
+  int length = encodeBinary(recipient, message);
+  if (length < 0)
+    return -1;
+  // now convert from binary to printable
+  binaryToHex(submitLength, smsSubmit);
+  return length;
+}
+
+template <class Traits>
+int BasicPDU<Traits>::encodePDU(const char *recipient, const char *message, char *out, size_t size)
+{
+  unsigned char reference = nextReference;
+  int length = encodeBinary(recipient, message);
+  if (length < 0)
+    return -1;
+  int rc = hexOut(length, out, size);
+  if (rc < -1)
+    nextReference = reference;    // nothing was sent, the reference is free
+  return rc;
+}
+
+template <class Traits>
+int BasicPDU<Traits>::encodeBinary(const char *recipient, const char *message, unsigned char *out, size_t size)
+{
+  unsigned char reference = nextReference;
+  int length = encodeBinary(recipient, message);
+  if (length < 0)
+    return -1;
+  int rc = binaryOut(length, out, size);
+  if (rc < -1)
+    nextReference = reference;
+  return rc;
+}
+
+/*
+    copy the PDU just encoded to a caller's buffer, printable with CTRL/Z and end marker
+    returns length, or minus the size needed if out is too small
+*/
+template <class Traits>
+int BasicPDU<Traits>::hexOut(int length, char *out, size_t size) {
+  size_t needed = (size_t)submitLength * 2 + 2;
+  if (needed > size)
+    return -(int)needed;
+  binaryToHex(submitLength, out);
+  return length;
+}
+
+// as hexOut for the binary TPDU
+template <class Traits>
+int BasicPDU<Traits>::binaryOut(int length, unsigned char *out, size_t size) {
+  if ((size_t)length > size)
+    return -length;
+  memcpy(out, &smsSubmit[tpduOffset], length);
+  return length;
+}
+
+template <class Traits>
+int BasicPDU<Traits>::encodeDataBinary(const char *recipient, const unsigned char *data, int length, long destinationPort, long originatorPort)
+{
+  if (!Traits::data8)
+    return -1;
+  bool ports = destinationPort != NO_PORT;
+  bool wide = destinationPort > 0xff || originatorPort > 0xff;
+  int udhlength = !ports ? 0 : wide ? UDH_PORT_16_LENGTH : UDH_PORT_8_LENGTH;
+  if (length < 0 || udhlength + length > MAX_SMS_OCTETS)
+    return -1;
+  if (ports && (destinationPort < 0 || destinationPort > 0xffff || originatorPort < 0 || originatorPort > 0xffff))
+    return -1;
+  tpduOffset = submitHeader(recipient, ALPHABET_8BIT, ports);
+  if (tpduOffset < 0)
+    return -1;
+  if (ports) {
+    char *udh = &smsSubmit[smsOffset + 1];  // skip over UDL
+    *udh++ = udhlength - 1;   // UDHL
+    if (wide) {
+      *udh++ = IEI_PORT_16;
+      *udh++ = 4;   // IEL
+      *udh++ = destinationPort >> 8;
+      *udh++ = destinationPort & 0xff;
+      *udh++ = originatorPort >> 8;
+      *udh++ = originatorPort & 0xff;
+    }
+    else {
+      *udh++ = IEI_PORT_8;
+      *udh++ = 2;   // IEL
+      *udh++ = destinationPort;
+      *udh++ = originatorPort;
+    }
+  }
+  submitLength = encodeSegment((const char *)data, length, ALPHABET_8BIT, udhlength);
+  return submitLength - tpduOffset;
+}
+
+template <class Traits>
+int BasicPDU<Traits>::encodeData(const char *recipient, const unsigned char *data, int length, long destinationPort, long originatorPort)
+{
+  static_assert(Traits::printable, "no room for a printable PDU, use encodeDataBinary or an output buffer");
+  int tpdulength = encodeDataBinary(recipient, data, length, destinationPort, originatorPort);
+  if (tpdulength < 0)
+    return -1;
+  binaryToHex(submitLength, smsSubmit);
+  return tpdulength;
+}
+
+template <class Traits>
+int BasicPDU<Traits>::encodeData(const char *recipient, const unsigned char *data, int length, long destinationPort, long originatorPort, char *out, size_t size)
+{
+  unsigned char reference = nextReference;
+  int tpdulength = encodeDataBinary(recipient, data, length, destinationPort, originatorPort);
+  if (tpdulength < 0)
+    return -1;
+  int rc = hexOut(tpdulength, out, size);
+  if (rc < -1)
+    nextReference = reference;
+  return rc;
+}
+
+template <class Traits>
+int BasicPDU<Traits>::encodeDataBinary(const char *recipient, const unsigned char *data, int length, long destinationPort, long originatorPort, unsigned char *out, size_t size)
+{
+  unsigned char reference = nextReference;
+  int tpdulength = encodeDataBinary(recipient, data, length, destinationPort, originatorPort);
+  if (tpdulength < 0)
+    return -1;
+  int rc = binaryOut(tpdulength, out, size);
+  if (rc < -1)
+    nextReference = reference;
+  return rc;
+}
+
+template <class Traits>
+const unsigned char *BasicPDU<Traits>::getBinary() {
+  return (const unsigned char *)&smsSubmit[tpduOffset];
+}
+
+template <class Traits>
+int BasicPDU<Traits>::beginMultipart(const char *recipient, const char *message, unsigned short reference)
+{
+  PDUTextInfo info;
+  pduClassify(message, -1, &info, languages(), transliteration && Traits::transliteration);
+  eDCS dcs = info.alphabet;
+  lockingShift = info.lockingShift;
+  singleShift = info.singleShift;
+  transliterating = info.transliterated > 0;
+  mpReference = reference;
+  int udhlength = udhLength(true);
+  int single, budget, total = 0;
+  mpMessage = NULL;
+  if (dcs == ALPHABET_16BIT && !Traits::ucs2)
+    return -1;
+  if (dcs == ALPHABET_7BIT) {
+    single = pduSeptetBudget(udhLength(false));
+    budget = pduSeptetBudget(udhlength);
+  }
+  else {
+    single = MAX_SMS_LENGTH_16BIT;
+    budget = (MAX_SMS_OCTETS - udhlength) / 2;
+  }
+  const char *text = message;
+  if (reference <= 0xff)
+    total = info.segments;    // pduClassify splits the same way
+  else if (text[segmentLength(text, dcs, single)] == 0)
+    total = 1;
+  else {
+    while (*text && total <= MAX_SMS_PARTS) {
+      total++;
+      text += segmentLength(text, dcs, budget);
+    }
+  }
+  if (total > MAX_SMS_PARTS)
+    return -1;
+  // as setAddress will check it, rather than send the parts to a truncated number
+  if (strlen(recipient) - (*recipient == '+') >= (size_t)Traits::numberLength)
+    return -1;
+  strcpy(mpRecipient, recipient);
+  mpMessage = message;
+  mpTotal = total;
+  mpPart = 0;
+  mpDcs = dcs;
+  mpLocking = lockingShift;
+  mpSingle = singleShift;
+  mpTransliterating = transliterating;
+  return total;
+}
+
+template <class Traits>
+int BasicPDU<Traits>::encodeNextPartBinary()
+{
+  int textlength;
+  if (mpMessage == NULL || mpPart == mpTotal)
+    return -1;
+  mpPart++;
+  lockingShift = mpLocking;   // encodePDU may have been used in between
+  singleShift = mpSingle;
+  transliterating = mpTransliterating;
+  bool concatenated = mpTotal > 1;
+  int udhlength = udhLength(concatenated);
+  if (concatenated) {
+    int budget = mpDcs == ALPHABET_7BIT ? pduSeptetBudget(udhlength) : (MAX_SMS_OCTETS - udhlength) / 2;
+    textlength = segmentLength(mpMessage, mpDcs, budget);
+  }
+  else
+    textlength = strlen(mpMessage);
+  tpduOffset = submitHeader(mpRecipient, mpDcs, udhlength > 0);
+  if (tpduOffset < 0) {
+    mpMessage = NULL;
+    return -1;
+  }
+  if (udhlength > 0)
+    writeUDH(&smsSubmit[smsOffset + 1], udhlength, concatenated);  // skip over UDL
+  submitLength = encodeSegment(mpMessage, textlength, mpDcs, udhlength);
+  mpMessage += textlength;
+  return submitLength - tpduOffset;
+}
+
+template <class Traits>
+int BasicPDU<Traits>::encodeNextPart()
+{
+  static_assert(Traits::printable, "no room for a printable PDU, use encodeNextPartBinary or an output buffer");
+  int length = encodeNextPartBinary();
+  if (length < 0)
+    return -1;
+  // now convert from binary to printable
+  binaryToHex(submitLength, smsSubmit);
+  return length;
+}
+
+template <class Traits>
+int BasicPDU<Traits>::encodeNextPart(char *out, size_t size)
+{
+  const char *message = mpMessage;
+  unsigned char reference = nextReference;
+  int length = encodeNextPartBinary();
+  if (length < 0)
+    return -1;
+  int rc = hexOut(length, out, size);
+  if (rc < -1) {    // the same part is encoded again on the next call
+    mpMessage = message;
+    mpPart--;
+    nextReference = reference;
+  }
+  return rc;
+}
+
+template <class Traits>
+int BasicPDU<Traits>::encodeNextPartBinary(unsigned char *out, size_t size)
+{
+  const char *message = mpMessage;
+  unsigned char reference = nextReference;
+  int length = encodeNextPartBinary();
+  if (length < 0)
+    return -1;
+  int rc = binaryOut(length, out, size);
+  if (rc < -1) {
+    mpMessage = message;
+    mpPart--;
+    nextReference = reference;
+  }
+  return rc;
+}
+
+// convert 2 printable characters to 1 byte, upper or lower case
+template <class Traits>
+unsigned char BasicPDU<Traits>::gethex(const char *pc)
+{
+  unsigned char hi = pc[0];
+  unsigned char lo = pc[1];
+  hi = hi <= '9' ? hi - '0' : (hi | 0x20) - 'a' + 10;
+  lo = lo <= '9' ? lo - '0' : (lo | 0x20) - 'a' + 10;
+  return (hi << 4) | (lo & 0xf);
+}
+
+// read 1 octet of a view, whether printable or binary
+template <class Traits>
+unsigned char BasicPDU<Traits>::getOctet(const PDUView *view, int offset) {
+  if (view->binary)
+    return (unsigned char)view->pdu[offset];
+  return gethex(&view->pdu[offset * 2]);
+}
+
+/*
+    length is in octets, output buffer ucs2 must be big enough to receive the results
+*/
+template <class Traits>
+int BasicPDU<Traits>::pdu_to_ucs2(const PDUView *view, int offset, int length, unsigned short *ucs2) {
+  int indexOut = 0;
+  for (int octet = 0; octet + 1 < length; octet += 2)
+    ucs2[indexOut++] = (getOctet(view, offset + octet) << 8) | getOctet(view, offset + octet + 1);  // big endian
+  return indexOut;
+}
+
+/*
+    returns length of the complete UTF-8 string, if that is not less than size
+    the string was truncated
+*/
+template <class Traits>
+int BasicPDU<Traits>::convert_7bit_to_ascii(unsigned char *a7bit, int length, char *ascii, int size, int locking, int single) {
+  // without the tables a phone shows the default alphabet character
+  bool national = Traits::national && (locking != NATIONAL_DEFAULT || single != NATIONAL_DEFAULT);
+  unsigned char buf[5];   // a table entry, or the UTF-8 of a national character and end marker
+  const unsigned char *entry;
+  int w = 0;
+  for (int r = 0; r < length; r++) {
+    int index = a7bit[r] & BITMASK_7BITS;
+    bool escaped = false;
+    if (index == 27) {
+      // escape, the next septet is in the extension table
+      if (++r == length)
+        break;    // nothing follows, ignore it
+      index = a7bit[r] & BITMASK_7BITS;
+      escaped = true;
+    }
+    long cp = national ? pduNationalChar(index, escaped, locking, single) : -1;
+    if (cp >= 0) {
+      buf[0] = buildUtf(cp, (char *)&buf[1]);
+      entry = buf;
+    }
+    else {
+      if (escaped && !national)
+        index += GSM7_EXTENSION;
+#ifdef PM
+      memcpy_P(buf, lookup_gsm7_utf8[index], 4);
+      entry = buf;
+#else
+      entry = lookup_gsm7_utf8[index];
+#endif
+    }
+    int n = entry[0];
+    if (w + 3 < size)
+      memcpy(&ascii[w], &entry[1], 3);  // always 3, only n count
+    else if (w + n < size)
+      memcpy(&ascii[w], &entry[1], n);
+    else if (w < size)
+      ascii[w] = 0;   // first character that does not fit
+    w += n;
+  }
+
+  /* Terminate the result string */
+  if (w < size)
+    ascii[w] = 0;
+
+  return w;
+}
+
+/*
+    unpack septets from the octet at offset, starting at septet position startSeptet
+    i.e. after any UDH and fill bits
+*/
+template <class Traits>
+int BasicPDU<Traits>::unpackSeptets(const PDUView *view, int offset, int startSeptet, int septets, unsigned char *a7bit) {
+  unsigned char binary[(MAX_SMS_LENGTH_7BIT * 7) / 8 + 8];
+  if (view->binary)
+    return pduUnpackSeptets((const unsigned char *)&view->pdu[offset], startSeptet, septets, a7bit);
+  // skip whole groups of 8 septets in 7 octets, then convert only the octets holding the septets
+  offset += (startSeptet / 8) * 7;
+  startSeptet %= 8;
+  int octets = (startSeptet * 7 + septets * 7 + 7) / 8;
+  if (pduHexToBinary(&view->pdu[offset * 2], octets * 2, binary) < 0)
+    return 0;
+  return pduUnpackSeptets(binary, startSeptet, septets, a7bit);
+}
+
+template <class Traits>
+int BasicPDU<Traits>::pdu_to_ascii(const PDUView *view, int offset, int startSeptet, int septets, char *ascii, int size) {
+  unsigned char ascii7bit[MAX_SMS_LENGTH_7BIT];
+  if (septets > MAX_SMS_LENGTH_7BIT)
+    septets = MAX_SMS_LENGTH_7BIT;
+  // first decompress the 7-bit characters
+  septets = unpackSeptets(view, offset, startSeptet, septets, ascii7bit);
+  return convert_7bit_to_ascii(ascii7bit, septets, ascii, size, view->udh.lockingShift, view->udh.singleShift);
+}
+
+template <class Traits>
+bool BasicPDU<Traits>::addressTypeValid(unsigned char adt) {
+  if ((adt & EXT_MASK) == 0)
+    return false;   // dont know how to handle EXT
+  switch ((adt & TON_MASK) >> TON_OFFSET) {
+    case 1:  // international number
+    case 2:  // national number
+    case 5:  // alphabetic
+      return true;
+    default:
+      return false;
+  }
+}
+
+/*
+  Locate the SCA, if there is one
+  returns the offset of the TPDU, -1 if invalid
+*/
+template <class Traits>
+int BasicPDU<Traits>::parseSCA(PDUView *view, bool withSCA) {
+  view->scaOffset = 0;
+  view->scaLength = 0;
+  view->scaType = 0;
+  if (!withSCA)
+    return 0;
+  if (view->length < 1)
+    return -1;
+  int scalen = getOctet(view, 0);   // SCA length in octets, including type of address
+  if (scalen > 0) {
+    if (1 + scalen > view->length)
+      return -1;
+    view->scaType = getOctet(view, 1);
+    view->scaOffset = 2;
+    view->scaLength = (scalen - 1) * 2;
+    if (!addressTypeValid(view->scaType))
+      return -1;
+  }
+  return 1 + scalen;
+}
+
+/*
+  Locate the fields of a message without copying any of them
+  view->pdu, binary and length must be set by the caller
+  returns true for success else false
+*/
+template <class Traits>
+bool BasicPDU<Traits>::parseView(PDUView *view, bool withSCA) {
+  int length = view->length;
+  int udoctets;
+  int index = parseSCA(view, withSCA);
+  if (index < 0 || index + 3 > length)
+    return false;
+  view->pduType = getOctet(view, index);   // SMS deliver
+  if ((view->pduType & PDU_TYPE_MASK) != PSU_SMS_DELIVER)
+    return false;   // a status report is decoded by decodeStatusReport
+  view->senderLength = getOctet(view, index + 1);  // in nibbles
+  view->senderType = getOctet(view, index + 2);
+  view->senderOffset = index + 3;
+  if (!addressTypeValid(view->senderType))
+    return false;
+  index = view->senderOffset + (view->senderLength + 1) / 2;  // odd length has a filler
+  if (index + 10 > length)   // PID, DCS, SCTS, UDL
+    return false;
+  view->pid = getOctet(view, index);
+  view->dcs = getOctet(view, index + 1); // data coding system
+  view->tsOffset = index + 2;   // SCTS is 7 octets
+  view->udl = getOctet(view, index + 9);
+  view->udOffset = index + 10;
+  if ((view->dcs & DCS_ALPHABET_MASK) == DCS_7BIT_ALPHABET_MASK)
+    udoctets = (view->udl * 7 + 7) / 8;
+  else
+    udoctets = view->udl;
+  if (view->udOffset + udoctets > length)
+    return false;
+  view->udhLength = 0;
+  view->udh.iei = 0;
+  view->udh.ied.number = 0;
+  view->udh.ied.total = 0;
+  view->udh.ied.part = 0;
+  view->udh.lockingShift = NATIONAL_DEFAULT;
+  view->udh.singleShift = NATIONAL_DEFAULT;
+  view->udh.portIei = 0;
+  view->udh.destinationPort = 0;
+  view->udh.originatorPort = 0;
+  if (view->pduType & UDH_EXIST) {
+    if (udoctets == 0 || getOctet(view, view->udOffset) + 1 > udoctets)
+      return false;
+    view->udhLength = decodeUDH(view, view->udOffset, &view->udh);
+  }
+  return true;
+}
+
+template <class Traits>
+bool BasicPDU<Traits>::decodeView(const char *pdu, PDUView *view) {
+  // the same check as decodePDU, with nothing converted
+  int length = hexLength(pdu);
+  if (length < 0 || (length = pduHexValidate(pdu, length)) < 0)
+    return false;
+  view->pdu = pdu;
+  view->binary = false;
+  view->length = length;
+  return parseView(view, true);
+}
+
+template <class Traits>
+bool BasicPDU<Traits>::decodeViewBinary(const unsigned char *pdu, int length, PDUView *view, bool withSCA) {
+  view->pdu = (const char *)pdu;
+  view->binary = true;
+  view->length = length;
+  return parseView(view, withSCA);
+}
+
+template <class Traits>
+int BasicPDU<Traits>::viewSCA(const PDUView *view, char *out, size_t size) {
+  return addressToString(view, view->scaOffset, view->scaLength, view->scaType, out, size);
+}
+
+template <class Traits>
+int BasicPDU<Traits>::viewSender(const PDUView *view, char *out, size_t size) {
+  return addressToString(view, view->senderOffset, view->senderLength, view->senderType, out, size);
+}
+
+template <class Traits>
+int BasicPDU<Traits>::viewTimeStamp(const PDUView *view, char *out, size_t size) {
+  return timeStampToString(view, view->tsOffset, out, size);
+}
+
+// the 7 octets of a timestamp at offset as 14 digits, as for viewSCA
+template <class Traits>
+int BasicPDU<Traits>::timeStampToString(const PDUView *view, int offset, char *out, size_t size) {
+  int w = 0;
+  for (int i = 0; i < 7; i++)
+  {
+    unsigned char X = getOctet(view, offset + i);
+    if (w + 2 < (int)size) {
+      out[w] = (X & 0xf) + 0x30;
+      out[w + 1] = (X >> 4) + 0x30;
+    }
+    else if (w < (int)size)
+      out[w] = 0;
+    w += 2;
+  }
+  if (w < (int)size)
+    out[w] = 0;
+  return w;
+}
+
+template <class Traits>
+int BasicPDU<Traits>::viewText(const PDUView *view, char *out, size_t size) {
+  int offset = view->udOffset;
+  int dulength = view->udl;
+  int udhlength = view->udhLength;
+  int i;
+  int utfoffset, utflength;
+  unsigned short ucs2;
+  unsigned short highSurrogate = 0;  // surrogate pair state, local so decoding is reentrant
+  char utf[4];
+  switch (view->dcs & DCS_ALPHABET_MASK)
+  {
+    case DCS_7BIT_ALPHABET_MASK:
+      // dulength is in septets, UDH is padded with fill bits to a septet boundary
+      i = (udhlength * 8 + 6) / 7;
+      return pdu_to_ascii(view, offset, i, dulength - i, out, size);
+    case DCS_16BIT_ALPHABET_MASK:
+      if (!Traits::ucs2)
+        return -1;
+      // loop on all ucs2 words until done
+      offset += udhlength; // skip over UDH
+      dulength -= udhlength;
+      utfoffset = 0;
+      while (dulength > 1) {
+        pdu_to_ucs2(view,offset,2,&ucs2); // treat 2 octets
+        offset += 2;
+        dulength -=2;
+        utflength = ucs2_to_utf8(ucs2,utf,&highSurrogate);
+        if (utfoffset + utflength < (int)size)
+          memcpy(out + utfoffset, utf, utflength);
+        else if (utfoffset < (int)size)
+          out[utfoffset] = 0;
+        utfoffset += utflength;
+      }
+      if (utfoffset < (int)size)
+        out[utfoffset] = 0;  // end marker
+      return utfoffset;
+    default:
+      return -1;
+  }
+}
+
+template <class Traits>
+int BasicPDU<Traits>::viewTextSize(const PDUView *view) {
+  int septets;
+  switch (view->dcs & DCS_ALPHABET_MASK)
+  {
+    case DCS_7BIT_ALPHABET_MASK:
+      septets = view->udl - (view->udhLength * 8 + 6) / 7;
+      return (septets > 0 ? septets * 3 : 0) + 1;   // € or a national character
+    case DCS_16BIT_ALPHABET_MASK:
+      if (!Traits::ucs2)
+        return -1;
+      return (view->udl - view->udhLength) / 2 * 3 + 1;   // a surrogate pair is 4 for 2 units
+    case DCS_8BIT_ALPHABET_MASK:
+      if (!Traits::data8)
+        return -1;
+      return view->udl - view->udhLength;
+    default:
+      return -1;
+  }
+}
+
+template <class Traits>
+int BasicPDU<Traits>::viewData(const PDUView *view, unsigned char *out, size_t size) {
+  if (!Traits::data8 || (view->dcs & DCS_ALPHABET_MASK) != DCS_8BIT_ALPHABET_MASK)
+    return -1;
+  int length = view->udl - view->udhLength;
+  if (length < 0)
+    length = 0;
+  for (int i = 0; i < length && i < (int)size; i++)
+    out[i] = getOctet(view, view->udOffset + view->udhLength + i);
+  return length;
+}
+
+/*
+  Copy all fields of a view to the member buffers
+  returns true for success else false
+*/
+template <class Traits>
+bool BasicPDU<Traits>::decodeFields(const PDUView *view) {
+  pduType = view->pduType;
+  udh = view->udh;
+  viewSCA(view, scabuff, sizeof(scabuff));
+  viewSender(view, addressBuff, sizeof(addressBuff));
+  viewTimeStamp(view, tsbuff, sizeof(tsbuff));
+  *mesbuff = 0;
+  if ((view->dcs & DCS_ALPHABET_MASK) == DCS_8BIT_ALPHABET_MASK) {
+    meslength = viewData(view, (unsigned char *)mesbuff, sizeof(mesbuff) - 1);  // at most 140
+    if (meslength < 0)
+      return false;
+    if (meslength >= (int)sizeof(mesbuff))
+      meslength = sizeof(mesbuff) - 1;
+    mesbuff[meslength] = 0;
+    return true;
+  }
+  meslength = viewText(view, mesbuff, sizeof(mesbuff));
+  if (meslength < 0)
+    return false;
+  if (meslength >= (int)sizeof(mesbuff))
+    meslength = strlen(mesbuff);
+  return true;
+}
+
+/*
+  Decode a complete message
+  returns true for success else false
+*/
+// convert a PDU from the modem to binary, returns the number of octets, -1 if invalid
+// characters of hex, -1 if too long for a PDU
+template <class Traits>
+int BasicPDU<Traits>::hexLength(const char *pdu) {
+  int length = strlen(pdu);
+  while (length > 0 && (pdu[length-1] == '\r' || pdu[length-1] == '\n'))
+    length--;   // allow for line ending from modem
+  if (length > PDU_DELIVER_MAX_LENGTH*2)
+    return -1;
+  return length;
+}
+
+template <class Traits>
+int BasicPDU<Traits>::hexToBinary(const char *pdu, unsigned char *binary) {
+  int length = hexLength(pdu);
+  if (length < 0)
+    return -1;
+  // convert the whole PDU in one pass, all further decoding is on octets
+  return pduHexToBinary(pdu, length, binary);
+}
+
+template <class Traits>
+bool BasicPDU<Traits>::decodePDU(const char *pdu){
+  unsigned char binary[PDU_DELIVER_MAX_LENGTH];
+  int length = hexToBinary(pdu, binary);
+  if (length < 0)
+    return false;
+  return decodeBinary(binary, length);
+}
+
+template <class Traits>
+int BasicPDU<Traits>::decodeBatch(const char *const *pdus, int count, PDUBatch *batch) {
+  int ok = 0;
+  for (int i = 0; i < count; i++) {
+    eBatchStatus status = decodeBatchEntry(pdus[i], i, batch);
+    if (batch->status)
+      batch->status[i] = status;
+    if (status == BATCH_OK)
+      ok++;
+  }
+  return ok;
+}
+
+// fill in entry i of each column that is present
+template <class Traits>
+eBatchStatus BasicPDU<Traits>::decodeBatchEntry(const char *pdu, int i, PDUBatch *batch) {
+  unsigned char binary[PDU_DELIVER_MAX_LENGTH];
+  PDUView view;
+  if (batch->textOffset)
+    batch->textOffset[i] = batch->arenaUsed;
+  if (batch->textLength)
+    batch->textLength[i] = 0;
+  int length = hexToBinary(pdu, binary);
+  if (length < 0 || !decodeViewBinary(binary, length, &view)) {
+    if (batch->sca)
+      *batch->sca[i] = 0;
+    if (batch->sender)
+      *batch->sender[i] = 0;
+    if (batch->timeStamp)
+      *batch->timeStamp[i] = 0;
+    return BATCH_INVALID;
+  }
+  if (batch->sca)
+    viewSCA(&view, batch->sca[i], numberField);
+  if (batch->sender)
+    viewSender(&view, batch->sender[i], numberField);
+  if (batch->timeStamp)
+    viewTimeStamp(&view, batch->timeStamp[i], TIMESTAMP_LENGTH);
+  if (batch->dcs)
+    batch->dcs[i] = view.dcs;
+  if (batch->udhIei)
+    batch->udhIei[i] = view.udh.iei;
+  if (batch->udhNumber)
+    batch->udhNumber[i] = view.udh.ied.number;
+  if (batch->udhTotal)
+    batch->udhTotal[i] = view.udh.ied.total;
+  if (batch->udhPart)
+    batch->udhPart[i] = view.udh.ied.part;
+  if (batch->arena == NULL)
+    return BATCH_OK;
+  size_t room = batch->arenaSize - batch->arenaUsed;
+  int textlength;
+  if ((view.dcs & DCS_ALPHABET_MASK) == DCS_8BIT_ALPHABET_MASK) {
+    textlength = viewData(&view, (unsigned char *)&batch->arena[batch->arenaUsed], room);
+    if ((size_t)textlength < room)
+      batch->arena[batch->arenaUsed + textlength] = 0;
+  }
+  else
+    textlength = viewText(&view, &batch->arena[batch->arenaUsed], room);
+  if (textlength < 0)
+    return BATCH_ALPHABET;
+  if ((size_t)textlength >= room)
+    return BATCH_ARENA_FULL;
+  if (batch->textLength)
+    batch->textLength[i] = textlength;
+  batch->arenaUsed += textlength + 1;
+  return BATCH_OK;
+}
+
+template <class Traits>
+bool BasicPDU<Traits>::decodeBinary(const unsigned char *pdu, int length, bool withSCA){
+  PDUView view;
+  if (!decodeViewBinary(pdu, length, &view, withSCA))
+    return false;
+  return decodeFields(&view);
+}
+
+template <class Traits>
+bool BasicPDU<Traits>::decodeStatusReport(const char *pdu, PDUStatusReport *report) {
+  unsigned char binary[PDU_DELIVER_MAX_LENGTH];
+  int length = hexToBinary(pdu, binary);
+  if (length < 0)
+    return false;
+  return decodeStatusReportBinary(binary, length, report);
+}
+
+/*
+  SMS-STATUS-REPORT: type, MR, recipient address, SCTS, discharge time, status
+  anything after the status (parameter indicator, user data) is ignored
+*/
+template <class Traits>
+bool BasicPDU<Traits>::decodeStatusReportBinary(const unsigned char *pdu, int length, PDUStatusReport *report, bool withSCA) {
+  PDUView view;
+  view.pdu = (const char *)pdu;
+  view.binary = true;
+  view.length = length;
+  int index = parseSCA(&view, withSCA);
+  if (index < 0 || index + 4 > length)
+    return false;
+  if ((getOctet(&view, index) & PDU_TYPE_MASK) != PSU_SMS_STATUS_REPORT)
+    return false;
+  report->reference = getOctet(&view, index + 1);
+  int addressLength = getOctet(&view, index + 2);   // in nibbles
+  unsigned char addressType = getOctet(&view, index + 3);
+  int address = index + 4;
+  index = address + (addressLength + 1) / 2;
+  if ((addressType & EXT_MASK) == 0 || index + 15 > length)  // SCTS, DT, ST
+    return false;
+  addressToString(&view, address, addressLength, addressType, report->recipient, numberField);
+  timeStampToString(&view, index, report->timeStamp, TIMESTAMP_LENGTH);
+  timeStampToString(&view, index + 7, report->dischargeTime, TIMESTAMP_LENGTH);
+  report->status = getOctet(&view, index + 14);
+  return true;
+}
+
+/*
+    Utilities to convert between UTF-8 and UCS-2
+    ANSII-C can be used anywhere
+
+    Author David Henry mgadriver@gmail.com
+*/
+
+#define BITS7654ON   0B11110000
+#define BITS765ON   0B11100000
+#define BITS76ON    0B11000000
+#define BIT7ON6OFF  0B10000000
+#define BITS0TO5ON  0B00111111
+
+/*
+    highSurrogate holds the first half of a surrogate pair between calls, it is
+    owned by the caller and must be 0 at the start of a string
+*/
+template <class Traits>
+int BasicPDU<Traits>::ucs2_to_utf8(unsigned short ucs2, char *outbuf, unsigned short *highSurrogate)
+{
+  if (/*ucs2>=0 and*/ ucs2 <= 0x7f)  // 7F(16) = 127(10)
+  {
+      outbuf[0] = ucs2;
+      return 1;
+  }
+  else if (ucs2 <= 0x7ff)  // 7FF(16) = 2047(10)
+  {
+      unsigned char c1 = BITS76ON, c2 = BIT7ON6OFF;
+
+      for (int k=0; k<11; ++k)
+      {
+          if (k < 6)
+              c2 |= (ucs2 % 64) & (1 << k);
+          else
+              c1 |= (ucs2 >> 6) & (1 << (k - 6));
+      }
+
+      outbuf[0] = c1;
+      outbuf[1] = c2;
+      
+      return 2;
+  }
+  else if ((ucs2 & 0xfc00) == 0xD800) {   // start of surrogate pair
+    *highSurrogate = ucs2;
+  }
+  else if (*highSurrogate != 0) {
+    // extract code point from pair
+    unsigned long utf16 = ((unsigned long)(*highSurrogate & 0x03ff)<<10) + (ucs2&0x03ff);
+    *highSurrogate = 0;
+    unsigned char c1 = BITS7654ON, c2 = BIT7ON6OFF, c3 = BIT7ON6OFF, c4 = BIT7ON6OFF;
+    utf16 += 0x10000;
+    for (int k=0; k<22; ++k)  // 22 bits in pack
+    {
+        if (k < 6)    // bits 0-6
+          c4 |= (utf16 % 64) & (1 << k);
+        else if (k < 12) // bits 6-11
+          c3 |= (utf16 >> 6) & (1 << (k - 6));
+        else if (k < 18)  // bits 7-18
+          c2 |= (utf16 >> 12) & (1 << (k - 12));
+        else              // bits 19-22
+          c1 |= (utf16 >> 18) & (1 << (k - 18));
+    }
+    outbuf[0] = c1;
+    outbuf[1] = c2;
+    outbuf[2] = c3;
+    outbuf[3] = c4;
+
+    return 4;
+  }
+  else // if (ucs2 <= 0xffff)  // FFFF(16) = 65535(10)
+  {
+    unsigned char c1 = BITS765ON, c2 = BIT7ON6OFF, c3 = BIT7ON6OFF;
+
+    for (int k=0; k<16; ++k)  // 16 bits in pack
+    {
+        if (k < 6)
+          c3 |= (ucs2 % 64) & (1 << k);
+        else if (k < 12)
+          c2 |= (ucs2 >> 6) & (1 << (k - 6));
+        else
+          c1 |= (ucs2 >> 12) & (1 << (k - 12));
+    }
+    outbuf[0] = c1;
+    outbuf[1] = c2;
+    outbuf[2] = c3;
+
+    return 3;
+  }
+
+  return 0;
+}
+
+template <class Traits>
+int BasicPDU<Traits>::utf8Length(const char *utf8) {
+    int length = 1;
+    unsigned char mask = BITS76ON;
+    // look for ascii 7 on 1st byte
+    if ((*utf8 & BIT7ON6OFF) == 0)
+        ;
+    else {
+        // look for length pattern on first byte - 2 r more continuous 1's
+        while ((*utf8 & mask) == mask && length < 5) {   // 0xF8 and above is never valid
+                length++;
+                mask = (mask>>1 | BIT7ON6OFF);
+        }
+        if (length > 1 && length < 5) { // validate continuation bytes
+            int LEN = length-1;  
+            utf8++;
+            while (LEN) {
+                if ((*utf8++ & BITS76ON) == BIT7ON6OFF)
+                    LEN--;
+                else
+                    break;
+            }
+            if (LEN != 0)
+                length = -1;
+        }
+        else
+            length = -1;    //
+    }
+    return length;
+}
+/*
+    convert an utf8 string to a single ucs2
+    return number of octets
+    Correction: Allow for the creation of surrogate pairs
+    If the input character is in the range 0x10000 to 0x10ffff, convert into a pair of UCS2 words
+*/
+template <class Traits>
+int BasicPDU<Traits>::utf8_to_ucs2_single(const char *utf8, short *target) {
+    unsigned short ucs2[2];
+    int numbytes = 0;
+    int cont = utf8Length(utf8)-1; // number of continuation bytes
+    unsigned long utf16;
+    if (cont < 0)
+        return 0;
+    if (cont == 0) {       // ascii 7 bit
+        ucs2[0] = *utf8;
+        numbytes = 2;
+    }
+    else {
+        // read n bits of first byte then 6 bits of each continuation
+        unsigned char mask = BITS0TO5ON;
+        int temp = cont;
+        while (temp-- > 0)
+            mask >>= 1;
+        utf16 = *utf8++ & mask;
+        // add continuation bytes
+        while (cont-- > 0) {
+            utf16 = (utf16<<6) | (*(utf8++) & BITS0TO5ON);
+        }
+        // check if we need to make a surrogate pair
+        if (utf16 < 0x10000) {
+          ucs2[0] = utf16;
+          numbytes = 2;
+        }
+        else {
+          utf16 -= 0x10000;
+          ucs2[0] = 0xD800 | (utf16>>10);
+          ucs2[1] = 0xDC00 | (utf16 & 0x3ff);
+          numbytes = 4;
+        }
+    }
+    *target = (ucs2[0] >> 8) | ((ucs2[0] & 0x0ff) << 8);   // swap bytes
+    if (numbytes > 2) {
+      target++;
+      *target = (ucs2[1] >> 8) | ((ucs2[1] & 0x0ff) << 8);   // swap bytes
+    }
+    return numbytes;
+}
+
+template <class Traits>
+const char *BasicPDU<Traits>::getSender() {
+  return addressBuff;
+}
+template <class Traits>
+const char *BasicPDU<Traits>::getTimeStamp() {
+  return tsbuff;
+}
+template <class Traits>
+const char *BasicPDU<Traits>::getText() {
+  return mesbuff;
+}
+template <class Traits>
+const unsigned char *BasicPDU<Traits>::getData() {
+  return (const unsigned char *)mesbuff;
+}
+template <class Traits>
+int BasicPDU<Traits>::getDataLength() {
+  return meslength;
+}
+template <class Traits>
+const UDH *BasicPDU<Traits>::getUDH() {
+  return pduType & UDH_EXIST ? &udh : NULL;
+}
+
+
+/*
+    length is the number of digits, returns number of characters written
+*/
+template <class Traits>
+int BasicPDU<Traits>::BCDtoString(char *output, const PDUView *view, int offset, int length, int size) {
+  unsigned char X;
+  int w = 0;
+  for (int i = 0; i < length; i++)
+  {
+    X = getOctet(view, offset + i / 2);
+    X = (i & 1) ? X >> 4 : X & 0xf;
+    if (X == 0xf)  // end filler
+      break;
+    if (w + 1 < size)
+      output[w] = X + 0x30;
+    w++;
+  }
+  if (size > 0)
+    output[w < size ? w : size - 1] = 0;  // add end of string
+  return w;
+}
+
+/*
+    offset is of the digits after the type of address, length is in semi-octets
+    returns length of the readable address
+*/
+template <class Traits>
+int BasicPDU<Traits>::addressToString(const PDUView *view, int offset, int length, unsigned char adt, char *output, int size) {
+  if (length == 0) {
+    if (size > 0)
+      *output = 0;
+    return 0;
+  }
+  switch ((adt & TON_MASK) >> TON_OFFSET) {
+    case 1:  // international number
+      if (size > 1)
+        *output = '+';  // add prefix
+      else if (size == 1)
+        *output = 0;
+      return 1 + BCDtoString(output + 1, view, offset, length, size - 1);
+    case 0:  // unknown, only accepted in a status report
+    case 2:  // national number
+      return BCDtoString(output, view, offset, length, size);
+    case 5: // alphabetic
+      return pdu_to_ascii(view, offset, 0, (length * 4) / 7, output, size);  // length is in semi-octets
+    default:
+      if (size > 0)
+        *output = 0;
+      return 0;
+  }
+}
+
+/*
+    look for concatenation and national language IEs amongst all IEs of the UDH
+    returns number of octets occupied by UDH, including UDHL
+*/
+template <class Traits>
+int BasicPDU<Traits>::decodeUDH(const PDUView *view, int offset, UDH *udh) {
+  int length = getOctet(view, offset);
+  int i = 1;
+  udh->iei = length > 0 ? getOctet(view, offset + 1) : 0;
+  udh->ied.number = 0;
+  udh->ied.total = 0;
+  udh->ied.part = 0;
+  udh->lockingShift = NATIONAL_DEFAULT;
+  udh->singleShift = NATIONAL_DEFAULT;
+  udh->portIei = 0;
+  udh->destinationPort = 0;
+  udh->originatorPort = 0;
+  while (i + 1 <= length) {
+    unsigned char iei = getOctet(view, offset + i);
+    unsigned char iel = getOctet(view, offset + i + 1);
+    int ied = offset + i + 2;
+    if (i + 2 + iel > length + 1)
+      break;   // IE overruns the UDH
+    if (iei == IEI_CSM_8 && iel == 3) {
+      udh->iei = iei;
+      udh->ied.number = getOctet(view, ied);
+      udh->ied.total = getOctet(view, ied + 1);
+      udh->ied.part = getOctet(view, ied + 2);
+    }
+    else if (iei == IEI_CSM_16 && iel == 4) {
+      udh->iei = iei;
+      udh->ied.number = (getOctet(view, ied) << 8) | getOctet(view, ied + 1);
+      udh->ied.total = getOctet(view, ied + 2);
+      udh->ied.part = getOctet(view, ied + 3);
+    }
+    else if (iei == IEI_LOCKING_SHIFT && iel == 1)
+      udh->lockingShift = getOctet(view, ied);
+    else if (iei == IEI_SINGLE_SHIFT && iel == 1)
+      udh->singleShift = getOctet(view, ied);
+    else if (iei == IEI_PORT_8 && iel == 2) {
+      udh->portIei = iei;
+      udh->destinationPort = getOctet(view, ied);
+      udh->originatorPort = getOctet(view, ied + 1);
+    }
+    else if (iei == IEI_PORT_16 && iel == 4) {
+      udh->portIei = iei;
+      udh->destinationPort = (getOctet(view, ied) << 8) | getOctet(view, ied + 1);
+      udh->originatorPort = (getOctet(view, ied + 2) << 8) | getOctet(view, ied + 3);
+    }
+    i += iel + 2;
+  }
+  return length + 1;
+}
+
+template <class Traits>
+int BasicPDU<Traits>::utf8_to_ucs2(const char *utf8, char *ucs2) {  // translate an utf8 zero terminated string
+  int octets=0;
+  while (*utf8) {
+    int inputlen = utf8Length(utf8);
+    int ucslength = utf8_to_ucs2_single(utf8,(short *)ucs2);
+    utf8 += inputlen;   // bump input pointer
+    ucs2 += ucslength;  // bump output pointer
+    octets += ucslength; // bump total number of octets created
+  }
+  return octets;
+}
+
+template <class Traits>
+const char *BasicPDU<Traits>::getSMS(){
+  static_assert(Traits::printable, "no printable PDU is kept");
+  return smsSubmit;
+}
+
+template <class Traits>
+void BasicPDU<Traits>::setSCAnumber(const char *n){
+  strncpy(scanumber, n, Traits::numberLength - 1);
+  scanumber[Traits::numberLength - 1] = 0;
+}
+
+template <class Traits>
+void BasicPDU<Traits>::setNationalLanguages(unsigned languages) {
+  nationalLanguages = languages;
+}
+
+template <class Traits>
+unsigned BasicPDU<Traits>::languages() {
+  return Traits::national ? nationalLanguages : 0;
+}
+
+template <class Traits>
+void BasicPDU<Traits>::setTransliterate(bool on) {
+  transliteration = on;
+}
+
+template <class Traits>
+void BasicPDU<Traits>::setStatusReport(bool on) {
+  statusReport = on;
+}
+
+template <class Traits>
+void BasicPDU<Traits>::setMessageReference(unsigned char reference) {
+  nextReference = reference;
+}
+
+template <class Traits>
+unsigned char BasicPDU<Traits>::getMessageReference() {
+  return lastReference;
+}
+
+template <class Traits>
+const char *BasicPDU<Traits>::getSCAnumber() {
+  return scabuff;  // from INCOMING SMS 
+}
+
+template <class Traits>
+void BasicPDU<Traits>::buildUtf16(unsigned long cp, char *target) {
+  buildUtf(cp,target);    // for backward compatibility
+}
+
+template <class Traits>
+int BasicPDU<Traits>::buildUtf(unsigned long cp, char *target) {
+    unsigned char buf[5];
+    int length;
+    if (cp <= 0x7f)      // ASCII
+    {
+      length = 1;
+      buf[0] = cp;
+      buf[length] = 0;
+    }
+    else if (cp <= 0x7ff) { // Extended latin, greek, hebrew, arabic, cyrillic
+      length = 2;
+      buf[0] = BITS76ON;
+      buf[1] = BIT7ON6OFF;
+      buf[length] = 0;
+      for (int k=0; k<11; ++k) // 11 bits in pack
+      {
+        if (k < 6)
+            buf[1] |= (cp % 64) & (1 << k);
+        else
+            buf[0] |= (cp >> 6) & (1 << (k - 6));
+      }
+    }
+    else if (cp <= 0xffff) {    // many Asian languages
+      length = 3;
+      buf[0] = BITS765ON;
+      buf[1] = BIT7ON6OFF;
+      buf[2] = BIT7ON6OFF;
+      buf[length] = 0;
+      for (int k=0; k<16; ++k)  // 16 bits in pack
+      {
+        if (k < 6)
+          buf[2] |= (cp % 64) & (1 << k);
+        else if (k < 12)
+          buf[1] |= (cp >> 6) & (1 << (k - 6));
+        else
+          buf[0] |= (cp >> 12) & (1 << (k - 12));
+      }
+    }
+    else if (cp >= 0x10000) {     // emojis, drawings, chinese
+      length = 4;
+      buf[0] = BITS7654ON;
+      buf[1] = BIT7ON6OFF;
+      buf[2] = BIT7ON6OFF;
+      buf[3] = BIT7ON6OFF;
+      buf[length] = 0;
+      for (int k=0; k<22; ++k)  // 22 bits in pack
+      {
+          if (k < 6)    // bits 0-6
+            buf[3] |= (cp % 64) & (1 << k);
+          else if (k < 12) // bits 6-11
+            buf[2] |= (cp >> 6) & (1 << (k - 6));
+          else if (k < 18)  // bits 7-18
+            buf[1] |= (cp >> 12) & (1 << (k - 12));
+          else              // bits 19-22
+            buf[0] |= (cp >> 18) & (1 << (k - 18));
+      }
+    }
+   strcpy(target,(char *)buf);
+   return strlen(target);
+}
+
+#endif
@@ -0,0 +1,97 @@
+/**
+ * @file pduframe.cpp
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief The AT+CMGS command and PDU of an SMS as a gather list, written without copying
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * The command is the only part that is formatted, a few digits without
+ * sprintf. The PDU segment points at the encoder's own buffer. Segments are
+ * consumed from the front as they are written, so a partial write is resumed
+ * with the same call.
+ */
+
+#include <string.h>
+#include <pdulib.h>
+#include <pduframe.h>
+#ifdef PDU_FRAME_WRITEV
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+#define CTRL_Z 0x1a
+
+int pduFrameSubmit(PDUFrame *frame, int length, const char *pdu) {
+  size_t pdulength = strlen(pdu);
+  if (length < 1 || length > PDU_BINARY_MAX_LENGTH || pdulength == 0 || pdu[pdulength - 1] != CTRL_Z)
+    return -1;
+  char *c = frame->command;
+  memcpy(c, "AT+CMGS=", 8);
+  c += 8;
+  if (length >= 100)
+    *c++ = '0' + length / 100;
+  if (length >= 10)
+    *c++ = '0' + length / 10 % 10;
+  *c++ = '0' + length % 10;
+  *c++ = '\r';
+  frame->segment[PDU_FRAME_COMMAND].iov_base = frame->command;
+  frame->segment[PDU_FRAME_COMMAND].iov_len = c - frame->command;
+  frame->segment[PDU_FRAME_PDU].iov_base = (void *)pdu;
+  frame->segment[PDU_FRAME_PDU].iov_len = pdulength;
+  frame->first = PDU_FRAME_COMMAND;
+  return pduFrameLength(frame);
+}
+
+size_t pduFrameLength(const PDUFrame *frame, int last) {
+  size_t length = 0;
+  for (int i = frame->first; i <= last && i < PDU_FRAME_SEGMENTS; i++)
+    length += frame->segment[i].iov_len;
+  return length;
+}
+
+size_t pduFrameAdvance(PDUFrame *frame, size_t written) {
+  while (frame->first < PDU_FRAME_SEGMENTS) {
+    PDUFrameSegment *s = &frame->segment[frame->first];
+    if (written < s->iov_len) {
+      s->iov_base = (char *)s->iov_base + written;
+      s->iov_len -= written;
+      break;
+    }
+    written -= s->iov_len;
+    s->iov_len = 0;
+    frame->first++;
+  }
+  return pduFrameLength(frame);
+}
+
+size_t pduFrameCopy(PDUFrame *frame, char *out, size_t size) {
+  size_t copied = 0;
+  for (int i = frame->first; i < PDU_FRAME_SEGMENTS && copied < size; i++) {
+    size_t n = frame->segment[i].iov_len;
+    if (n > size - copied)
+      n = size - copied;
+    memcpy(out + copied, frame->segment[i].iov_base, n);
+    copied += n;
+  }
+  pduFrameAdvance(frame, copied);
+  return copied;
+}
+
+#ifdef PDU_FRAME_WRITEV
+int pduFrameWrite(int fd, PDUFrame *frame, int last) {
+  while (frame->first <= last && frame->first < PDU_FRAME_SEGMENTS) {
+    ssize_t n = writev(fd, &frame->segment[frame->first], last + 1 - frame->first);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        break;
+      return -1;
+    }
+    pduFrameAdvance(frame, n);
+  }
+  return pduFrameLength(frame, last);
+}
+#endif
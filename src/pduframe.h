@@ -0,0 +1,93 @@
+/**
+ * @file pduframe.h
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief The AT+CMGS command and PDU of an SMS as a gather list, written without copying
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ * @
+ */
+
+#ifdef PDU_FRAME_INCLUDE
+#else
+#define PDU_FRAME_INCLUDE
+
+#include <stddef.h>
+
+// writev is only built where there is one
+#if !defined(ARDUINO) && (defined(__unix__) || defined(__APPLE__))
+#define PDU_FRAME_WRITEV
+#include <sys/uio.h>
+typedef struct iovec PDUFrameSegment;
+#else
+struct PDUFrameSegment {      // the same fields as struct iovec
+  void *iov_base;
+  size_t iov_len;
+};
+#endif
+
+#define PDU_FRAME_COMMAND 0     // segment of AT+CMGS=<length> and CR
+#define PDU_FRAME_PDU 1         // segment of the printable PDU and CTRL/Z
+#define PDU_FRAME_SEGMENTS 2
+#define PDU_FRAME_COMMAND_LENGTH 12   // AT+CMGS= 3 digits CR
+
+/**
+ * @brief An SMS ready to send to the modem, filled in by <b>pduFrameSubmit</b>.
+ * The PDU is not copied and must remain valid until the frame is written.
+ * The command segment points into the frame, so a frame must not be copied once made.
+ */
+struct PDUFrame {
+  PDUFrameSegment segment[PDU_FRAME_SEGMENTS];
+  int first;      // first segment with anything left to write, PDU_FRAME_SEGMENTS when all written
+  char command[PDU_FRAME_COMMAND_LENGTH];   // no end marker
+};
+
+/**
+ * @brief Make the frame of an encoded SMS-SUBMIT: AT+CMGS=<length> and CR, then the PDU.
+ * The modem prompts with "> " between the two, see <b>pduFrameWrite</b>.
+ *
+ * @param frame Receives the segments
+ * @param length Returned by the encoder, e.g. <b>encodePDU</b> or <b>encodeNextPart</b>
+ * @param pdu The printable PDU ending in CTRL/Z, from <b>getSMS</b> or an encoder's output buffer
+ * @return int The number of octets in the frame, -1 if length is invalid or the PDU does not end in CTRL/Z
+ */
+int pduFrameSubmit(PDUFrame *frame, int length, const char *pdu);
+/**
+ * @brief Number of octets still to write, up to and including a segment
+ *
+ * @param last PDU_FRAME_COMMAND or PDU_FRAME_PDU
+ */
+size_t pduFrameLength(const PDUFrame *frame, int last = PDU_FRAME_PDU);
+/**
+ * @brief Drop octets that have been written, e.g. after a partial write to a serial port
+ *
+ * @param written Number of octets, at most <b>pduFrameLength</b>
+ * @return size_t Number of octets still to write
+ */
+size_t pduFrameAdvance(PDUFrame *frame, size_t written);
+/**
+ * @brief Copy the rest of a frame, or as much as fits, e.g. into the free part of a serial output ring.
+ * The frame is advanced past what was copied, so a ring that wraps takes 2 calls.
+ *
+ * @param out Receives the octets, no end marker is added
+ * @param size Room in out
+ * @return size_t Number of octets copied
+ */
+size_t pduFrameCopy(PDUFrame *frame, char *out, size_t size);
+
+#ifdef PDU_FRAME_WRITEV
+/**
+ * @brief Write a frame with writev, a single system call unless the port takes it in pieces.
+ * Write up to PDU_FRAME_COMMAND, wait for the prompt, then write up to PDU_FRAME_PDU.
+ * A modem that accepts the PDU before its prompt can be sent the whole frame at once.
+ * A blocking fd is written until done, a non blocking one until it would block.
+ *
+ * @param fd Serial port
+ * @param last Last segment to write, PDU_FRAME_COMMAND or PDU_FRAME_PDU
+ * @return int Number of octets still to write up to last, 0 when done, -1 if the write failed
+ */
+int pduFrameWrite(int fd, PDUFrame *frame, int last = PDU_FRAME_PDU);
+#endif
+
+#endif
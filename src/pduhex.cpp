@@ -0,0 +1,295 @@
+/**
+ * @file pduhex.cpp
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief Bulk conversion of PDUs between printable hex and binary
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * The SIMD kernels convert a block of characters to nibbles, check that every
+ * character was a hex digit and then join the nibble pairs into octets.
+ * Whatever is left over at the end is handled by the scalar code.
+ * Validation alone is the same check with nothing joined or stored.
+ * In the other direction blocks are converted from the end backwards, as the
+ * output of a block never reaches an octet not yet read this works in place.
+ * The kernel is chosen at run time according to the CPU.
+ */
+
+#include <pduhex.h>
+#ifdef PDU_HEX_SIMD
+#include <immintrin.h>
+#endif
+
+// returns value of 1 hex digit, -1 if not a hex digit
+static inline int hexNibble(unsigned char c) {
+  if ((unsigned char)(c - '0') < 10)
+    return c - '0';
+  c |= 0x20;    // lower case
+  if ((unsigned char)(c - 'a') < 6)
+    return c - 'a' + 10;
+  return -1;
+}
+
+static int hexToBinaryScalar(const char *hex, int length, unsigned char *out) {
+  for (int i = 0; i < length; i += 2) {
+    int hi = hexNibble(hex[i]);
+    int lo = hexNibble(hex[i + 1]);
+    if ((hi | lo) < 0)
+      return -1;
+    *out++ = (hi << 4) | lo;
+  }
+  return length / 2;
+}
+
+static int hexValidateScalar(const char *hex, int length) {
+  int invalid = 0;
+  for (int i = 0; i < length; i++)
+    invalid |= hexNibble(hex[i]);
+  return invalid < 0 ? -1 : length / 2;
+}
+
+static const char hexDigits[] = "0123456789ABCDEF";
+
+// from the last octet backwards so it can be done in place
+static void binaryToHexScalar(const unsigned char *in, int length, char *out) {
+  for (int i = length - 1; i >= 0; i--) {
+    unsigned char b = in[i];
+    out[i * 2 + 1] = hexDigits[b & 0xf];
+    out[i * 2] = hexDigits[b >> 4];
+  }
+}
+
+#ifdef PDU_HEX_SIMD
+/*
+    16 characters to 16 nibbles, invalid is set to all ones in any lane that was not a hex digit
+*/
+__attribute__((target("sse2")))
+static inline __m128i nibblesSSE2(__m128i v, __m128i *invalid) {
+  const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+  const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                      _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+  const __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                      _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+  *invalid = _mm_or_si128(*invalid, _mm_andnot_si128(_mm_or_si128(digit, alpha), _mm_set1_epi8(-1)));
+  const __m128i dval = _mm_and_si128(digit, _mm_sub_epi8(v, _mm_set1_epi8('0')));
+  const __m128i aval = _mm_and_si128(alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10)));
+  return _mm_or_si128(dval, aval);
+}
+
+__attribute__((target("sse2")))
+static int hexToBinarySSE2(const char *hex, int length, unsigned char *out) {
+  __m128i invalid = _mm_setzero_si128();
+  int i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m128i n0 = nibblesSSE2(_mm_loadu_si128((const __m128i *)&hex[i]), &invalid);
+    __m128i n1 = nibblesSSE2(_mm_loadu_si128((const __m128i *)&hex[i + 16]), &invalid);
+    // each 16 bit lane holds high nibble in the low byte, low nibble in the high byte
+    n0 = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(n0, _mm_set1_epi16(0x00ff)), 4), _mm_srli_epi16(n0, 8));
+    n1 = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(n1, _mm_set1_epi16(0x00ff)), 4), _mm_srli_epi16(n1, 8));
+    _mm_storeu_si128((__m128i *)&out[i / 2], _mm_packus_epi16(n0, n1));
+  }
+  if (_mm_movemask_epi8(invalid) != 0)
+    return -1;
+  if (hexToBinaryScalar(&hex[i], length - i, &out[i / 2]) < 0)
+    return -1;
+  return length / 2;
+}
+
+__attribute__((target("sse2")))
+static int hexValidateSSE2(const char *hex, int length) {
+  __m128i invalid = _mm_setzero_si128();
+  int i = 0;
+  for (; i + 16 <= length; i += 16)
+    nibblesSSE2(_mm_loadu_si128((const __m128i *)&hex[i]), &invalid);
+  if (_mm_movemask_epi8(invalid) != 0)
+    return -1;
+  if (hexValidateScalar(&hex[i], length - i) < 0)
+    return -1;
+  return length / 2;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i nibblesAVX2(__m256i v, __m256i *invalid) {
+  const __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+  const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+  const __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+  *invalid = _mm256_or_si256(*invalid, _mm256_andnot_si256(_mm256_or_si256(digit, alpha), _mm256_set1_epi8(-1)));
+  const __m256i dval = _mm256_and_si256(digit, _mm256_sub_epi8(v, _mm256_set1_epi8('0')));
+  const __m256i aval = _mm256_and_si256(alpha, _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10)));
+  return _mm256_or_si256(dval, aval);
+}
+
+__attribute__((target("avx2")))
+static int hexToBinaryAVX2(const char *hex, int length, unsigned char *out) {
+  __m256i invalid = _mm256_setzero_si256();
+  // high nibble weighs 16, low nibble 1
+  const __m256i weights = _mm256_set1_epi16(0x0110);
+  int i = 0;
+  for (; i + 64 <= length; i += 64) {
+    __m256i n0 = nibblesAVX2(_mm256_loadu_si256((const __m256i *)&hex[i]), &invalid);
+    __m256i n1 = nibblesAVX2(_mm256_loadu_si256((const __m256i *)&hex[i + 32]), &invalid);
+    n0 = _mm256_maddubs_epi16(n0, weights);
+    n1 = _mm256_maddubs_epi16(n1, weights);
+    // pack works within 128 bit lanes, put the quarters back in order
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(n0, n1), 0xd8);
+    _mm256_storeu_si256((__m256i *)&out[i / 2], packed);
+  }
+  if (!_mm256_testz_si256(invalid, invalid))
+    return -1;
+  // finish with the SSE2 kernel, which handles its own remainder
+  _mm256_zeroupper();   // else every SSE instruction after this pays for the dirty upper halves
+  if (hexToBinarySSE2(&hex[i], length - i, &out[i / 2]) < 0)
+    return -1;
+  return length / 2;
+}
+
+__attribute__((target("avx2")))
+static int hexValidateAVX2(const char *hex, int length) {
+  __m256i invalid = _mm256_setzero_si256();
+  int i = 0;
+  for (; i + 32 <= length; i += 32)
+    nibblesAVX2(_mm256_loadu_si256((const __m256i *)&hex[i]), &invalid);
+  bool ok = _mm256_testz_si256(invalid, invalid);
+  _mm256_zeroupper();
+  if (!ok || hexValidateSSE2(&hex[i], length - i) < 0)
+    return -1;
+  return length / 2;
+}
+
+// 16 nibbles to 16 characters
+__attribute__((target("sse2")))
+static inline __m128i digitsSSE2(__m128i n) {
+  const __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(n, _mm_set1_epi8(9)), _mm_set1_epi8('A' - '9' - 1));
+  return _mm_add_epi8(_mm_add_epi8(n, _mm_set1_epi8('0')), letter);
+}
+
+__attribute__((target("sse2")))
+static void binaryToHexSSE2(const unsigned char *in, int length, char *out) {
+  const __m128i mask = _mm_set1_epi8(0x0f);
+  int i = length;
+  for (; i >= 16; i -= 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)&in[i - 16]);
+    __m128i hi = digitsSSE2(_mm_and_si128(_mm_srli_epi16(v, 4), mask));
+    __m128i lo = digitsSSE2(_mm_and_si128(v, mask));
+    _mm_storeu_si128((__m128i *)&out[(i - 16) * 2 + 16], _mm_unpackhi_epi8(hi, lo));
+    _mm_storeu_si128((__m128i *)&out[(i - 16) * 2], _mm_unpacklo_epi8(hi, lo));
+  }
+  binaryToHexScalar(in, i, out);
+}
+
+__attribute__((target("avx2")))
+static void binaryToHexAVX2(const unsigned char *in, int length, char *out) {
+  const __m256i mask = _mm256_set1_epi8(0x0f);
+  const __m256i digits = _mm256_setr_epi8('0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F',
+                                          '0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F');
+  int i = length;
+  for (; i >= 32; i -= 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)&in[i - 32]);
+    __m256i hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+    __m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(v, mask));
+    // unpack works within 128 bit lanes, put the halves back in order
+    __m256i a = _mm256_unpacklo_epi8(hi, lo);
+    __m256i b = _mm256_unpackhi_epi8(hi, lo);
+    _mm256_storeu_si256((__m256i *)&out[(i - 32) * 2 + 32], _mm256_permute2x128_si256(a, b, 0x31));
+    _mm256_storeu_si256((__m256i *)&out[(i - 32) * 2], _mm256_permute2x128_si256(a, b, 0x20));
+  }
+  _mm256_zeroupper();
+  binaryToHexSSE2(in, i, out);
+}
+
+static eHexKernel bestKernel() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return HEX_KERNEL_AVX2;
+  if (__builtin_cpu_supports("sse2"))
+    return HEX_KERNEL_SSE2;
+  return HEX_KERNEL_SCALAR;
+}
+
+// decided once at load time and never changed
+static const eHexKernel autoKernel = bestKernel();
+#endif
+
+bool pduHexKernelSupported(eHexKernel kernel) {
+#ifdef PDU_HEX_SIMD
+  switch (kernel) {
+    case HEX_KERNEL_AVX2:
+      return autoKernel == HEX_KERNEL_AVX2;
+    case HEX_KERNEL_SSE2:
+      return autoKernel != HEX_KERNEL_SCALAR;
+    default:
+      return true;
+  }
+#else
+  return kernel == HEX_KERNEL_AUTO || kernel == HEX_KERNEL_SCALAR;
+#endif
+}
+
+void pduBinaryToHex(const unsigned char *in, int length, char *out, eHexKernel kernel) {
+#ifdef PDU_HEX_SIMD
+  if (kernel == HEX_KERNEL_AUTO)
+    kernel = autoKernel;
+  else if (!pduHexKernelSupported(kernel))
+    kernel = HEX_KERNEL_SCALAR;
+  switch (kernel) {
+    case HEX_KERNEL_AVX2:
+      binaryToHexAVX2(in, length, out);
+      return;
+    case HEX_KERNEL_SSE2:
+      binaryToHexSSE2(in, length, out);
+      return;
+    default:
+      break;
+  }
+#else
+  (void)kernel;
+#endif
+  binaryToHexScalar(in, length, out);
+}
+
+int pduHexToBinary(const char *hex, int length, unsigned char *out, eHexKernel kernel) {
+  if (length < 0 || (length & 1) != 0)
+    return -1;
+#ifdef PDU_HEX_SIMD
+  if (kernel == HEX_KERNEL_AUTO)
+    kernel = autoKernel;
+  else if (!pduHexKernelSupported(kernel))
+    kernel = HEX_KERNEL_SCALAR;
+  switch (kernel) {
+    case HEX_KERNEL_AVX2:
+      return hexToBinaryAVX2(hex, length, out);
+    case HEX_KERNEL_SSE2:
+      return hexToBinarySSE2(hex, length, out);
+    default:
+      break;
+  }
+#else
+  (void)kernel;
+#endif
+  return hexToBinaryScalar(hex, length, out);
+}
+
+int pduHexValidate(const char *hex, int length, eHexKernel kernel) {
+  if (length < 0 || (length & 1) != 0)
+    return -1;
+#ifdef PDU_HEX_SIMD
+  if (kernel == HEX_KERNEL_AUTO)
+    kernel = autoKernel;
+  else if (!pduHexKernelSupported(kernel))
+    kernel = HEX_KERNEL_SCALAR;
+  switch (kernel) {
+    case HEX_KERNEL_AVX2:
+      return hexValidateAVX2(hex, length);
+    case HEX_KERNEL_SSE2:
+      return hexValidateSSE2(hex, length);
+    default:
+      break;
+  }
+#else
+  (void)kernel;
+#endif
+  return hexValidateScalar(hex, length);
+}
@@ -0,0 +1,63 @@
+/**
+ * @file pduhex.h
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief Bulk conversion of PDUs between printable hex and binary
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ * @
+ */
+
+#ifdef PDU_HEX_INCLUDE
+#else
+#define PDU_HEX_INCLUDE
+
+// SIMD kernels are only built for x86 with gcc/clang, all others use the scalar code
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PDU_HEX_SIMD
+#endif
+
+enum eHexKernel {
+  HEX_KERNEL_AUTO,      // best supported by this CPU
+  HEX_KERNEL_SCALAR,
+  HEX_KERNEL_SSE2,      // 16 octets at a time
+  HEX_KERNEL_AVX2       // 32 octets at a time
+};
+
+/**
+ * @brief Convert printable hex to binary in a single validating pass.
+ * Upper and lower case digits are accepted.
+ *
+ * @param hex The printable hex, need not be zero terminated
+ * @param length Number of characters to convert, must be even
+ * @param out Receives length/2 octets
+ * @param kernel Force a kernel, for benchmarks. An unsupported kernel falls back to the scalar code
+ * @return int The number of octets, -1 if length is odd or a character is not a hex digit
+ */
+int pduHexToBinary(const char *hex, int length, unsigned char *out, eHexKernel kernel = HEX_KERNEL_AUTO);
+/**
+ * @brief Check that printable hex is valid without converting it, as <b>pduHexToBinary</b> would.
+ *
+ * @param hex The printable hex, need not be zero terminated
+ * @param length Number of characters to check, must be even
+ * @param kernel Force a kernel, for benchmarks. An unsupported kernel falls back to the scalar code
+ * @return int The number of octets it holds, -1 if length is odd or a character is not a hex digit
+ */
+int pduHexValidate(const char *hex, int length, eHexKernel kernel = HEX_KERNEL_AUTO);
+/**
+ * @brief Convert binary to printable upper case hex in a single pass.
+ * No end marker is added.
+ *
+ * @param in The octets to convert
+ * @param length Number of octets
+ * @param out Receives 2*length characters. May be the same as in, to convert in place
+ * @param kernel Force a kernel, for benchmarks. An unsupported kernel falls back to the scalar code
+ */
+void pduBinaryToHex(const unsigned char *in, int length, char *out, eHexKernel kernel = HEX_KERNEL_AUTO);
+/**
+ * @brief Check if the CPU supports a kernel
+ */
+bool pduHexKernelSupported(eHexKernel kernel);
+
+#endif
@@ -12,9 +12,23 @@
 
 #ifdef PDU_LIB_INCLUDE
 #else
-//#define PM
-
 #define PDU_LIB_INCLUDE
+
+// build flags, set here so that no source file has to be edited
+#if defined(ARDUINO) && !defined(ARDUINO_BASE)
+#define ARDUINO_BASE    // Arduino IDE or PlatformIO
+#endif
+// tables in flash, where const data would otherwise be copied to RAM. Define PM for other boards
+#if defined(ARDUINO_ARCH_AVR) && !defined(PM) && !defined(PDU_TABLES_IN_RAM)
+#define PM
+#endif
+#ifdef PM
+#include <avr/pgmspace.h>
+#endif
+
+#include <stddef.h>
+#include <pdunational.h>
+#include <pdutranslit.h>
 #define BITMASK_7BITS 0x7F
 
 // DCS bit masks
@@ -39,6 +53,13 @@
 #define PDU_VALIDITY_PRESENT_ABSOLUTE 3
 #define PSU_SMS_DELIVER 0
 #define PSU_SMS_SUBMIT  1
+#define PSU_SMS_STATUS_REPORT 2
+#define PDU_TYPE_MASK 3             // TP-MTI
+#define PDU_STATUS_REPORT_REQUEST 0x20  // TP-SRR in an SMS-SUBMIT
+
+// TP-ST ranges, 3GPP TS 23.040 9.2.3.15
+#define TP_ST_COMPLETED_LAST 0x1F   // 0x00 delivered, 0x01 forwarded, 0x02 replaced
+#define TP_ST_TRYING_LAST 0x3F      // temporary error, SC still trying
 
 // type of address
 #define INTERNATIONAL_NUMBER 0x91
@@ -50,6 +71,17 @@
 // IEI
 #define IEI_CSM_8 0x00
 #define IEI_CSM_16 0x08
+#define IEI_SINGLE_SHIFT 0x24     // national language single shift table
+#define IEI_LOCKING_SHIFT 0x25    // national language locking shift table
+#define IEI_PORT_8 0x04           // application port addressing, 8 bit ports
+#define IEI_PORT_16 0x05          // application port addressing, 16 bit ports
+// UDH length including the UDHL octet itself
+#define UDH_CSM_8_LENGTH 6    // UDHL + IEI + IEL + ref + total + part
+#define UDH_CSM_16_LENGTH 7   // as above with a 2 octet reference
+#define UDH_SHIFT_LENGTH 3    // IEI + IEL + language, added for each shift table
+#define UDH_PORT_8_LENGTH 5   // UDHL + IEI + IEL + destination + originator
+#define UDH_PORT_16_LENGTH 7  // as above with 2 octet ports
+#define NO_PORT -1            // send 8 bit data without application port addressing
 
 #define EXT_MASK 0x80   // bit 7
 #define TON_MASK 0x70   // bits 4-6
@@ -57,10 +89,19 @@
 #define NPI_MASK 0x0f   // bits 0-3
 
 #define MAX_SMS_LENGTH_7BIT 160 // GSM 3.4
-#define MAX_NUMBER_LENGTH 20    // gets packed into BCD or packed 7 bit
+#define MAX_SMS_LENGTH_16BIT 70 // UCS-2 units
+#define MAX_SMS_OCTETS 140      // user data incl. UDH
+#define MAX_SMS_PARTS 255       // IED total is a single octet
+#define MAX_TEXT_LENGTH (MAX_SMS_LENGTH_7BIT*3+1)  // UTF-8 of a decoded message + end marker, a national locking shift septet may be 3 bytes e.g. €
+#ifndef MAX_NUMBER_LENGTH
+#define MAX_NUMBER_LENGTH 20    // gets packed into BCD or packed 7 bit, may be overridden from the compiler command line
+#endif
+#define TIMESTAMP_LENGTH 15     // YYMMDDHHMMSSZZ + end marker
 
 //SCA (12) + type + mref + address(12) + pid + dcs + length + data(140) -- no valtime
 #define PDU_BINARY_MAX_LENGTH 170
+//SCA (12) + type + address(12) + pid + dcs + scts(7) + length + data(140)
+#define PDU_DELIVER_MAX_LENGTH 175
 
  /* Define Non-Printable Characters as a question mark */
 #define NPC7    63
@@ -81,18 +122,171 @@ struct IED {
 struct UDH {
   unsigned char iei;
   IED ied;
+  unsigned char lockingShift;   // eNationalLanguage of the GSM 7 bit tables, NATIONAL_DEFAULT if no IE
+  unsigned char singleShift;
+  unsigned char portIei;        // IEI_PORT_8 or IEI_PORT_16, 0 if no application port IE
+  unsigned short destinationPort;
+  unsigned short originatorPort;
+};
+
+/**
+ * @brief The fields of a decoded PDU, located by offset into the caller's PDU.
+ * Filled in by <b>decodeView</b> or <b>decodeViewBinary</b>, nothing is copied.
+ * Offsets are in octets, in a printable PDU each octet is 2 characters.
+ */
+struct PDUView {
+  const char *pdu;              // the PDU all offsets refer to, must remain valid
+  bool binary;                  // pdu is binary octets, not printable hex
+  unsigned short length;        // of pdu, in octets
+  unsigned short scaOffset;     // SCA digits, after type of address
+  unsigned char scaLength;      // in semi-octets
+  unsigned char scaType;        // type of address
+  unsigned short senderOffset;  // sender digits, after type of address
+  unsigned char senderLength;   // in semi-octets
+  unsigned char senderType;     // type of address
+  unsigned char pduType;
+  unsigned char pid;
+  unsigned char dcs;
+  unsigned short tsOffset;      // SCTS, 7 octets
+  unsigned short udOffset;      // user data, including any UDH
+  unsigned char udl;            // user data length, in septets or octets depending on dcs
+  unsigned char udhLength;      // in octets, including UDHL. 0 if there is no UDH
+  UDH udh;                      // concatenation details, valid if udhLength is not 0
+};
+
+enum eBatchStatus {
+  BATCH_OK,
+  BATCH_INVALID,      // not a valid SMS-DELIVER, strings are empty, other columns not filled in
+  BATCH_ALPHABET,     // alphabet not supported, no text
+  BATCH_ARENA_FULL    // no room for the text in the arena, no text
+};
+
+/**
+ * @brief Columns filled in by <b>decodeBatch</b>, entry i for PDU i.
+ * All arrays belong to the caller and must have an entry for every PDU.
+ * A column left NULL is not filled in and the work for it is skipped.
+ * The texts are placed back to back in a single arena, each with an end marker.
+ * 8 bit data is placed in the arena as is, textLength gives its length.
+ */
+struct PDUBatch {
+  unsigned char *status;                // eBatchStatus
+  char (*sca)[MAX_NUMBER_LENGTH];
+  char (*sender)[MAX_NUMBER_LENGTH];
+  char (*timeStamp)[TIMESTAMP_LENGTH];
+  unsigned char *dcs;
+  unsigned char *udhIei;                // as UDH.iei
+  unsigned short *udhNumber;            // concatenation reference
+  unsigned char *udhTotal;              // 0 if not concatenated
+  unsigned char *udhPart;
+  size_t *textOffset;                   // into arena
+  unsigned short *textLength;           // in octets, without end marker
+  char *arena;
+  size_t arenaSize;
+  size_t arenaUsed;                     // set to 0 for a new arena, advanced by each text
+};
+
+/**
+ * @brief An SMS-STATUS-REPORT, filled in by <b>decodeStatusReport</b>
+ */
+struct PDUStatusReport {
+  unsigned char reference;              // TP-MR of the SMS-SUBMIT it reports on
+  char recipient[MAX_NUMBER_LENGTH];    // as the SMS-SUBMIT was addressed
+  char timeStamp[TIMESTAMP_LENGTH];     // SCTS, when the SC received the SMS-SUBMIT
+  char dischargeTime[TIMESTAMP_LENGTH]; // when it was delivered, or the last attempt
+  unsigned char status;                 // TP-ST, see pduDeliveryState
+};
+
+enum eDeliveryState {
+  DELIVERY_COMPLETE,    // delivered, no more reports will follow
+  DELIVERY_PENDING,     // temporary error, the SC is still trying
+  DELIVERY_FAILED       // not delivered and the SC has given up
+};
+
+/**
+ * @brief Classify the TP-ST of a status report
+ */
+eDeliveryState pduDeliveryState(unsigned char status);
+/**
+ * @brief Convert a timestamp from <b>getTimeStamp</b>, <b>viewTimeStamp</b> or a status report
+ * to seconds since 1970 UTC. The SC gives its local time, the time zone is subtracted.
+ * Years 00 to 99 are 2000 to 2099.
+ *
+ * @param timeStamp YYMMDDHHMMSSZZ, each octet's semi octets in the order sent
+ * @param zone Receives the time zone in quarters of an hour east of UTC, negative for west, may be NULL
+ * @return long long The time, -1 if it is not a valid timestamp
+ */
+long long pduTimeStampToEpoch(const char *timeStamp, int *zone = NULL);
+
+/**
+ * @brief What it costs to send a text, filled in by <b>pduClassify</b>
+ */
+struct PDUTextInfo {
+  eDCS alphabet;        // ALPHABET_7BIT if every character is in the GSM 7 bit alphabet, else ALPHABET_16BIT
+  int septets;          // GSM 7 bit length, an escaped character counts 2. 0 if the alphabet is 16 bit
+  int units;            // UCS-2 length, a surrogate pair counts 2
+  int segments;         // SMS needed in that alphabet, concatenated parts with an 8 bit reference
+  int invalid;          // bytes that are not valid UTF-8, skipped when encoding
+  unsigned char lockingShift;   // eNationalLanguage of the tables chosen for GSM 7 bit
+  unsigned char singleShift;
+  int transliterated;   // characters replaced by a close match, 0 unless transliteration was allowed
 };
 
 /**
- * @brief PDU class, provides methods to decode a PDU message or encode a new one
- * @param None There are no parameters for the constructor
+ * @brief Work out the alphabet, length and number of SMS for a text in a single pass,
+ * exactly as <b>encodePDU</b> and <b>beginMultipart</b> would send it.
+ * Runs of plain ASCII are counted with SIMD code where the CPU has it.
+ * Only if the default GSM 7 bit alphabet cannot carry the text, or needs several SMS
+ * because of escaped characters such as €, is a second pass made to try the national
+ * language tables. They are chosen if they need fewer SMS than UCS-2 or the default alphabet.
+ * If they cannot either and transliterate is set, a last pass replaces the characters
+ * missing from the default alphabet by close matches, see <b>pduTransliterate</b>.
+ * That is chosen if every such character has one.
+ *
+ * @param text The text in UTF-8 format
+ * @param length Number of bytes, -1 if the text is zero terminated
+ * @param info Receives the results
+ * @param languages NATIONAL_MASK of each national language that may be used
+ * @param transliterate Close matches may be used to stay in GSM 7 bit
+ * @return int The number of segments, as info->segments
+ */
+int pduClassify(const char *text, int length, PDUTextInfo *info, unsigned languages = NATIONAL_ALL, bool transliterate = false);
+/**
+ * @brief Look up a Unicode codepoint in the GSM 7 bit alphabet, exact matches only
+ *
+ * @return int The septet, 256 + septet for a character of the extension table (sent after ESC), -1 if not in the alphabet
+ */
+int pduGsm7Septet(unsigned long cp);
+
+/**
+ * @brief Compile time configuration of a <b>BasicPDU</b>, these are the defaults used by <b>PDU</b>.
+ * To change some, derive from PDUTraits and declare those again, e.g.
+ *   struct SmallTraits : PDUTraits { static const bool ucs2 = false; static const int textLength = 161; };
+ *   BasicPDU<SmallTraits> pdu;
+ * A message in an alphabet that is left out cannot be encoded (-1) or decoded (false, -1 or BATCH_ALPHABET).
+ * The storage of the tables is chosen for the whole build, see PM, as they are shared by every codec.
+ */
+struct PDUTraits {
+  static const int numberLength = MAX_NUMBER_LENGTH;  // SCA, sender and recipient buffers, including end marker
+  static const int textLength = MAX_TEXT_LENGTH;      // getText and getData buffer, a longer text is truncated
+  static const bool printable = true;     // keep the printable PDU for getSMS, else the encode buffer is half the size
+                                          // and only the binary encoders and those with an output buffer may be used
+  static const bool ucs2 = true;          // UCS-2 text
+  static const bool data8 = true;         // 8 bit data
+  static const bool national = true;      // national language shift tables, else setNationalLanguages has no effect
+  static const bool transliteration = true;   // else setTransliterate has no effect
+};
+
+/**
+ * @brief PDU codec, provides methods to decode a PDU message or encode a new one
+ * @param Traits Capacities and features, fixed at compile time, see <b>PDUTraits</b>
  * 
  */
-class PDU
+template <class Traits>
+class BasicPDU
 {
 public:
-  PDU();
-  ~PDU();
+  BasicPDU();
+  ~BasicPDU();
 /**
  * @brief Encode a PDU block for sending to an GSM modem
  * 
@@ -101,6 +295,104 @@ public:
  * @return int The length of the message, need for the GSM command <b>AT+CSMG=nn</b>
  */
   int encodePDU(const char *recipient,const char *message);
+/**
+ * @brief As <b>encodePDU</b> but write the printable PDU, CTRL/Z and end marker straight into a caller's buffer.
+ * <b>getSMS</b> is not valid afterwards.
+ * If out is too small nothing is written and the message reference is not used up,
+ * the same applies to all the encode methods with an output buffer.
+ * 
+ * @param out Receives the PDU
+ * @param size Size of out, PDU_BINARY_MAX_LENGTH*2 is always enough
+ * @return int The length of the message, -1 if invalid, minus the size needed if out is too small
+ */
+  int encodePDU(const char *recipient,const char *message,char *out,size_t size);
+/**
+ * @brief As <b>encodePDU</b> but leave the result in binary, retrieved with <b>getBinary</b>.
+ * 
+ * @return int The length of the binary TPDU, -1 if invalid
+ */
+  int encodeBinary(const char *recipient,const char *message);
+/**
+ * @brief As <b>encodeBinary</b> but copy the TPDU into a caller's buffer.
+ * 
+ * @param out Receives the TPDU, without SCA
+ * @param size Size of out, PDU_BINARY_MAX_LENGTH is always enough
+ * @return int The length of the TPDU, -1 if invalid, minus the size needed if out is too small
+ */
+  int encodeBinary(const char *recipient,const char *message,unsigned char *out,size_t size);
+  /**
+   * @brief Get the binary TPDU created by <b>encodeBinary</b> or <b>encodeNextPartBinary</b>.
+   * The SCA is not included. The length is the value returned by the encode method.
+   * Not valid after <b>encodePDU</b> or <b>encodeNextPart</b>, which convert the buffer to printable.
+   * 
+   * @return const unsigned char* The pointer to the TPDU.
+   */
+  const unsigned char *getBinary();
+/**
+ * @brief Prepare a message of any length for sending as a concatenated SMS.
+ * The text is split so that each part is filled to the last septet/octet, an escape
+ * sequence or surrogate pair is never split. A message that fits in a single SMS
+ * is sent without a UDH.
+ * 
+ * @param recipient Phone number, same format as for <b>encodePDU</b>
+ * @param message The message in UTF-8 format. Must remain valid until the last part is encoded
+ * @param reference Concatenation reference, the same for all parts. Values above 255 use a 16 bit IEI
+ * @return int The number of parts, -1 if the message needs more than 255 parts or the recipient is longer than the traits allow
+ */
+  int beginMultipart(const char *recipient,const char *message,unsigned short reference);
+/**
+ * @brief Encode the next part of a message prepared by <b>beginMultipart</b>.
+ * The result is retrieved with <b>getSMS</b> as for <b>encodePDU</b>.
+ * 
+ * @return int The length of the part, need for the GSM command <b>AT+CSMG=nn</b>, -1 when there are no more parts
+ */
+  int encodeNextPart();
+/**
+ * @brief As <b>encodeNextPart</b> but write the result into a caller's buffer,
+ * see <b>encodePDU</b> with an output buffer. If out is too small the same part
+ * is encoded by the next call.
+ */
+  int encodeNextPart(char *out,size_t size);
+/**
+ * @brief As <b>encodeNextPart</b> but leave the result in binary, retrieved with <b>getBinary</b>.
+ */
+  int encodeNextPartBinary();
+/**
+ * @brief As <b>encodeNextPartBinary</b> but copy the TPDU into a caller's buffer,
+ * see <b>encodeBinary</b> with an output buffer.
+ */
+  int encodeNextPartBinary(unsigned char *out,size_t size);
+/**
+ * @brief Encode 8 bit data, e.g. a binary telemetry frame, as a single SMS. The octets are
+ * sent as they are, with no text conversion. The result is retrieved with <b>getSMS</b>
+ * as for <b>encodePDU</b>.
+ * With a destination port the UDH has an application port addressing IE, 8 bit if
+ * both ports are below 256 (5 octets of UDH) else 16 bit (7 octets).
+ * 
+ * @param recipient Phone number, same format as for <b>encodePDU</b>
+ * @param data The octets to send
+ * @param length Number of octets, at most MAX_SMS_OCTETS less the UDH
+ * @param destinationPort 0 to 65535, NO_PORT for no application port addressing
+ * @param originatorPort 0 to 65535, ignored without a destination port
+ * @return int The length of the message, need for the GSM command <b>AT+CSMG=nn</b>, -1 if invalid or too long
+ */
+  int encodeData(const char *recipient,const unsigned char *data,int length,long destinationPort = NO_PORT,long originatorPort = 0);
+/**
+ * @brief As <b>encodeData</b> but leave the result in binary, retrieved with <b>getBinary</b>.
+ * 
+ * @return int The length of the binary TPDU, -1 if invalid or too long
+ */
+  int encodeDataBinary(const char *recipient,const unsigned char *data,int length,long destinationPort = NO_PORT,long originatorPort = 0);
+/**
+ * @brief As <b>encodeData</b> but write the result into a caller's buffer,
+ * see <b>encodePDU</b> with an output buffer.
+ */
+  int encodeData(const char *recipient,const unsigned char *data,int length,long destinationPort,long originatorPort,char *out,size_t size);
+/**
+ * @brief As <b>encodeDataBinary</b> but copy the TPDU into a caller's buffer,
+ * see <b>encodeBinary</b> with an output buffer.
+ */
+  int encodeDataBinary(const char *recipient,const unsigned char *data,int length,long destinationPort,long originatorPort,unsigned char *out,size_t size);
   /**
    * @brief Get the address of the PDU message created by <b>encodePDU</b>
    * 
@@ -115,6 +407,42 @@ public:
  * 
  */
   void setSCAnumber(const char *number);
+/**
+ * @brief Choose the national language tables the encoder may use for text the GSM 7 bit
+ * default alphabet cannot carry. The tables are signalled in the UDH, a phone without
+ * them shows the default alphabet instead. All are allowed until this is called.
+ * 
+ * @param languages NATIONAL_MASK of each language, or'ed together. 0 to always fall back to UCS-2
+ */
+  void setNationalLanguages(unsigned languages);
+/**
+ * @brief Allow the encoder to replace characters missing from the GSM 7 bit alphabet
+ * by close matches, e.g. curly quotes by straight ones, "..." for an ellipsis, accented
+ * letters without the accent and Cyrillic in Latin letters. Used only for a text that
+ * would otherwise be sent in UCS-2, and only if every such character has a match.
+ * The text received is not the text sent. Off until this is called.
+ * 
+ * @param on true to allow transliteration
+ */
+  void setTransliterate(bool on);
+/**
+ * @brief Ask for a status report for each SMS-SUBMIT encoded from now on (TP-SRR).
+ * Reports are decoded by <b>decodeStatusReport</b> and matched up by <b>PDUReceiptIndex</b>.
+ * 
+ * @param on true to request status reports
+ */
+  void setStatusReport(bool on);
+/**
+ * @brief Set the TP-MR of the next SMS-SUBMIT. Each SMS-SUBMIT, including each part of
+ * a concatenated message, takes the next reference, wrapping from 255 to 0.
+ * Use 1 PDU object per modem so that the references of a modem follow on.
+ */
+  void setMessageReference(unsigned char reference);
+/**
+ * @brief Get the TP-MR of the last SMS-SUBMIT encoded.
+ * If the modem replaces it, as many do, use the reference from its +CMGS response instead.
+ */
+  unsigned char getMessageReference();
   /**
    * @brief Decode a PDU, typically received from a GSM modem when in PDU mode.
    * After a successful decoding you can retrieve the components parts, described below.
@@ -124,6 +452,94 @@ public:
    * @return false If the decoding did not succeed.
    */
   bool decodePDU(const char *pdu);
+  /**
+   * @brief Decode an SMS-STATUS-REPORT, e.g. from a +CDS notification.
+   * <b>decodePDU</b> returns false for a status report, and this for anything else.
+   * 
+   * @param pdu A pointer to the PDU
+   * @param report Receives the fields
+   * @return true If the decoding succeeded.
+   * @return false If the decoding did not succeed.
+   */
+  bool decodeStatusReport(const char *pdu, PDUStatusReport *report);
+  /**
+   * @brief As <b>decodeStatusReport</b> for a binary PDU, see <b>decodeBinary</b>.
+   */
+  bool decodeStatusReportBinary(const unsigned char *pdu, int length, PDUStatusReport *report, bool withSCA = true);
+  /**
+   * @brief Locate the fields of a PDU without copying them. Much faster than <b>decodePDU</b>
+   * when only some fields are needed. The text and numbers are retrieved with the <b>view</b> methods below.
+   * The PDU is checked to be hex, as by <b>decodePDU</b>, but not converted, the view methods read the hex.
+   * 
+   * @param pdu A pointer to the PDU, must remain valid while the view is used
+   * @param view Receives the offsets of the fields
+   * @return true If the decoding succeeded.
+   * @return false If the decoding did not succeed.
+   */
+  bool decodeView(const char *pdu, PDUView *view);
+  /**
+   * @brief Decode many PDUs in one call into the columns of a <b>PDUBatch</b>.
+   * Nothing is kept in the PDU object, <b>getText</b> etc. are not changed.
+   * 
+   * @param pdus The PDUs, as for <b>decodePDU</b>
+   * @param count Number of PDUs
+   * @param batch The columns to fill in, and the text arena
+   * @return int Number of PDUs with status BATCH_OK
+   */
+  int decodeBatch(const char *const *pdus, int count, PDUBatch *batch);
+  /**
+   * @brief Decode a binary PDU, i.e. the octets that <b>decodePDU</b> receives in printable hex.
+   * 
+   * @param pdu A pointer to the octets
+   * @param length The number of octets
+   * @param withSCA false if pdu is a bare TPDU, starting with the PDU type
+   * @return true If the decoding succeeded.
+   * @return false If the decoding did not succeed.
+   */
+  bool decodeBinary(const unsigned char *pdu, int length, bool withSCA = true);
+  /**
+   * @brief As <b>decodeView</b> for a binary PDU, see <b>decodeBinary</b>.
+   */
+  bool decodeViewBinary(const unsigned char *pdu, int length, PDUView *view, bool withSCA = true);
+  /**
+   * @brief Write the SCA number of a view into a buffer.
+   * The result is truncated to fit and always has an end marker, as for snprintf.
+   * 
+   * @param view Filled in by <b>decodeView</b>
+   * @param out Where to place the string
+   * @param size Size of out
+   * @return int The length of the complete string, if not less than size the string was truncated
+   */
+  int viewSCA(const PDUView *view, char *out, size_t size);
+  /**
+   * @brief Write the senders phone number of a view into a buffer, as for <b>viewSCA</b>
+   */
+  int viewSender(const PDUView *view, char *out, size_t size);
+  /**
+   * @brief Write the timestamp of a view into a buffer, as for <b>viewSCA</b>
+   */
+  int viewTimeStamp(const PDUView *view, char *out, size_t size);
+  /**
+   * @brief Write the text of a view into a buffer, in UTF-8 format, as for <b>viewSCA</b>.
+   * A buffer of MAX_TEXT_LENGTH is always big enough, allowing 3 bytes for each septet.
+   * 
+   * @return int The length of the complete text, -1 if the alphabet is not supported
+   */
+  int viewText(const PDUView *view, char *out, size_t size);
+  /**
+   * @brief Size of a buffer that always holds the text of a view, worked out from
+   * its DCS and user data length without decoding it. For 8 bit data the size of the data.
+   * 
+   * @return int The size, including the end marker, -1 if the alphabet is not supported
+   */
+  int viewTextSize(const PDUView *view);
+  /**
+   * @brief Copy the 8 bit data of a view, without the UDH, into a buffer.
+   * The data is truncated to fit, nothing is added to it.
+   * 
+   * @return int The number of octets of data, if more than size the data was truncated. -1 if the alphabet is not 8 bit
+   */
+  int viewData(const PDUView *view, unsigned char *out, size_t size);
   //const char *getSCA();
   /**
    * @brief Get the SCA number from a decoded PDU
@@ -149,6 +565,19 @@ public:
    * @return const unsigned char* The message in UTF-8 format.
    */
   const char *getText();
+  /**
+   * @brief Get the data from a decoded PDU with 8 bit data, see <b>getDataLength</b>.
+   * The same buffer as <b>getText</b>, which only has text for the 7 and 16 bit alphabets.
+   * 
+   * @return const unsigned char* The octets, as sent
+   */
+  const unsigned char *getData();
+  /**
+   * @brief Get the length of the data from a decoded PDU, or of the text in UTF-8.
+   * 
+   * @return int The number of octets
+   */
+  int getDataLength();
   /**
    * @brief Get the user data header.
    * 
@@ -170,49 +599,92 @@ public:
    */
   int buildUtf(unsigned long codepoint, char *target); // build a string from a codepoint
 private:
+  // numbers written to PDUBatch and PDUStatusReport, whose fields are MAX_NUMBER_LENGTH, go no longer than this codec's own
+  static const int numberField = Traits::numberLength < MAX_NUMBER_LENGTH ? Traits::numberLength : MAX_NUMBER_LENGTH;
   // following for storing decode fields of incoming messages
   int scalength;
-  char scabuff[MAX_NUMBER_LENGTH];
+  char scabuff[Traits::numberLength];
   int addressLength;  // in octets
-  char addressBuff[MAX_NUMBER_LENGTH];  // ample for any phone number
+  char addressBuff[Traits::numberLength];  // ample for any phone number
   int meslength;
-  char mesbuff[MAX_SMS_LENGTH_7BIT];  // actually packed 7 bit is 140
+  char mesbuff[Traits::textLength];  // 140 octets expanded to UTF-8, or 8 bit data as is
   unsigned char pduType;
   UDH udh;
   int tslength;
   char tsbuff[20];    // big enough for timestamp
-  char scanumber[MAX_NUMBER_LENGTH];  // for outgoing SMS
+  char scanumber[Traits::numberLength];  // for outgoing SMS
   // following for buiulding an SMS-SUBMIT message - Binary not ASCII
   int addressType;    // GSM 3.04     for building address part of SMS SUBMIT
   int smsOffset;
-  char smsSubmit[PDU_BINARY_MAX_LENGTH*2];  // big enough for largest message
+  char smsSubmit[Traits::printable ? PDU_BINARY_MAX_LENGTH*2 : PDU_BINARY_MAX_LENGTH];  // big enough for largest message
+  int tpduOffset;     // TPDU starts after SCA
+  int submitLength;   // binary length including SCA
+  // following for building a concatenated SMS
+  const char *mpMessage;    // remainder of the text still to be sent
+  char mpRecipient[Traits::numberLength+1];
+  unsigned short mpReference;
+  unsigned char mpTotal;
+  unsigned char mpPart;
+  eDCS mpDcs;
+  unsigned char mpLocking;
+  unsigned char mpSingle;
+  bool mpTransliterating;
+  // national language tables
+  unsigned nationalLanguages;   // allowed for encoding
+  unsigned char lockingShift;   // in use by the message being encoded
+  unsigned char singleShift;
+  // transliteration
+  bool transliteration;         // allowed for encoding
+  bool transliterating;         // in use by the message being encoded
+  // status reports
+  unsigned char nextReference;  // TP-MR
+  unsigned char lastReference;
+  bool statusReport;            // TP-SRR
   // helper methods
+  unsigned languages();         // national languages the encoder may use
   //bool setMessage(const char *message,eDCS);
 
   void stringToBCD(const char *number, char *pdu);
-  void BCDtoString(char *number, const char *pdu,int length);
+  int BCDtoString(char *number, const PDUView *view, int offset, int length, int size);
   void digitSwap(const char *number, char *pdu);
   
-  int utf8_to_packed7bit(const char *utf8, char *pdu);
-  int pdu_to_ascii(const char *pdu, int pdulength, char *ascii);
+  unsigned char getOctet(const PDUView *view, int offset);
+  int unpackSeptets(const PDUView *view, int offset, int startSeptet, int septets, unsigned char *a7bit);
+  int pdu_to_ascii(const PDUView *view, int offset, int startSeptet, int septets, char *ascii, int size);
 
-  int convert_utf8_to_gsm7bit(const char *ascii, char *a7bit);
-  int convert_7bit_to_ascii(unsigned char *a7bit, int length, char *ascii);
+  int convert_utf8_to_gsm7bit(const char *ascii, char *a7bit, int length);
+  int convert_7bit_to_ascii(unsigned char *a7bit, int length, char *ascii, int size, int locking, int single);
 
   unsigned char gethex(const char *pc);
-  void putHex(unsigned char b, char *target);
   // return number of ucs2 octets in output array
-  int pdu_to_ucs2(const char *pdu, int length, unsigned short *ucs2);
-  // callers responsibilty that utf8 array is big enough
-  int ucs2_to_utf8(unsigned short ucs2, char *utf8);
+  int pdu_to_ucs2(const PDUView *view, int offset, int length, unsigned short *ucs2);
+  // callers responsibilty that utf8 array is big enough, highSurrogate starts at 0
+  int ucs2_to_utf8(unsigned short ucs2, char *utf8, unsigned short *highSurrogate);
   // callers responsibilty that ucs2 array is big enough
   int utf8_to_ucs2_single(const char *utf8, short *ucs2);  // translate to a single uds2
   int utf8_to_ucs2(const char *utf8, char *ucs2);  // translate an utf8 zero terminated string
   // get length of next utf8
   int utf8Length(const char *);
-  int decodeAddress(const char *,char *, eLengthType);  // pdu to readable starts with length octet
-  int decodeUDH(const char *);
+  bool addressTypeValid(unsigned char);
+  int addressToString(const PDUView *view, int offset, int length, unsigned char adt, char *output, int size);
+  int decodeUDH(const PDUView *view, int offset, UDH *);
+  int parseSCA(PDUView *view, bool withSCA);
+  bool parseView(PDUView *view, bool withSCA);
+  int timeStampToString(const PDUView *view, int offset, char *out, size_t size);
+  bool decodeFields(const PDUView *view);
+  int hexLength(const char *pdu);
+  int hexToBinary(const char *pdu, unsigned char *binary);
+  eBatchStatus decodeBatchEntry(const char *pdu, int i, PDUBatch *batch);
   bool setAddress(const char *,eAddressType,eLengthType);
+  // number of bytes of text that fit into budget septets/ucs2 units
+  int segmentLength(const char *text, eDCS dcs, int budget);
+  int submitHeader(const char *recipient, eDCS dcs, bool udh);
+  int encodeSegment(const char *text, int length, eDCS dcs, int udhlength);
+  int udhLength(bool concatenated);
+  void writeUDH(char *udh, int udhlength, bool concatenated);
+  void binaryToHex(int length, char *out);
+  int hexOut(int length, char *out, size_t size);
+  int binaryOut(int length, unsigned char *out, size_t size);
 //  //  Get SCA number for outgoing SMS
 //  const char *getMySCAnumber();
 };
@@ -474,7 +946,7 @@ short lookup_ascii8to7[] = {
   -101,       /*   234    ? lowercase e circumflex                  */
   -101,       /*   235    ? lowercase e dieresis or umlaut          */
   7,          /*   236    ? lowercase i grave                       */
-  7,          /*   237    ? lowercase i acute                       */
+  -7,         /*   237    ? lowercase i acute                       */
   -105,       /*   238    ? lowercase i circumflex                  */
   -105,       /*   239    ? lowercase i dieresis or umlaut          */
   NPC7,       /*   240    ? lowercase eth                           */
@@ -496,162 +968,289 @@ short lookup_ascii8to7[] = {
 };
 
 /****************************************************************************
-This lookup table converts from the 7 bit "default alphabet" as
-defined in ETSI GSM 03.38 to a standard ISO-8859-1 8-bit ASCII.
+This table converts from the 7 bit "default alphabet" as defined in
+ETSI GSM 03.38 straight to UTF-8.
 
-Some characters in the 7-bit alphabet does not exist in the ISO
-character set, they are replaced by the NPC8-character.
-
-If the character is decimal 27 (ESC) the following character have
-a special meaning and must be handled separately.
+The first 128 entries are the default alphabet, the next 128 the extension
+table reached by the escape septet 27. Extension septets not defined by
+GSM 03.38 are shown as the default alphabet character, as the standard
+requires. Each entry is the length of the UTF-8 followed by up to 3 bytes,
+worked out by the compiler from the Unicode codepoint.
 ****************************************************************************/
 
+#define GSM7_EXTENSION 128      // offset of the extension table
+#define GSM7_UTF8(cp) { \
+  (cp) < 0x80 ? 1 : (cp) < 0x800 ? 2 : 3, \
+  (cp) < 0x80 ? (cp) : (cp) < 0x800 ? 0xC0 | ((cp) >> 6) : 0xE0 | ((cp) >> 12), \
+  (cp) < 0x80 ? 0 : (cp) < 0x800 ? 0x80 | ((cp) & 0x3F) : 0x80 | (((cp) >> 6) & 0x3F), \
+  (cp) < 0x800 ? 0 : 0x80 | ((cp) & 0x3F) }
+
 const
 #ifdef PM
       PROGMEM
 #endif
-        unsigned char lookup_ascii7to8[] = {
-  64,         /*  0      @  COMMERCIAL AT                           */
-  163,        /*  1      £  POUND SIGN                              */
-  36,         /*  2      $  DOLLAR SIGN                             */
-  165,        /*  3      ¥  YEN SIGN                                */
-  232,        /*  4      ?  LATIN SMALL LETTER E WITH GRAVE         */
-  233,        /*  5      ?  LATIN SMALL LETTER E WITH ACUTE         */
-  249,        /*  6      ?  LATIN SMALL LETTER U WITH GRAVE         */
-  236,        /*  7      ?  LATIN SMALL LETTER I WITH GRAVE         */
-  242,        /*  8      ?  LATIN SMALL LETTER O WITH GRAVE         */
-  199,        /*  9      ?  LATIN CAPITAL LETTER C WITH CEDILLA     */
-  10,         /*  10        LINE FEED                               */
-  216,        /*  11     ?  LATIN CAPITAL LETTER O WITH STROKE      */
-  248,        /*  12     ?  LATIN SMALL LETTER O WITH STROKE        */
-  13,         /*  13        CARRIAGE RETURN                         */
-  197,        /*  14     ?  LATIN CAPITAL LETTER A WITH RING ABOVE  */
-  229,        /*  15     ?  LATIN SMALL LETTER A WITH RING ABOVE    */
-  NPC8,       /*  16        GREEK CAPITAL LETTER DELTA              */
-  95,         /*  17     _  LOW LINE                                */
-  NPC8,       /*  18        GREEK CAPITAL LETTER PHI                */
-  NPC8,       /*  19        GREEK CAPITAL LETTER GAMMA              */
-  NPC8,       /*  20        GREEK CAPITAL LETTER LAMBDA             */
-  NPC8,       /*  21        GREEK CAPITAL LETTER OMEGA              */
-  NPC8,       /*  22        GREEK CAPITAL LETTER PI                 */
-  NPC8,       /*  23        GREEK CAPITAL LETTER PSI                */
-  NPC8,       /*  24        GREEK CAPITAL LETTER SIGMA              */
-  NPC8,       /*  25        GREEK CAPITAL LETTER THETA              */
-  NPC8,       /*  26        GREEK CAPITAL LETTER XI                 */
-  27,         /*  27        ESCAPE TO EXTENSION TABLE               */
-  198,        /*  28     ?  LATIN CAPITAL LETTER AE                 */
-  230,        /*  29     ?  LATIN SMALL LETTER AE                   */
-  223,        /*  30     ?  LATIN SMALL LETTER SHARP S (German)     */
-  201,        /*  31     ?  LATIN CAPITAL LETTER E WITH ACUTE       */
-  32,         /*  32        SPACE                                   */
-  33,         /*  33     !  EXCLAMATION MARK                        */
-  34,         /*  34     "  QUOTATION MARK                          */
-  35,         /*  35     #  NUMBER SIGN                             */
-  164,        /*  36     ?  CURRENCY SIGN                           */
-  37,         /*  37     %  PERCENT SIGN                            */
-  38,         /*  38     &  AMPERSAND                               */
-  39,         /*  39     '  APOSTROPHE                              */
-  40,         /*  40     (  LEFT PARENTHESIS                        */
-  41,         /*  41     )  RIGHT PARENTHESIS                       */
-  42,         /*  42     *  ASTERISK                                */
-  43,         /*  43     +  PLUS SIGN                               */
-  44,         /*  44     ,  COMMA                                   */
-  45,         /*  45     -  HYPHEN-MINUS                            */
-  46,         /*  46     .  FULL STOP                               */
-  47,         /*  47     /  SOLIDUS (SLASH)                         */
-  48,         /*  48     0  DIGIT ZERO                              */
-  49,         /*  49     1  DIGIT ONE                               */
-  50,         /*  50     2  DIGIT TWO                               */
-  51,         /*  51     3  DIGIT THREE                             */
-  52,         /*  52     4  DIGIT FOUR                              */
-  53,         /*  53     5  DIGIT FIVE                              */
-  54,         /*  54     6  DIGIT SIX                               */
-  55,         /*  55     7  DIGIT SEVEN                             */
-  56,         /*  56     8  DIGIT EIGHT                             */
-  57,         /*  57     9  DIGIT NINE                              */
-  58,         /*  58     :  COLON                                   */
-  59,         /*  59     ;  SEMICOLON                               */
-  60,         /*  60     <  LESS-THAN SIGN                          */
-  61,         /*  61     =  EQUALS SIGN                             */
-  62,         /*  62     >  GREATER-THAN SIGN                       */
-  63,         /*  63     ?  QUESTION MARK                           */
-  161,        /*  64     ¡  INVERTED EXCLAMATION MARK               */
-  65,         /*  65     A  LATIN CAPITAL LETTER A                  */
-  66,         /*  66     B  LATIN CAPITAL LETTER B                  */
-  67,         /*  67     C  LATIN CAPITAL LETTER C                  */
-  68,         /*  68     D  LATIN CAPITAL LETTER D                  */
-  69,         /*  69     E  LATIN CAPITAL LETTER E                  */
-  70,         /*  70     F  LATIN CAPITAL LETTER F                  */
-  71,         /*  71     G  LATIN CAPITAL LETTER G                  */
-  72,         /*  72     H  LATIN CAPITAL LETTER H                  */
-  73,         /*  73     I  LATIN CAPITAL LETTER I                  */
-  74,         /*  74     J  LATIN CAPITAL LETTER J                  */
-  75,         /*  75     K  LATIN CAPITAL LETTER K                  */
-  76,         /*  76     L  LATIN CAPITAL LETTER L                  */
-  77,         /*  77     M  LATIN CAPITAL LETTER M                  */
-  78,         /*  78     N  LATIN CAPITAL LETTER N                  */
-  79,         /*  79     O  LATIN CAPITAL LETTER O                  */
-  80,         /*  80     P  LATIN CAPITAL LETTER P                  */
-  81,         /*  81     Q  LATIN CAPITAL LETTER Q                  */
-  82,         /*  82     R  LATIN CAPITAL LETTER R                  */
-  83,         /*  83     S  LATIN CAPITAL LETTER S                  */
-  84,         /*  84     T  LATIN CAPITAL LETTER T                  */
-  85,         /*  85     U  LATIN CAPITAL LETTER U                  */
-  86,         /*  86     V  LATIN CAPITAL LETTER V                  */
-  87,         /*  87     W  LATIN CAPITAL LETTER W                  */
-  88,         /*  88     X  LATIN CAPITAL LETTER X                  */
-  89,         /*  89     Y  LATIN CAPITAL LETTER Y                  */
-  90,         /*  90     Z  LATIN CAPITAL LETTER Z                  */
-  196,        /*  91     ?  LATIN CAPITAL LETTER A WITH DIAERESIS   */
-  214,        /*  92     ?  LATIN CAPITAL LETTER O WITH DIAERESIS   */
-  209,        /*  93     ?  LATIN CAPITAL LETTER N WITH TILDE       */
-  220,        /*  94     ?  LATIN CAPITAL LETTER U WITH DIAERESIS   */
-  167,        /*  95     §  SECTION SIGN                            */
-  191,        /*  96     ¿  INVERTED QUESTION MARK                  */
-  97,         /*  97     a  LATIN SMALL LETTER A                    */
-  98,         /*  98     b  LATIN SMALL LETTER B                    */
-  99,         /*  99     c  LATIN SMALL LETTER C                    */
-  100,        /*  100    d  LATIN SMALL LETTER D                    */
-  101,        /*  101    e  LATIN SMALL LETTER E                    */
-  102,        /*  102    f  LATIN SMALL LETTER F                    */
-  103,        /*  103    g  LATIN SMALL LETTER G                    */
-  104,        /*  104    h  LATIN SMALL LETTER H                    */
-  105,        /*  105    i  LATIN SMALL LETTER I                    */
-  106,        /*  106    j  LATIN SMALL LETTER J                    */
-  107,        /*  107    k  LATIN SMALL LETTER K                    */
-  108,        /*  108    l  LATIN SMALL LETTER L                    */
-  109,        /*  109    m  LATIN SMALL LETTER M                    */
-  110,        /*  110    n  LATIN SMALL LETTER N                    */
-  111,        /*  111    o  LATIN SMALL LETTER O                    */
-  112,        /*  112    p  LATIN SMALL LETTER P                    */
-  113,        /*  113    q  LATIN SMALL LETTER Q                    */
-  114,        /*  114    r  LATIN SMALL LETTER R                    */
-  115,        /*  115    s  LATIN SMALL LETTER S                    */
-  116,        /*  116    t  LATIN SMALL LETTER T                    */
-  117,        /*  117    u  LATIN SMALL LETTER U                    */
-  118,        /*  118    v  LATIN SMALL LETTER V                    */
-  119,        /*  119    w  LATIN SMALL LETTER W                    */
-  120,        /*  120    x  LATIN SMALL LETTER X                    */
-  121,        /*  121    y  LATIN SMALL LETTER Y                    */
-  122,        /*  122    z  LATIN SMALL LETTER Z                    */
-  228,        /*  123    ?  LATIN SMALL LETTER A WITH DIAERESIS     */
-  246,        /*  124    ?  LATIN SMALL LETTER O WITH DIAERESIS     */
-  241,        /*  125    ?  LATIN SMALL LETTER N WITH TILDE         */
-  252,        /*  126    ?  LATIN SMALL LETTER U WITH DIAERESIS     */
-  224         /*  127    ?  LATIN SMALL LETTER A WITH GRAVE         */
-
-        /*  The double bytes below must be handled separately after the
-        table lookup.
-
-        12             27 10      FORM FEED
-        94             27 20   ^  CIRCUMFLEX ACCENT
-        123            27 40   {  LEFT CURLY BRACKET
-        125            27 41   }  RIGHT CURLY BRACKET
-        92             27 47   \  REVERSE SOLIDUS (BACKSLASH)
-        91             27 60   [  LEFT SQUARE BRACKET
-        126            27 61   ~  TILDE
-        93             27 62   ]  RIGHT SQUARE BRACKET
-        124            27 64   |  VERTICAL BAR                             */
-
+        unsigned char lookup_gsm7_utf8[256][4] = {
+  GSM7_UTF8(0x0040),  /*  0      COMMERCIAL AT                     */
+  GSM7_UTF8(0x00A3),  /*  1      POUND SIGN                        */
+  GSM7_UTF8(0x0024),  /*  2      DOLLAR SIGN                       */
+  GSM7_UTF8(0x00A5),  /*  3      YEN SIGN                          */
+  GSM7_UTF8(0x00E8),  /*  4      LATIN SMALL LETTER E WITH GRAVE   */
+  GSM7_UTF8(0x00E9),  /*  5      LATIN SMALL LETTER E WITH ACUTE   */
+  GSM7_UTF8(0x00F9),  /*  6      LATIN SMALL LETTER U WITH GRAVE   */
+  GSM7_UTF8(0x00EC),  /*  7      LATIN SMALL LETTER I WITH GRAVE   */
+  GSM7_UTF8(0x00F2),  /*  8      LATIN SMALL LETTER O WITH GRAVE   */
+  GSM7_UTF8(0x00C7),  /*  9      LATIN CAPITAL LETTER C WITH CEDILLA */
+  GSM7_UTF8(0x000A),  /*  10     LINE FEED                         */
+  GSM7_UTF8(0x00D8),  /*  11     LATIN CAPITAL LETTER O WITH STROKE */
+  GSM7_UTF8(0x00F8),  /*  12     LATIN SMALL LETTER O WITH STROKE  */
+  GSM7_UTF8(0x000D),  /*  13     CARRIAGE RETURN                   */
+  GSM7_UTF8(0x00C5),  /*  14     LATIN CAPITAL LETTER A WITH RING ABOVE */
+  GSM7_UTF8(0x00E5),  /*  15     LATIN SMALL LETTER A WITH RING ABOVE */
+  GSM7_UTF8(0x0394),  /*  16     GREEK CAPITAL LETTER DELTA        */
+  GSM7_UTF8(0x005F),  /*  17     LOW LINE                          */
+  GSM7_UTF8(0x03A6),  /*  18     GREEK CAPITAL LETTER PHI          */
+  GSM7_UTF8(0x0393),  /*  19     GREEK CAPITAL LETTER GAMMA        */
+  GSM7_UTF8(0x039B),  /*  20     GREEK CAPITAL LETTER LAMDA        */
+  GSM7_UTF8(0x03A9),  /*  21     GREEK CAPITAL LETTER OMEGA        */
+  GSM7_UTF8(0x03A0),  /*  22     GREEK CAPITAL LETTER PI           */
+  GSM7_UTF8(0x03A8),  /*  23     GREEK CAPITAL LETTER PSI          */
+  GSM7_UTF8(0x03A3),  /*  24     GREEK CAPITAL LETTER SIGMA        */
+  GSM7_UTF8(0x0398),  /*  25     GREEK CAPITAL LETTER THETA        */
+  GSM7_UTF8(0x039E),  /*  26     GREEK CAPITAL LETTER XI           */
+  {0,0,0,0},          /*  27     ESCAPE TO EXTENSION TABLE         */
+  GSM7_UTF8(0x00C6),  /*  28     LATIN CAPITAL LETTER AE           */
+  GSM7_UTF8(0x00E6),  /*  29     LATIN SMALL LETTER AE             */
+  GSM7_UTF8(0x00DF),  /*  30     LATIN SMALL LETTER SHARP S        */
+  GSM7_UTF8(0x00C9),  /*  31     LATIN CAPITAL LETTER E WITH ACUTE */
+  GSM7_UTF8(0x0020),  /*  32     SPACE                             */
+  GSM7_UTF8(0x0021),  /*  33     EXCLAMATION MARK                  */
+  GSM7_UTF8(0x0022),  /*  34     QUOTATION MARK                    */
+  GSM7_UTF8(0x0023),  /*  35     NUMBER SIGN                       */
+  GSM7_UTF8(0x00A4),  /*  36     CURRENCY SIGN                     */
+  GSM7_UTF8(0x0025),  /*  37     PERCENT SIGN                      */
+  GSM7_UTF8(0x0026),  /*  38     AMPERSAND                         */
+  GSM7_UTF8(0x0027),  /*  39     APOSTROPHE                        */
+  GSM7_UTF8(0x0028),  /*  40     LEFT PARENTHESIS                  */
+  GSM7_UTF8(0x0029),  /*  41     RIGHT PARENTHESIS                 */
+  GSM7_UTF8(0x002A),  /*  42     ASTERISK                          */
+  GSM7_UTF8(0x002B),  /*  43     PLUS SIGN                         */
+  GSM7_UTF8(0x002C),  /*  44     COMMA                             */
+  GSM7_UTF8(0x002D),  /*  45     HYPHEN-MINUS                      */
+  GSM7_UTF8(0x002E),  /*  46     FULL STOP                         */
+  GSM7_UTF8(0x002F),  /*  47     SOLIDUS                           */
+  GSM7_UTF8(0x0030),  /*  48     DIGIT ZERO                        */
+  GSM7_UTF8(0x0031),  /*  49     DIGIT ONE                         */
+  GSM7_UTF8(0x0032),  /*  50     DIGIT TWO                         */
+  GSM7_UTF8(0x0033),  /*  51     DIGIT THREE                       */
+  GSM7_UTF8(0x0034),  /*  52     DIGIT FOUR                        */
+  GSM7_UTF8(0x0035),  /*  53     DIGIT FIVE                        */
+  GSM7_UTF8(0x0036),  /*  54     DIGIT SIX                         */
+  GSM7_UTF8(0x0037),  /*  55     DIGIT SEVEN                       */
+  GSM7_UTF8(0x0038),  /*  56     DIGIT EIGHT                       */
+  GSM7_UTF8(0x0039),  /*  57     DIGIT NINE                        */
+  GSM7_UTF8(0x003A),  /*  58     COLON                             */
+  GSM7_UTF8(0x003B),  /*  59     SEMICOLON                         */
+  GSM7_UTF8(0x003C),  /*  60     LESS-THAN SIGN                    */
+  GSM7_UTF8(0x003D),  /*  61     EQUALS SIGN                       */
+  GSM7_UTF8(0x003E),  /*  62     GREATER-THAN SIGN                 */
+  GSM7_UTF8(0x003F),  /*  63     QUESTION MARK                     */
+  GSM7_UTF8(0x00A1),  /*  64     INVERTED EXCLAMATION MARK         */
+  GSM7_UTF8(0x0041),  /*  65     LATIN CAPITAL LETTER A            */
+  GSM7_UTF8(0x0042),  /*  66     LATIN CAPITAL LETTER B            */
+  GSM7_UTF8(0x0043),  /*  67     LATIN CAPITAL LETTER C            */
+  GSM7_UTF8(0x0044),  /*  68     LATIN CAPITAL LETTER D            */
+  GSM7_UTF8(0x0045),  /*  69     LATIN CAPITAL LETTER E            */
+  GSM7_UTF8(0x0046),  /*  70     LATIN CAPITAL LETTER F            */
+  GSM7_UTF8(0x0047),  /*  71     LATIN CAPITAL LETTER G            */
+  GSM7_UTF8(0x0048),  /*  72     LATIN CAPITAL LETTER H            */
+  GSM7_UTF8(0x0049),  /*  73     LATIN CAPITAL LETTER I            */
+  GSM7_UTF8(0x004A),  /*  74     LATIN CAPITAL LETTER J            */
+  GSM7_UTF8(0x004B),  /*  75     LATIN CAPITAL LETTER K            */
+  GSM7_UTF8(0x004C),  /*  76     LATIN CAPITAL LETTER L            */
+  GSM7_UTF8(0x004D),  /*  77     LATIN CAPITAL LETTER M            */
+  GSM7_UTF8(0x004E),  /*  78     LATIN CAPITAL LETTER N            */
+  GSM7_UTF8(0x004F),  /*  79     LATIN CAPITAL LETTER O            */
+  GSM7_UTF8(0x0050),  /*  80     LATIN CAPITAL LETTER P            */
+  GSM7_UTF8(0x0051),  /*  81     LATIN CAPITAL LETTER Q            */
+  GSM7_UTF8(0x0052),  /*  82     LATIN CAPITAL LETTER R            */
+  GSM7_UTF8(0x0053),  /*  83     LATIN CAPITAL LETTER S            */
+  GSM7_UTF8(0x0054),  /*  84     LATIN CAPITAL LETTER T            */
+  GSM7_UTF8(0x0055),  /*  85     LATIN CAPITAL LETTER U            */
+  GSM7_UTF8(0x0056),  /*  86     LATIN CAPITAL LETTER V            */
+  GSM7_UTF8(0x0057),  /*  87     LATIN CAPITAL LETTER W            */
+  GSM7_UTF8(0x0058),  /*  88     LATIN CAPITAL LETTER X            */
+  GSM7_UTF8(0x0059),  /*  89     LATIN CAPITAL LETTER Y            */
+  GSM7_UTF8(0x005A),  /*  90     LATIN CAPITAL LETTER Z            */
+  GSM7_UTF8(0x00C4),  /*  91     LATIN CAPITAL LETTER A WITH DIAERESIS */
+  GSM7_UTF8(0x00D6),  /*  92     LATIN CAPITAL LETTER O WITH DIAERESIS */
+  GSM7_UTF8(0x00D1),  /*  93     LATIN CAPITAL LETTER N WITH TILDE */
+  GSM7_UTF8(0x00DC),  /*  94     LATIN CAPITAL LETTER U WITH DIAERESIS */
+  GSM7_UTF8(0x00A7),  /*  95     SECTION SIGN                      */
+  GSM7_UTF8(0x00BF),  /*  96     INVERTED QUESTION MARK            */
+  GSM7_UTF8(0x0061),  /*  97     LATIN SMALL LETTER A              */
+  GSM7_UTF8(0x0062),  /*  98     LATIN SMALL LETTER B              */
+  GSM7_UTF8(0x0063),  /*  99     LATIN SMALL LETTER C              */
+  GSM7_UTF8(0x0064),  /*  100    LATIN SMALL LETTER D              */
+  GSM7_UTF8(0x0065),  /*  101    LATIN SMALL LETTER E              */
+  GSM7_UTF8(0x0066),  /*  102    LATIN SMALL LETTER F              */
+  GSM7_UTF8(0x0067),  /*  103    LATIN SMALL LETTER G              */
+  GSM7_UTF8(0x0068),  /*  104    LATIN SMALL LETTER H              */
+  GSM7_UTF8(0x0069),  /*  105    LATIN SMALL LETTER I              */
+  GSM7_UTF8(0x006A),  /*  106    LATIN SMALL LETTER J              */
+  GSM7_UTF8(0x006B),  /*  107    LATIN SMALL LETTER K              */
+  GSM7_UTF8(0x006C),  /*  108    LATIN SMALL LETTER L              */
+  GSM7_UTF8(0x006D),  /*  109    LATIN SMALL LETTER M              */
+  GSM7_UTF8(0x006E),  /*  110    LATIN SMALL LETTER N              */
+  GSM7_UTF8(0x006F),  /*  111    LATIN SMALL LETTER O              */
+  GSM7_UTF8(0x0070),  /*  112    LATIN SMALL LETTER P              */
+  GSM7_UTF8(0x0071),  /*  113    LATIN SMALL LETTER Q              */
+  GSM7_UTF8(0x0072),  /*  114    LATIN SMALL LETTER R              */
+  GSM7_UTF8(0x0073),  /*  115    LATIN SMALL LETTER S              */
+  GSM7_UTF8(0x0074),  /*  116    LATIN SMALL LETTER T              */
+  GSM7_UTF8(0x0075),  /*  117    LATIN SMALL LETTER U              */
+  GSM7_UTF8(0x0076),  /*  118    LATIN SMALL LETTER V              */
+  GSM7_UTF8(0x0077),  /*  119    LATIN SMALL LETTER W              */
+  GSM7_UTF8(0x0078),  /*  120    LATIN SMALL LETTER X              */
+  GSM7_UTF8(0x0079),  /*  121    LATIN SMALL LETTER Y              */
+  GSM7_UTF8(0x007A),  /*  122    LATIN SMALL LETTER Z              */
+  GSM7_UTF8(0x00E4),  /*  123    LATIN SMALL LETTER A WITH DIAERESIS */
+  GSM7_UTF8(0x00F6),  /*  124    LATIN SMALL LETTER O WITH DIAERESIS */
+  GSM7_UTF8(0x00F1),  /*  125    LATIN SMALL LETTER N WITH TILDE   */
+  GSM7_UTF8(0x00FC),  /*  126    LATIN SMALL LETTER U WITH DIAERESIS */
+  GSM7_UTF8(0x00E0),  /*  127    LATIN SMALL LETTER A WITH GRAVE   */
+  GSM7_UTF8(0x0040),  /*  27 0   not defined, as 0                 */
+  GSM7_UTF8(0x00A3),  /*  27 1   not defined, as 1                 */
+  GSM7_UTF8(0x0024),  /*  27 2   not defined, as 2                 */
+  GSM7_UTF8(0x00A5),  /*  27 3   not defined, as 3                 */
+  GSM7_UTF8(0x00E8),  /*  27 4   not defined, as 4                 */
+  GSM7_UTF8(0x00E9),  /*  27 5   not defined, as 5                 */
+  GSM7_UTF8(0x00F9),  /*  27 6   not defined, as 6                 */
+  GSM7_UTF8(0x00EC),  /*  27 7   not defined, as 7                 */
+  GSM7_UTF8(0x00F2),  /*  27 8   not defined, as 8                 */
+  GSM7_UTF8(0x00C7),  /*  27 9   not defined, as 9                 */
+  GSM7_UTF8(0x000C),  /*  27 10  FORM FEED                         */
+  GSM7_UTF8(0x00D8),  /*  27 11  not defined, as 11                */
+  GSM7_UTF8(0x00F8),  /*  27 12  not defined, as 12                */
+  GSM7_UTF8(0x000D),  /*  27 13  not defined, as 13                */
+  GSM7_UTF8(0x00C5),  /*  27 14  not defined, as 14                */
+  GSM7_UTF8(0x00E5),  /*  27 15  not defined, as 15                */
+  GSM7_UTF8(0x0394),  /*  27 16  not defined, as 16                */
+  GSM7_UTF8(0x005F),  /*  27 17  not defined, as 17                */
+  GSM7_UTF8(0x03A6),  /*  27 18  not defined, as 18                */
+  GSM7_UTF8(0x0393),  /*  27 19  not defined, as 19                */
+  GSM7_UTF8(0x005E),  /*  27 20  CIRCUMFLEX ACCENT                 */
+  GSM7_UTF8(0x03A9),  /*  27 21  not defined, as 21                */
+  GSM7_UTF8(0x03A0),  /*  27 22  not defined, as 22                */
+  GSM7_UTF8(0x03A8),  /*  27 23  not defined, as 23                */
+  GSM7_UTF8(0x03A3),  /*  27 24  not defined, as 24                */
+  GSM7_UTF8(0x0398),  /*  27 25  not defined, as 25                */
+  GSM7_UTF8(0x039E),  /*  27 26  not defined, as 26                */
+  GSM7_UTF8(0x0020),  /*  27 27  RESERVED, SHOWN AS SPACE          */
+  GSM7_UTF8(0x00C6),  /*  27 28  not defined, as 28                */
+  GSM7_UTF8(0x00E6),  /*  27 29  not defined, as 29                */
+  GSM7_UTF8(0x00DF),  /*  27 30  not defined, as 30                */
+  GSM7_UTF8(0x00C9),  /*  27 31  not defined, as 31                */
+  GSM7_UTF8(0x0020),  /*  27 32  not defined, as 32                */
+  GSM7_UTF8(0x0021),  /*  27 33  not defined, as 33                */
+  GSM7_UTF8(0x0022),  /*  27 34  not defined, as 34                */
+  GSM7_UTF8(0x0023),  /*  27 35  not defined, as 35                */
+  GSM7_UTF8(0x00A4),  /*  27 36  not defined, as 36                */
+  GSM7_UTF8(0x0025),  /*  27 37  not defined, as 37                */
+  GSM7_UTF8(0x0026),  /*  27 38  not defined, as 38                */
+  GSM7_UTF8(0x0027),  /*  27 39  not defined, as 39                */
+  GSM7_UTF8(0x007B),  /*  27 40  LEFT CURLY BRACKET                */
+  GSM7_UTF8(0x007D),  /*  27 41  RIGHT CURLY BRACKET               */
+  GSM7_UTF8(0x002A),  /*  27 42  not defined, as 42                */
+  GSM7_UTF8(0x002B),  /*  27 43  not defined, as 43                */
+  GSM7_UTF8(0x002C),  /*  27 44  not defined, as 44                */
+  GSM7_UTF8(0x002D),  /*  27 45  not defined, as 45                */
+  GSM7_UTF8(0x002E),  /*  27 46  not defined, as 46                */
+  GSM7_UTF8(0x005C),  /*  27 47  REVERSE SOLIDUS                   */
+  GSM7_UTF8(0x0030),  /*  27 48  not defined, as 48                */
+  GSM7_UTF8(0x0031),  /*  27 49  not defined, as 49                */
+  GSM7_UTF8(0x0032),  /*  27 50  not defined, as 50                */
+  GSM7_UTF8(0x0033),  /*  27 51  not defined, as 51                */
+  GSM7_UTF8(0x0034),  /*  27 52  not defined, as 52                */
+  GSM7_UTF8(0x0035),  /*  27 53  not defined, as 53                */
+  GSM7_UTF8(0x0036),  /*  27 54  not defined, as 54                */
+  GSM7_UTF8(0x0037),  /*  27 55  not defined, as 55                */
+  GSM7_UTF8(0x0038),  /*  27 56  not defined, as 56                */
+  GSM7_UTF8(0x0039),  /*  27 57  not defined, as 57                */
+  GSM7_UTF8(0x003A),  /*  27 58  not defined, as 58                */
+  GSM7_UTF8(0x003B),  /*  27 59  not defined, as 59                */
+  GSM7_UTF8(0x005B),  /*  27 60  LEFT SQUARE BRACKET               */
+  GSM7_UTF8(0x007E),  /*  27 61  TILDE                             */
+  GSM7_UTF8(0x005D),  /*  27 62  RIGHT SQUARE BRACKET              */
+  GSM7_UTF8(0x003F),  /*  27 63  not defined, as 63                */
+  GSM7_UTF8(0x007C),  /*  27 64  VERTICAL LINE                     */
+  GSM7_UTF8(0x0041),  /*  27 65  not defined, as 65                */
+  GSM7_UTF8(0x0042),  /*  27 66  not defined, as 66                */
+  GSM7_UTF8(0x0043),  /*  27 67  not defined, as 67                */
+  GSM7_UTF8(0x0044),  /*  27 68  not defined, as 68                */
+  GSM7_UTF8(0x0045),  /*  27 69  not defined, as 69                */
+  GSM7_UTF8(0x0046),  /*  27 70  not defined, as 70                */
+  GSM7_UTF8(0x0047),  /*  27 71  not defined, as 71                */
+  GSM7_UTF8(0x0048),  /*  27 72  not defined, as 72                */
+  GSM7_UTF8(0x0049),  /*  27 73  not defined, as 73                */
+  GSM7_UTF8(0x004A),  /*  27 74  not defined, as 74                */
+  GSM7_UTF8(0x004B),  /*  27 75  not defined, as 75                */
+  GSM7_UTF8(0x004C),  /*  27 76  not defined, as 76                */
+  GSM7_UTF8(0x004D),  /*  27 77  not defined, as 77                */
+  GSM7_UTF8(0x004E),  /*  27 78  not defined, as 78                */
+  GSM7_UTF8(0x004F),  /*  27 79  not defined, as 79                */
+  GSM7_UTF8(0x0050),  /*  27 80  not defined, as 80                */
+  GSM7_UTF8(0x0051),  /*  27 81  not defined, as 81                */
+  GSM7_UTF8(0x0052),  /*  27 82  not defined, as 82                */
+  GSM7_UTF8(0x0053),  /*  27 83  not defined, as 83                */
+  GSM7_UTF8(0x0054),  /*  27 84  not defined, as 84                */
+  GSM7_UTF8(0x0055),  /*  27 85  not defined, as 85                */
+  GSM7_UTF8(0x0056),  /*  27 86  not defined, as 86                */
+  GSM7_UTF8(0x0057),  /*  27 87  not defined, as 87                */
+  GSM7_UTF8(0x0058),  /*  27 88  not defined, as 88                */
+  GSM7_UTF8(0x0059),  /*  27 89  not defined, as 89                */
+  GSM7_UTF8(0x005A),  /*  27 90  not defined, as 90                */
+  GSM7_UTF8(0x00C4),  /*  27 91  not defined, as 91                */
+  GSM7_UTF8(0x00D6),  /*  27 92  not defined, as 92                */
+  GSM7_UTF8(0x00D1),  /*  27 93  not defined, as 93                */
+  GSM7_UTF8(0x00DC),  /*  27 94  not defined, as 94                */
+  GSM7_UTF8(0x00A7),  /*  27 95  not defined, as 95                */
+  GSM7_UTF8(0x00BF),  /*  27 96  not defined, as 96                */
+  GSM7_UTF8(0x0061),  /*  27 97  not defined, as 97                */
+  GSM7_UTF8(0x0062),  /*  27 98  not defined, as 98                */
+  GSM7_UTF8(0x0063),  /*  27 99  not defined, as 99                */
+  GSM7_UTF8(0x0064),  /*  27 100 not defined, as 100               */
+  GSM7_UTF8(0x20AC),  /*  27 101 EURO SIGN                         */
+  GSM7_UTF8(0x0066),  /*  27 102 not defined, as 102               */
+  GSM7_UTF8(0x0067),  /*  27 103 not defined, as 103               */
+  GSM7_UTF8(0x0068),  /*  27 104 not defined, as 104               */
+  GSM7_UTF8(0x0069),  /*  27 105 not defined, as 105               */
+  GSM7_UTF8(0x006A),  /*  27 106 not defined, as 106               */
+  GSM7_UTF8(0x006B),  /*  27 107 not defined, as 107               */
+  GSM7_UTF8(0x006C),  /*  27 108 not defined, as 108               */
+  GSM7_UTF8(0x006D),  /*  27 109 not defined, as 109               */
+  GSM7_UTF8(0x006E),  /*  27 110 not defined, as 110               */
+  GSM7_UTF8(0x006F),  /*  27 111 not defined, as 111               */
+  GSM7_UTF8(0x0070),  /*  27 112 not defined, as 112               */
+  GSM7_UTF8(0x0071),  /*  27 113 not defined, as 113               */
+  GSM7_UTF8(0x0072),  /*  27 114 not defined, as 114               */
+  GSM7_UTF8(0x0073),  /*  27 115 not defined, as 115               */
+  GSM7_UTF8(0x0074),  /*  27 116 not defined, as 116               */
+  GSM7_UTF8(0x0075),  /*  27 117 not defined, as 117               */
+  GSM7_UTF8(0x0076),  /*  27 118 not defined, as 118               */
+  GSM7_UTF8(0x0077),  /*  27 119 not defined, as 119               */
+  GSM7_UTF8(0x0078),  /*  27 120 not defined, as 120               */
+  GSM7_UTF8(0x0079),  /*  27 121 not defined, as 121               */
+  GSM7_UTF8(0x007A),  /*  27 122 not defined, as 122               */
+  GSM7_UTF8(0x00E4),  /*  27 123 not defined, as 123               */
+  GSM7_UTF8(0x00F6),  /*  27 124 not defined, as 124               */
+  GSM7_UTF8(0x00F1),  /*  27 125 not defined, as 125               */
+  GSM7_UTF8(0x00FC),  /*  27 126 not defined, as 126               */
+  GSM7_UTF8(0x00E0)   /*  27 127 not defined, as 127               */
 };
+
+#include <pdubasic.h>
+
+typedef BasicPDU<PDUTraits> PDU;
+extern template class BasicPDU<PDUTraits>;   // in pdulib.cpp
+
 #endif
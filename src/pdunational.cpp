@@ -0,0 +1,721 @@
+/**
+ * @file pdunational.cpp
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief GSM 7 bit national language single and locking shift tables
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * The tables are from 3GPP TS 23.038 annex A. A locking shift table only lists
+ * the septets where it differs from the default alphabet, a single shift table
+ * lists every character it defines, as the extension table does.
+ * Each table is pairs of septet and codepoint, ended by a septet of 0xff.
+ * The Turkish, Spanish and Portuguese tables leave every plain ASCII character
+ * (see pduAsciiRun) where it is, the Indic and Urdu locking shift tables move
+ * capitals and some punctuation to their single shift tables and leave some
+ * septets undefined, see pduNationalKeepsAscii.
+ */
+
+#include <pdulib.h>
+#include <pdunational.h>
+#include <pduascii.h>
+#ifdef PM
+#include <avr/pgmspace.h>
+#endif
+
+#define TABLE_END 0xff
+#define UNDEFINED 0xffff   // septet a locking shift table leaves undefined, received as a space
+
+// default extension table, used when only a locking shift table is given
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short defaultSingle[] = {
+  0x0A, 0x000C, 0x14, '^', 0x28, '{', 0x29, '}', 0x2F, '\\',
+  0x3C, '[', 0x3D, '~', 0x3E, ']', 0x40, '|', 0x65, 0x20AC,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short turkishLocking[] = {
+  0x04, 0x20AC,   // €
+  0x07, 0x0131,   // ı dotless i
+  0x0B, 0x011E,   // Ğ
+  0x0C, 0x011F,   // ğ
+  0x1C, 0x015E,   // Ş
+  0x1D, 0x015F,   // ş
+  0x40, 0x0130,   // İ
+  0x60, 0x00E7,   // ç
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short turkishSingle[] = {
+  0x0A, 0x000C, 0x14, '^', 0x28, '{', 0x29, '}', 0x2F, '\\',
+  0x3C, '[', 0x3D, '~', 0x3E, ']', 0x40, '|',
+  0x47, 0x011E,   // Ğ
+  0x49, 0x0130,   // İ
+  0x53, 0x015E,   // Ş
+  0x63, 0x00E7,   // ç
+  0x65, 0x20AC,   // €
+  0x67, 0x011F,   // ğ
+  0x69, 0x0131,   // ı
+  0x73, 0x015F,   // ş
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short spanishSingle[] = {
+  0x09, 0x00E7,   // ç
+  0x0A, 0x000C, 0x14, '^', 0x28, '{', 0x29, '}', 0x2F, '\\',
+  0x3C, '[', 0x3D, '~', 0x3E, ']', 0x40, '|',
+  0x41, 0x00C1,   // Á
+  0x49, 0x00CD,   // Í
+  0x4F, 0x00D3,   // Ó
+  0x55, 0x00DA,   // Ú
+  0x61, 0x00E1,   // á
+  0x65, 0x20AC,   // €
+  0x69, 0x00ED,   // í
+  0x6F, 0x00F3,   // ó
+  0x75, 0x00FA,   // ú
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short portugueseLocking[] = {
+  0x04, 0x00EA,   // ê
+  0x06, 0x00FA,   // ú
+  0x07, 0x00ED,   // í
+  0x08, 0x00F3,   // ó
+  0x09, 0x00E7,   // ç
+  0x0B, 0x00D4,   // Ô
+  0x0C, 0x00F4,   // ô
+  0x0E, 0x00C1,   // Á
+  0x0F, 0x00E1,   // á
+  0x12, 0x00AA,   // ª
+  0x13, 0x00C7,   // Ç
+  0x14, 0x00C0,   // À
+  0x15, 0x221E,   // ∞
+  0x16, '^',
+  0x17, '\\',
+  0x18, 0x20AC,   // €
+  0x19, 0x00D3,   // Ó
+  0x1A, '|',
+  0x1C, 0x00C2,   // Â
+  0x1D, 0x00E2,   // â
+  0x1E, 0x00CA,   // Ê
+  0x40, 0x00CD,   // Í
+  0x5B, 0x00C3,   // Ã
+  0x5C, 0x00D5,   // Õ
+  0x5D, 0x00DA,   // Ú
+  0x60, '~',
+  0x7B, 0x00E3,   // ã
+  0x7C, 0x00F5,   // õ
+  0x7D, '`',
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short portugueseSingle[] = {
+  0x05, 0x00EA,   // ê
+  0x09, 0x00E7,   // ç
+  0x0A, 0x000C,
+  0x0B, 0x00D4,   // Ô
+  0x0C, 0x00F4,   // ô
+  0x0E, 0x00C1,   // Á
+  0x0F, 0x00E1,   // á
+  0x12, 0x03A6,   // Φ
+  0x13, 0x0393,   // Γ
+  0x14, '^',
+  0x15, 0x03A9,   // Ω
+  0x16, 0x03A0,   // Π
+  0x17, 0x03A8,   // Ψ
+  0x18, 0x03A3,   // Σ
+  0x19, 0x0398,   // Θ
+  0x1F, 0x00CA,   // Ê
+  0x28, '{', 0x29, '}', 0x2F, '\\', 0x3C, '[', 0x3D, '~', 0x3E, ']', 0x40, '|',
+  0x41, 0x00C0,   // À
+  0x49, 0x00CD,   // Í
+  0x4F, 0x00D3,   // Ó
+  0x55, 0x00DA,   // Ú
+  0x5B, 0x00C3,   // Ã
+  0x5C, 0x00D5,   // Õ
+  0x61, 0x00C2,   // Â
+  0x65, 0x20AC,   // €
+  0x69, 0x00ED,   // í
+  0x6F, 0x00F3,   // ó
+  0x75, 0x00FA,   // ú
+  0x7B, 0x00E3,   // ã
+  0x7C, 0x00F5,   // õ
+  0x7F, 0x00E2,   // â
+  TABLE_END
+};
+
+// Indic languages and Urdu, their single shift tables hold the Latin capitals
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short bengaliLocking[] = {
+  0x00, 0x0981, 0x01, 0x0982, 0x02, 0x0983, 0x03, 0x0985, 0x04, 0x0986, 0x05, 0x0987,
+  0x06, 0x0988, 0x07, 0x0989, 0x08, 0x098A, 0x09, 0x098B, 0x0B, 0x098C, 0x0C, UNDEFINED,
+  0x0E, UNDEFINED, 0x0F, 0x098F, 0x10, 0x0990, 0x11, UNDEFINED, 0x12, UNDEFINED, 0x13, 0x0993,
+  0x14, 0x0994, 0x15, 0x0995, 0x16, 0x0996, 0x17, 0x0997, 0x18, 0x0998, 0x19, 0x0999,
+  0x1A, 0x099A, 0x1C, 0x099B, 0x1D, 0x099C, 0x1E, 0x099D, 0x1F, 0x099E, 0x22, 0x099F,
+  0x23, 0x09A0, 0x24, 0x09A1, 0x25, 0x09A2, 0x26, 0x09A3, 0x27, 0x09A4, 0x28, ')',
+  0x29, '(', 0x2A, 0x09A5, 0x2B, 0x09A6, 0x2D, 0x09A7, 0x2F, 0x09A8, 0x3C, UNDEFINED,
+  0x3D, 0x09AA, 0x3E, 0x09AB, 0x40, 0x09AC, 0x41, 0x09AD, 0x42, 0x09AE, 0x43, 0x09AF,
+  0x44, 0x09B0, 0x45, UNDEFINED, 0x46, 0x09B2, 0x47, UNDEFINED, 0x48, UNDEFINED, 0x49, UNDEFINED,
+  0x4A, 0x09B6, 0x4B, 0x09B7, 0x4C, 0x09B8, 0x4D, 0x09B9, 0x4E, 0x09BC, 0x4F, 0x09BD,
+  0x50, 0x09BE, 0x51, 0x09BF, 0x52, 0x09C0, 0x53, 0x09C1, 0x54, 0x09C2, 0x55, 0x09C3,
+  0x56, 0x09C4, 0x57, UNDEFINED, 0x58, UNDEFINED, 0x59, 0x09C7, 0x5A, 0x09C8, 0x5B, UNDEFINED,
+  0x5C, UNDEFINED, 0x5D, 0x09CB, 0x5E, 0x09CC, 0x5F, 0x09CD, 0x60, 0x09CE, 0x7B, 0x09D7,
+  0x7C, 0x09DC, 0x7D, 0x09DD, 0x7E, 0x09F0, 0x7F, 0x09F1,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short bengaliSingle[] = {
+  0x00, '@', 0x01, 0x00A3, 0x02, '$', 0x03, 0x00A5, 0x04, 0x00BF, 0x05, '"',
+  0x06, 0x00A4, 0x07, '%', 0x08, '&', 0x09, '\'', 0x0A, 0x000C, 0x0B, '*',
+  0x0C, '+', 0x0E, '-', 0x0F, '/', 0x10, '<', 0x11, '=', 0x12, '>',
+  0x13, 0x00A1, 0x14, '^', 0x15, 0x00A1, 0x16, '_', 0x17, '#', 0x18, '*',
+  0x19, 0x09E6, 0x1A, 0x09E7, 0x1C, 0x09E8, 0x1D, 0x09E9, 0x1E, 0x09EA, 0x1F, 0x09EB,
+  0x20, 0x09EC, 0x21, 0x09ED, 0x22, 0x09EE, 0x23, 0x09EF, 0x24, 0x09DF, 0x25, 0x09E0,
+  0x26, 0x09E1, 0x27, 0x09E2, 0x28, '{', 0x29, '}', 0x2A, 0x09E3, 0x2B, 0x09F2,
+  0x2C, 0x09F3, 0x2D, 0x09F4, 0x2E, 0x09F5, 0x2F, '\\', 0x30, 0x09F6, 0x31, 0x09F7,
+  0x32, 0x09F8, 0x33, 0x09F9, 0x34, 0x09FA, 0x3C, '[', 0x3D, '~', 0x3E, ']',
+  0x40, '|', 0x41, 'A', 0x42, 'B', 0x43, 'C', 0x44, 'D', 0x45, 'E',
+  0x46, 'F', 0x47, 'G', 0x48, 'H', 0x49, 'I', 0x4A, 'J', 0x4B, 'K',
+  0x4C, 'L', 0x4D, 'M', 0x4E, 'N', 0x4F, 'O', 0x50, 'P', 0x51, 'Q',
+  0x52, 'R', 0x53, 'S', 0x54, 'T', 0x55, 'U', 0x56, 'V', 0x57, 'W',
+  0x58, 'X', 0x59, 'Y', 0x5A, 'Z', 0x65, 0x20AC,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short gujaratiLocking[] = {
+  0x00, 0x0A81, 0x01, 0x0A82, 0x02, 0x0A83, 0x03, 0x0A85, 0x04, 0x0A86, 0x05, 0x0A87,
+  0x06, 0x0A88, 0x07, 0x0A89, 0x08, 0x0A8A, 0x09, 0x0A8B, 0x0B, 0x0A8C, 0x0C, 0x0A8D,
+  0x0E, UNDEFINED, 0x0F, 0x0A8F, 0x10, 0x0A90, 0x11, 0x0A91, 0x12, UNDEFINED, 0x13, 0x0A93,
+  0x14, 0x0A94, 0x15, 0x0A95, 0x16, 0x0A96, 0x17, 0x0A97, 0x18, 0x0A98, 0x19, 0x0A99,
+  0x1A, 0x0A9A, 0x1C, 0x0A9B, 0x1D, 0x0A9C, 0x1E, 0x0A9D, 0x1F, 0x0A9E, 0x22, 0x0A9F,
+  0x23, 0x0AA0, 0x24, 0x0AA1, 0x25, 0x0AA2, 0x26, 0x0AA3, 0x27, 0x0AA4, 0x28, ')',
+  0x29, '(', 0x2A, 0x0AA5, 0x2B, 0x0AA6, 0x2D, 0x0AA7, 0x2F, 0x0AA8, 0x3C, UNDEFINED,
+  0x3D, 0x0AAA, 0x3E, 0x0AAB, 0x40, 0x0AAC, 0x41, 0x0AAD, 0x42, 0x0AAE, 0x43, 0x0AAF,
+  0x44, 0x0AB0, 0x45, UNDEFINED, 0x46, 0x0AB2, 0x47, 0x0AB3, 0x48, UNDEFINED, 0x49, 0x0AB5,
+  0x4A, 0x0AB6, 0x4B, 0x0AB7, 0x4C, 0x0AB8, 0x4D, 0x0AB9, 0x4E, 0x0ABC, 0x4F, 0x0ABD,
+  0x50, 0x0ABE, 0x51, 0x0ABF, 0x52, 0x0AC0, 0x53, 0x0AC1, 0x54, 0x0AC2, 0x55, 0x0AC3,
+  0x56, 0x0AC4, 0x57, 0x0AC5, 0x58, UNDEFINED, 0x59, 0x0AC7, 0x5A, 0x0AC8, 0x5B, 0x0AC9,
+  0x5C, UNDEFINED, 0x5D, 0x0ACB, 0x5E, 0x0ACC, 0x5F, 0x0ACD, 0x60, 0x0AD0, 0x7B, 0x0AE0,
+  0x7C, 0x0AE1, 0x7D, 0x0AE2, 0x7E, 0x0AE3, 0x7F, 0x0AF1,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short gujaratiSingle[] = {
+  0x00, '@', 0x01, 0x00A3, 0x02, '$', 0x03, 0x00A5, 0x04, 0x00BF, 0x05, '"',
+  0x06, 0x00A4, 0x07, '%', 0x08, '&', 0x09, '\'', 0x0A, 0x000C, 0x0B, '*',
+  0x0C, '+', 0x0E, '-', 0x0F, '/', 0x10, '<', 0x11, '=', 0x12, '>',
+  0x13, 0x00A1, 0x14, '^', 0x15, 0x00A1, 0x16, '_', 0x17, '#', 0x18, '*',
+  0x19, 0x0964, 0x1A, 0x0965, 0x1C, 0x0AE6, 0x1D, 0x0AE7, 0x1E, 0x0AE8, 0x1F, 0x0AE9,
+  0x20, 0x0AEA, 0x21, 0x0AEB, 0x22, 0x0AEC, 0x23, 0x0AED, 0x24, 0x0AEE, 0x25, 0x0AEF,
+  0x28, '{', 0x29, '}', 0x2F, '\\', 0x3C, '[', 0x3D, '~', 0x3E, ']',
+  0x40, '|', 0x41, 'A', 0x42, 'B', 0x43, 'C', 0x44, 'D', 0x45, 'E',
+  0x46, 'F', 0x47, 'G', 0x48, 'H', 0x49, 'I', 0x4A, 'J', 0x4B, 'K',
+  0x4C, 'L', 0x4D, 'M', 0x4E, 'N', 0x4F, 'O', 0x50, 'P', 0x51, 'Q',
+  0x52, 'R', 0x53, 'S', 0x54, 'T', 0x55, 'U', 0x56, 'V', 0x57, 'W',
+  0x58, 'X', 0x59, 'Y', 0x5A, 'Z', 0x65, 0x20AC,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short hindiLocking[] = {
+  0x00, 0x0901, 0x01, 0x0902, 0x02, 0x0903, 0x03, 0x0905, 0x04, 0x0906, 0x05, 0x0907,
+  0x06, 0x0908, 0x07, 0x0909, 0x08, 0x090A, 0x09, 0x090B, 0x0B, 0x090C, 0x0C, 0x090D,
+  0x0E, 0x090E, 0x0F, 0x090F, 0x10, 0x0910, 0x11, 0x0911, 0x12, 0x0912, 0x13, 0x0913,
+  0x14, 0x0914, 0x15, 0x0915, 0x16, 0x0916, 0x17, 0x0917, 0x18, 0x0918, 0x19, 0x0919,
+  0x1A, 0x091A, 0x1C, 0x091B, 0x1D, 0x091C, 0x1E, 0x091D, 0x1F, 0x091E, 0x22, 0x091F,
+  0x23, 0x0920, 0x24, 0x0921, 0x25, 0x0922, 0x26, 0x0923, 0x27, 0x0924, 0x28, ')',
+  0x29, '(', 0x2A, 0x0925, 0x2B, 0x0926, 0x2D, 0x0927, 0x2F, 0x0928, 0x3C, 0x0929,
+  0x3D, 0x092A, 0x3E, 0x092B, 0x40, 0x092C, 0x41, 0x092D, 0x42, 0x092E, 0x43, 0x092F,
+  0x44, 0x0930, 0x45, 0x0931, 0x46, 0x0932, 0x47, 0x0933, 0x48, 0x0934, 0x49, 0x0935,
+  0x4A, 0x0936, 0x4B, 0x0937, 0x4C, 0x0938, 0x4D, 0x0939, 0x4E, 0x093C, 0x4F, 0x093D,
+  0x50, 0x093E, 0x51, 0x093F, 0x52, 0x0940, 0x53, 0x0941, 0x54, 0x0942, 0x55, 0x0943,
+  0x56, 0x0944, 0x57, 0x0945, 0x58, 0x0946, 0x59, 0x0947, 0x5A, 0x0948, 0x5B, 0x0949,
+  0x5C, 0x094A, 0x5D, 0x094B, 0x5E, 0x094C, 0x5F, 0x094D, 0x60, 0x0950, 0x7B, 0x0972,
+  0x7C, 0x097B, 0x7D, 0x097C, 0x7E, 0x097E, 0x7F, 0x097F,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short hindiSingle[] = {
+  0x00, '@', 0x01, 0x00A3, 0x02, '$', 0x03, 0x00A5, 0x04, 0x00BF, 0x05, '"',
+  0x06, 0x00A4, 0x07, '%', 0x08, '&', 0x09, '\'', 0x0A, 0x000C, 0x0B, '*',
+  0x0C, '+', 0x0E, '-', 0x0F, '/', 0x10, '<', 0x11, '=', 0x12, '>',
+  0x13, 0x00A1, 0x14, '^', 0x15, 0x00A1, 0x16, '_', 0x17, '#', 0x18, '*',
+  0x19, 0x0964, 0x1A, 0x0965, 0x1C, 0x0966, 0x1D, 0x0967, 0x1E, 0x0968, 0x1F, 0x0969,
+  0x20, 0x096A, 0x21, 0x096B, 0x22, 0x096C, 0x23, 0x096D, 0x24, 0x096E, 0x25, 0x096F,
+  0x26, 0x0951, 0x27, 0x0952, 0x28, '{', 0x29, '}', 0x2A, 0x0953, 0x2B, 0x0954,
+  0x2C, 0x0958, 0x2D, 0x0959, 0x2E, 0x095A, 0x2F, '\\', 0x30, 0x095B, 0x31, 0x095C,
+  0x32, 0x095D, 0x33, 0x095E, 0x34, 0x095F, 0x35, 0x0960, 0x36, 0x0961, 0x37, 0x0962,
+  0x38, 0x0963, 0x39, 0x0970, 0x3A, 0x0971, 0x3C, '[', 0x3D, '~', 0x3E, ']',
+  0x40, '|', 0x41, 'A', 0x42, 'B', 0x43, 'C', 0x44, 'D', 0x45, 'E',
+  0x46, 'F', 0x47, 'G', 0x48, 'H', 0x49, 'I', 0x4A, 'J', 0x4B, 'K',
+  0x4C, 'L', 0x4D, 'M', 0x4E, 'N', 0x4F, 'O', 0x50, 'P', 0x51, 'Q',
+  0x52, 'R', 0x53, 'S', 0x54, 'T', 0x55, 'U', 0x56, 'V', 0x57, 'W',
+  0x58, 'X', 0x59, 'Y', 0x5A, 'Z', 0x65, 0x20AC,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short kannadaLocking[] = {
+  0x00, UNDEFINED, 0x01, 0x0C82, 0x02, 0x0C83, 0x03, 0x0C85, 0x04, 0x0C86, 0x05, 0x0C87,
+  0x06, 0x0C88, 0x07, 0x0C89, 0x08, 0x0C8A, 0x09, 0x0C8B, 0x0B, 0x0C8C, 0x0C, UNDEFINED,
+  0x0E, 0x0C8E, 0x0F, 0x0C8F, 0x10, 0x0C90, 0x11, UNDEFINED, 0x12, 0x0C92, 0x13, 0x0C93,
+  0x14, 0x0C94, 0x15, 0x0C95, 0x16, 0x0C96, 0x17, 0x0C97, 0x18, 0x0C98, 0x19, 0x0C99,
+  0x1A, 0x0C9A, 0x1C, 0x0C9B, 0x1D, 0x0C9C, 0x1E, 0x0C9D, 0x1F, 0x0C9E, 0x22, 0x0C9F,
+  0x23, 0x0CA0, 0x24, 0x0CA1, 0x25, 0x0CA2, 0x26, 0x0CA3, 0x27, 0x0CA4, 0x28, ')',
+  0x29, '(', 0x2A, 0x0CA5, 0x2B, 0x0CA6, 0x2D, 0x0CA7, 0x2F, 0x0CA8, 0x3C, UNDEFINED,
+  0x3D, 0x0CAA, 0x3E, 0x0CAB, 0x40, 0x0CAC, 0x41, 0x0CAD, 0x42, 0x0CAE, 0x43, 0x0CAF,
+  0x44, 0x0CB0, 0x45, 0x0CB1, 0x46, 0x0CB2, 0x47, 0x0CB3, 0x48, UNDEFINED, 0x49, 0x0CB5,
+  0x4A, 0x0CB6, 0x4B, 0x0CB7, 0x4C, 0x0CB8, 0x4D, 0x0CB9, 0x4E, 0x0CBC, 0x4F, 0x0CBD,
+  0x50, 0x0CBE, 0x51, 0x0CBF, 0x52, 0x0CC0, 0x53, 0x0CC1, 0x54, 0x0CC2, 0x55, 0x0CC3,
+  0x56, 0x0CC4, 0x57, UNDEFINED, 0x58, 0x0CC6, 0x59, 0x0CC7, 0x5A, 0x0CC8, 0x5B, UNDEFINED,
+  0x5C, 0x0CCA, 0x5D, 0x0CCB, 0x5E, 0x0CCC, 0x5F, 0x0CCD, 0x60, 0x0CD5, 0x7B, 0x0CD6,
+  0x7C, 0x0CE0, 0x7D, 0x0CE1, 0x7E, 0x0CE2, 0x7F, 0x0CE3,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short kannadaSingle[] = {
+  0x00, '@', 0x01, 0x00A3, 0x02, '$', 0x03, 0x00A5, 0x04, 0x00BF, 0x05, '"',
+  0x06, 0x00A4, 0x07, '%', 0x08, '&', 0x09, '\'', 0x0A, 0x000C, 0x0B, '*',
+  0x0C, '+', 0x0E, '-', 0x0F, '/', 0x10, '<', 0x11, '=', 0x12, '>',
+  0x13, 0x00A1, 0x14, '^', 0x15, 0x00A1, 0x16, '_', 0x17, '#', 0x18, '*',
+  0x19, 0x0964, 0x1A, 0x0965, 0x1C, 0x0CE6, 0x1D, 0x0CE7, 0x1E, 0x0CE8, 0x1F, 0x0CE9,
+  0x20, 0x0CEA, 0x21, 0x0CEB, 0x22, 0x0CEC, 0x23, 0x0CED, 0x24, 0x0CEE, 0x25, 0x0CEF,
+  0x26, 0x0CDE, 0x27, 0x0CF1, 0x28, '{', 0x29, '}', 0x2A, 0x0CF2, 0x2F, '\\',
+  0x3C, '[', 0x3D, '~', 0x3E, ']', 0x40, '|', 0x41, 'A', 0x42, 'B',
+  0x43, 'C', 0x44, 'D', 0x45, 'E', 0x46, 'F', 0x47, 'G', 0x48, 'H',
+  0x49, 'I', 0x4A, 'J', 0x4B, 'K', 0x4C, 'L', 0x4D, 'M', 0x4E, 'N',
+  0x4F, 'O', 0x50, 'P', 0x51, 'Q', 0x52, 'R', 0x53, 'S', 0x54, 'T',
+  0x55, 'U', 0x56, 'V', 0x57, 'W', 0x58, 'X', 0x59, 'Y', 0x5A, 'Z',
+  0x65, 0x20AC,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short malayalamLocking[] = {
+  0x00, UNDEFINED, 0x01, 0x0D02, 0x02, 0x0D03, 0x03, 0x0D05, 0x04, 0x0D06, 0x05, 0x0D07,
+  0x06, 0x0D08, 0x07, 0x0D09, 0x08, 0x0D0A, 0x09, 0x0D0B, 0x0B, 0x0D0C, 0x0C, UNDEFINED,
+  0x0E, 0x0D0E, 0x0F, 0x0D0F, 0x10, 0x0D10, 0x11, UNDEFINED, 0x12, 0x0D12, 0x13, 0x0D13,
+  0x14, 0x0D14, 0x15, 0x0D15, 0x16, 0x0D16, 0x17, 0x0D17, 0x18, 0x0D18, 0x19, 0x0D19,
+  0x1A, 0x0D1A, 0x1C, 0x0D1B, 0x1D, 0x0D1C, 0x1E, 0x0D1D, 0x1F, 0x0D1E, 0x22, 0x0D1F,
+  0x23, 0x0D20, 0x24, 0x0D21, 0x25, 0x0D22, 0x26, 0x0D23, 0x27, 0x0D24, 0x28, ')',
+  0x29, '(', 0x2A, 0x0D25, 0x2B, 0x0D26, 0x2D, 0x0D27, 0x2F, 0x0D28, 0x3C, UNDEFINED,
+  0x3D, 0x0D2A, 0x3E, 0x0D2B, 0x40, 0x0D2C, 0x41, 0x0D2D, 0x42, 0x0D2E, 0x43, 0x0D2F,
+  0x44, 0x0D30, 0x45, 0x0D31, 0x46, 0x0D32, 0x47, 0x0D33, 0x48, 0x0D34, 0x49, 0x0D35,
+  0x4A, 0x0D36, 0x4B, 0x0D37, 0x4C, 0x0D38, 0x4D, 0x0D39, 0x4E, UNDEFINED, 0x4F, 0x0D3D,
+  0x50, 0x0D3E, 0x51, 0x0D3F, 0x52, 0x0D40, 0x53, 0x0D41, 0x54, 0x0D42, 0x55, 0x0D43,
+  0x56, 0x0D44, 0x57, UNDEFINED, 0x58, 0x0D46, 0x59, 0x0D47, 0x5A, 0x0D48, 0x5B, UNDEFINED,
+  0x5C, 0x0D4A, 0x5D, 0x0D4B, 0x5E, 0x0D4C, 0x5F, 0x0D4D, 0x60, 0x0D57, 0x7B, 0x0D60,
+  0x7C, 0x0D61, 0x7D, 0x0D62, 0x7E, 0x0D63, 0x7F, 0x0D79,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short malayalamSingle[] = {
+  0x00, '@', 0x01, 0x00A3, 0x02, '$', 0x03, 0x00A5, 0x04, 0x00BF, 0x05, '"',
+  0x06, 0x00A4, 0x07, '%', 0x08, '&', 0x09, '\'', 0x0A, 0x000C, 0x0B, '*',
+  0x0C, '+', 0x0E, '-', 0x0F, '/', 0x10, '<', 0x11, '=', 0x12, '>',
+  0x13, 0x00A1, 0x14, '^', 0x15, 0x00A1, 0x16, '_', 0x17, '#', 0x18, '*',
+  0x19, 0x0964, 0x1A, 0x0965, 0x1C, 0x0D66, 0x1D, 0x0D67, 0x1E, 0x0D68, 0x1F, 0x0D69,
+  0x20, 0x0D6A, 0x21, 0x0D6B, 0x22, 0x0D6C, 0x23, 0x0D6D, 0x24, 0x0D6E, 0x25, 0x0D6F,
+  0x26, 0x0D70, 0x27, 0x0D71, 0x28, '{', 0x29, '}', 0x2A, 0x0D72, 0x2B, 0x0D73,
+  0x2C, 0x0D74, 0x2D, 0x0D75, 0x2E, 0x0D7A, 0x2F, '\\', 0x30, 0x0D7B, 0x31, 0x0D7C,
+  0x32, 0x0D7D, 0x33, 0x0D7E, 0x34, 0x0D7F, 0x3C, '[', 0x3D, '~', 0x3E, ']',
+  0x40, '|', 0x41, 'A', 0x42, 'B', 0x43, 'C', 0x44, 'D', 0x45, 'E',
+  0x46, 'F', 0x47, 'G', 0x48, 'H', 0x49, 'I', 0x4A, 'J', 0x4B, 'K',
+  0x4C, 'L', 0x4D, 'M', 0x4E, 'N', 0x4F, 'O', 0x50, 'P', 0x51, 'Q',
+  0x52, 'R', 0x53, 'S', 0x54, 'T', 0x55, 'U', 0x56, 'V', 0x57, 'W',
+  0x58, 'X', 0x59, 'Y', 0x5A, 'Z', 0x65, 0x20AC,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short oriyaLocking[] = {
+  0x00, 0x0B01, 0x01, 0x0B02, 0x02, 0x0B03, 0x03, 0x0B05, 0x04, 0x0B06, 0x05, 0x0B07,
+  0x06, 0x0B08, 0x07, 0x0B09, 0x08, 0x0B0A, 0x09, 0x0B0B, 0x0B, 0x0B0C, 0x0C, UNDEFINED,
+  0x0E, UNDEFINED, 0x0F, 0x0B0F, 0x10, 0x0B10, 0x11, UNDEFINED, 0x12, UNDEFINED, 0x13, 0x0B13,
+  0x14, 0x0B14, 0x15, 0x0B15, 0x16, 0x0B16, 0x17, 0x0B17, 0x18, 0x0B18, 0x19, 0x0B19,
+  0x1A, 0x0B1A, 0x1C, 0x0B1B, 0x1D, 0x0B1C, 0x1E, 0x0B1D, 0x1F, 0x0B1E, 0x22, 0x0B1F,
+  0x23, 0x0B20, 0x24, 0x0B21, 0x25, 0x0B22, 0x26, 0x0B23, 0x27, 0x0B24, 0x28, ')',
+  0x29, '(', 0x2A, 0x0B25, 0x2B, 0x0B26, 0x2D, 0x0B27, 0x2F, 0x0B28, 0x3C, UNDEFINED,
+  0x3D, 0x0B2A, 0x3E, 0x0B2B, 0x40, 0x0B2C, 0x41, 0x0B2D, 0x42, 0x0B2E, 0x43, 0x0B2F,
+  0x44, 0x0B30, 0x45, UNDEFINED, 0x46, 0x0B32, 0x47, 0x0B33, 0x48, UNDEFINED, 0x49, 0x0B35,
+  0x4A, 0x0B36, 0x4B, 0x0B37, 0x4C, 0x0B38, 0x4D, 0x0B39, 0x4E, 0x0B3C, 0x4F, 0x0B3D,
+  0x50, 0x0B3E, 0x51, 0x0B3F, 0x52, 0x0B40, 0x53, 0x0B41, 0x54, 0x0B42, 0x55, 0x0B43,
+  0x56, 0x0B44, 0x57, UNDEFINED, 0x58, UNDEFINED, 0x59, 0x0B47, 0x5A, 0x0B48, 0x5B, UNDEFINED,
+  0x5C, UNDEFINED, 0x5D, 0x0B4B, 0x5E, 0x0B4C, 0x5F, 0x0B4D, 0x60, 0x0B56, 0x7B, 0x0B57,
+  0x7C, 0x0B60, 0x7D, 0x0B61, 0x7E, 0x0B62, 0x7F, 0x0B63,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short oriyaSingle[] = {
+  0x00, '@', 0x01, 0x00A3, 0x02, '$', 0x03, 0x00A5, 0x04, 0x00BF, 0x05, '"',
+  0x06, 0x00A4, 0x07, '%', 0x08, '&', 0x09, '\'', 0x0A, 0x000C, 0x0B, '*',
+  0x0C, '+', 0x0E, '-', 0x0F, '/', 0x10, '<', 0x11, '=', 0x12, '>',
+  0x13, 0x00A1, 0x14, '^', 0x15, 0x00A1, 0x16, '_', 0x17, '#', 0x18, '*',
+  0x19, 0x0964, 0x1A, 0x0965, 0x1C, 0x0B66, 0x1D, 0x0B67, 0x1E, 0x0B68, 0x1F, 0x0B69,
+  0x20, 0x0B6A, 0x21, 0x0B6B, 0x22, 0x0B6C, 0x23, 0x0B6D, 0x24, 0x0B6E, 0x25, 0x0B6F,
+  0x26, 0x0B5C, 0x27, 0x0B5D, 0x28, '{', 0x29, '}', 0x2A, 0x0B5F, 0x2B, 0x0B70,
+  0x2C, 0x0B71, 0x2F, '\\', 0x3C, '[', 0x3D, '~', 0x3E, ']', 0x40, '|',
+  0x41, 'A', 0x42, 'B', 0x43, 'C', 0x44, 'D', 0x45, 'E', 0x46, 'F',
+  0x47, 'G', 0x48, 'H', 0x49, 'I', 0x4A, 'J', 0x4B, 'K', 0x4C, 'L',
+  0x4D, 'M', 0x4E, 'N', 0x4F, 'O', 0x50, 'P', 0x51, 'Q', 0x52, 'R',
+  0x53, 'S', 0x54, 'T', 0x55, 'U', 0x56, 'V', 0x57, 'W', 0x58, 'X',
+  0x59, 'Y', 0x5A, 'Z', 0x65, 0x20AC,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short punjabiLocking[] = {
+  0x00, 0x0A01, 0x01, 0x0A02, 0x02, 0x0A03, 0x03, 0x0A05, 0x04, 0x0A06, 0x05, 0x0A07,
+  0x06, 0x0A08, 0x07, 0x0A09, 0x08, 0x0A0A, 0x09, UNDEFINED, 0x0B, UNDEFINED, 0x0C, UNDEFINED,
+  0x0E, UNDEFINED, 0x0F, 0x0A0F, 0x10, 0x0A10, 0x11, UNDEFINED, 0x12, UNDEFINED, 0x13, 0x0A13,
+  0x14, 0x0A14, 0x15, 0x0A15, 0x16, 0x0A16, 0x17, 0x0A17, 0x18, 0x0A18, 0x19, 0x0A19,
+  0x1A, 0x0A1A, 0x1C, 0x0A1B, 0x1D, 0x0A1C, 0x1E, 0x0A1D, 0x1F, 0x0A1E, 0x22, 0x0A1F,
+  0x23, 0x0A20, 0x24, 0x0A21, 0x25, 0x0A22, 0x26, 0x0A23, 0x27, 0x0A24, 0x28, ')',
+  0x29, '(', 0x2A, 0x0A25, 0x2B, 0x0A26, 0x2D, 0x0A27, 0x2F, 0x0A28, 0x3C, UNDEFINED,
+  0x3D, 0x0A2A, 0x3E, 0x0A2B, 0x40, 0x0A2C, 0x41, 0x0A2D, 0x42, 0x0A2E, 0x43, 0x0A2F,
+  0x44, 0x0A30, 0x45, UNDEFINED, 0x46, 0x0A32, 0x47, 0x0A33, 0x48, UNDEFINED, 0x49, 0x0A35,
+  0x4A, 0x0A36, 0x4B, UNDEFINED, 0x4C, 0x0A38, 0x4D, 0x0A39, 0x4E, 0x0A3C, 0x4F, UNDEFINED,
+  0x50, 0x0A3E, 0x51, 0x0A3F, 0x52, 0x0A40, 0x53, 0x0A41, 0x54, 0x0A42, 0x55, UNDEFINED,
+  0x56, UNDEFINED, 0x57, UNDEFINED, 0x58, UNDEFINED, 0x59, 0x0A47, 0x5A, 0x0A48, 0x5B, UNDEFINED,
+  0x5C, UNDEFINED, 0x5D, 0x0A4B, 0x5E, 0x0A4C, 0x5F, 0x0A4D, 0x60, 0x0A51, 0x7B, 0x0A70,
+  0x7C, 0x0A71, 0x7D, 0x0A72, 0x7E, 0x0A73, 0x7F, 0x0A74,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short punjabiSingle[] = {
+  0x00, '@', 0x01, 0x00A3, 0x02, '$', 0x03, 0x00A5, 0x04, 0x00BF, 0x05, '"',
+  0x06, 0x00A4, 0x07, '%', 0x08, '&', 0x09, '\'', 0x0A, 0x000C, 0x0B, '*',
+  0x0C, '+', 0x0E, '-', 0x0F, '/', 0x10, '<', 0x11, '=', 0x12, '>',
+  0x13, 0x00A1, 0x14, '^', 0x15, 0x00A1, 0x16, '_', 0x17, '#', 0x18, '*',
+  0x19, 0x0964, 0x1A, 0x0965, 0x1C, 0x0A66, 0x1D, 0x0A67, 0x1E, 0x0A68, 0x1F, 0x0A69,
+  0x20, 0x0A6A, 0x21, 0x0A6B, 0x22, 0x0A6C, 0x23, 0x0A6D, 0x24, 0x0A6E, 0x25, 0x0A6F,
+  0x26, 0x0A59, 0x27, 0x0A5A, 0x28, '{', 0x29, '}', 0x2A, 0x0A5B, 0x2B, 0x0A5C,
+  0x2C, 0x0A5E, 0x2D, 0x0A75, 0x2F, '\\', 0x3C, '[', 0x3D, '~', 0x3E, ']',
+  0x40, '|', 0x41, 'A', 0x42, 'B', 0x43, 'C', 0x44, 'D', 0x45, 'E',
+  0x46, 'F', 0x47, 'G', 0x48, 'H', 0x49, 'I', 0x4A, 'J', 0x4B, 'K',
+  0x4C, 'L', 0x4D, 'M', 0x4E, 'N', 0x4F, 'O', 0x50, 'P', 0x51, 'Q',
+  0x52, 'R', 0x53, 'S', 0x54, 'T', 0x55, 'U', 0x56, 'V', 0x57, 'W',
+  0x58, 'X', 0x59, 'Y', 0x5A, 'Z', 0x65, 0x20AC,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short tamilLocking[] = {
+  0x00, UNDEFINED, 0x01, 0x0B82, 0x02, 0x0B83, 0x03, 0x0B85, 0x04, 0x0B86, 0x05, 0x0B87,
+  0x06, 0x0B88, 0x07, 0x0B89, 0x08, 0x0B8A, 0x09, UNDEFINED, 0x0B, UNDEFINED, 0x0C, UNDEFINED,
+  0x0E, 0x0B8E, 0x0F, 0x0B8F, 0x10, 0x0B90, 0x11, UNDEFINED, 0x12, 0x0B92, 0x13, 0x0B93,
+  0x14, 0x0B94, 0x15, 0x0B95, 0x16, UNDEFINED, 0x17, UNDEFINED, 0x18, UNDEFINED, 0x19, 0x0B99,
+  0x1A, 0x0B9A, 0x1C, UNDEFINED, 0x1D, 0x0B9C, 0x1E, UNDEFINED, 0x1F, 0x0B9E, 0x22, 0x0B9F,
+  0x23, UNDEFINED, 0x24, UNDEFINED, 0x25, UNDEFINED, 0x26, 0x0BA3, 0x27, 0x0BA4, 0x28, ')',
+  0x29, '(', 0x2A, UNDEFINED, 0x2B, UNDEFINED, 0x2D, UNDEFINED, 0x2F, 0x0BA8, 0x3C, 0x0BA9,
+  0x3D, 0x0BAA, 0x3E, UNDEFINED, 0x40, UNDEFINED, 0x41, UNDEFINED, 0x42, 0x0BAE, 0x43, 0x0BAF,
+  0x44, 0x0BB0, 0x45, 0x0BB1, 0x46, 0x0BB2, 0x47, 0x0BB3, 0x48, 0x0BB4, 0x49, 0x0BB5,
+  0x4A, 0x0BB6, 0x4B, 0x0BB7, 0x4C, 0x0BB8, 0x4D, 0x0BB9, 0x4E, UNDEFINED, 0x4F, UNDEFINED,
+  0x50, 0x0BBE, 0x51, 0x0BBF, 0x52, 0x0BC0, 0x53, 0x0BC1, 0x54, 0x0BC2, 0x55, UNDEFINED,
+  0x56, UNDEFINED, 0x57, UNDEFINED, 0x58, 0x0BC6, 0x59, 0x0BC7, 0x5A, 0x0BC8, 0x5B, UNDEFINED,
+  0x5C, 0x0BCA, 0x5D, 0x0BCB, 0x5E, 0x0BCC, 0x5F, 0x0BCD, 0x60, 0x0BD0, 0x7B, 0x0BD7,
+  0x7C, 0x0BF0, 0x7D, 0x0BF1, 0x7E, 0x0BF2, 0x7F, 0x0BF9,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short tamilSingle[] = {
+  0x00, '@', 0x01, 0x00A3, 0x02, '$', 0x03, 0x00A5, 0x04, 0x00BF, 0x05, '"',
+  0x06, 0x00A4, 0x07, '%', 0x08, '&', 0x09, '\'', 0x0A, 0x000C, 0x0B, '*',
+  0x0C, '+', 0x0E, '-', 0x0F, '/', 0x10, '<', 0x11, '=', 0x12, '>',
+  0x13, 0x00A1, 0x14, '^', 0x15, 0x00A1, 0x16, '_', 0x17, '#', 0x18, '*',
+  0x19, 0x0964, 0x1A, 0x0965, 0x1C, 0x0BE6, 0x1D, 0x0BE7, 0x1E, 0x0BE8, 0x1F, 0x0BE9,
+  0x20, 0x0BEA, 0x21, 0x0BEB, 0x22, 0x0BEC, 0x23, 0x0BED, 0x24, 0x0BEE, 0x25, 0x0BEF,
+  0x26, 0x0BF3, 0x27, 0x0BF4, 0x28, '{', 0x29, '}', 0x2A, 0x0BF5, 0x2B, 0x0BF6,
+  0x2C, 0x0BF7, 0x2D, 0x0BF8, 0x2E, 0x0BFA, 0x2F, '\\', 0x3C, '[', 0x3D, '~',
+  0x3E, ']', 0x40, '|', 0x41, 'A', 0x42, 'B', 0x43, 'C', 0x44, 'D',
+  0x45, 'E', 0x46, 'F', 0x47, 'G', 0x48, 'H', 0x49, 'I', 0x4A, 'J',
+  0x4B, 'K', 0x4C, 'L', 0x4D, 'M', 0x4E, 'N', 0x4F, 'O', 0x50, 'P',
+  0x51, 'Q', 0x52, 'R', 0x53, 'S', 0x54, 'T', 0x55, 'U', 0x56, 'V',
+  0x57, 'W', 0x58, 'X', 0x59, 'Y', 0x5A, 'Z', 0x65, 0x20AC,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short teluguLocking[] = {
+  0x00, 0x0C01, 0x01, 0x0C02, 0x02, 0x0C03, 0x03, 0x0C05, 0x04, 0x0C06, 0x05, 0x0C07,
+  0x06, 0x0C08, 0x07, 0x0C09, 0x08, 0x0C0A, 0x09, 0x0C0B, 0x0B, 0x0C0C, 0x0C, UNDEFINED,
+  0x0E, 0x0C0E, 0x0F, 0x0C0F, 0x10, 0x0C10, 0x11, UNDEFINED, 0x12, 0x0C12, 0x13, 0x0C13,
+  0x14, 0x0C14, 0x15, 0x0C15, 0x16, 0x0C16, 0x17, 0x0C17, 0x18, 0x0C18, 0x19, 0x0C19,
+  0x1A, 0x0C1A, 0x1C, 0x0C1B, 0x1D, 0x0C1C, 0x1E, 0x0C1D, 0x1F, 0x0C1E, 0x22, 0x0C1F,
+  0x23, 0x0C20, 0x24, 0x0C21, 0x25, 0x0C22, 0x26, 0x0C23, 0x27, 0x0C24, 0x28, ')',
+  0x29, '(', 0x2A, 0x0C25, 0x2B, 0x0C26, 0x2D, 0x0C27, 0x2F, 0x0C28, 0x3C, UNDEFINED,
+  0x3D, 0x0C2A, 0x3E, 0x0C2B, 0x40, 0x0C2C, 0x41, 0x0C2D, 0x42, 0x0C2E, 0x43, 0x0C2F,
+  0x44, 0x0C30, 0x45, 0x0C31, 0x46, 0x0C32, 0x47, 0x0C33, 0x48, UNDEFINED, 0x49, 0x0C35,
+  0x4A, 0x0C36, 0x4B, 0x0C37, 0x4C, 0x0C38, 0x4D, 0x0C39, 0x4E, UNDEFINED, 0x4F, 0x0C3D,
+  0x50, 0x0C3E, 0x51, 0x0C3F, 0x52, 0x0C40, 0x53, 0x0C41, 0x54, 0x0C42, 0x55, 0x0C43,
+  0x56, 0x0C44, 0x57, UNDEFINED, 0x58, 0x0C46, 0x59, 0x0C47, 0x5A, 0x0C48, 0x5B, UNDEFINED,
+  0x5C, 0x0C4A, 0x5D, 0x0C4B, 0x5E, 0x0C4C, 0x5F, 0x0C4D, 0x60, 0x0C55, 0x7B, 0x0C56,
+  0x7C, 0x0C60, 0x7D, 0x0C61, 0x7E, 0x0C62, 0x7F, 0x0C63,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short teluguSingle[] = {
+  0x00, '@', 0x01, 0x00A3, 0x02, '$', 0x03, 0x00A5, 0x04, 0x00BF, 0x05, '"',
+  0x06, 0x00A4, 0x07, '%', 0x08, '&', 0x09, '\'', 0x0A, 0x000C, 0x0B, '*',
+  0x0C, '+', 0x0E, '-', 0x0F, '/', 0x10, '<', 0x11, '=', 0x12, '>',
+  0x13, 0x00A1, 0x14, '^', 0x15, 0x00A1, 0x16, '_', 0x17, '#', 0x18, '*',
+  0x1C, 0x0C66, 0x1D, 0x0C67, 0x1E, 0x0C68, 0x1F, 0x0C69, 0x20, 0x0C6A, 0x21, 0x0C6B,
+  0x22, 0x0C6C, 0x23, 0x0C6D, 0x24, 0x0C6E, 0x25, 0x0C6F, 0x26, 0x0C58, 0x27, 0x0C59,
+  0x28, '{', 0x29, '}', 0x2A, 0x0C78, 0x2B, 0x0C79, 0x2C, 0x0C7A, 0x2D, 0x0C7B,
+  0x2E, 0x0C7C, 0x2F, '\\', 0x30, 0x0C7D, 0x31, 0x0C7E, 0x32, 0x0C7F, 0x3C, '[',
+  0x3D, '~', 0x3E, ']', 0x40, '|', 0x41, 'A', 0x42, 'B', 0x43, 'C',
+  0x44, 'D', 0x45, 'E', 0x46, 'F', 0x47, 'G', 0x48, 'H', 0x49, 'I',
+  0x4A, 'J', 0x4B, 'K', 0x4C, 'L', 0x4D, 'M', 0x4E, 'N', 0x4F, 'O',
+  0x50, 'P', 0x51, 'Q', 0x52, 'R', 0x53, 'S', 0x54, 'T', 0x55, 'U',
+  0x56, 'V', 0x57, 'W', 0x58, 'X', 0x59, 'Y', 0x5A, 'Z', 0x65, 0x20AC,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short urduLocking[] = {
+  0x00, 0x0627, 0x01, 0x0622, 0x02, 0x0628, 0x03, 0x067B, 0x04, 0x0680, 0x05, 0x067E,
+  0x06, 0x06A6, 0x07, 0x062A, 0x08, 0x06C2, 0x09, 0x067F, 0x0B, 0x0679, 0x0C, 0x067D,
+  0x0E, 0x067A, 0x0F, 0x067C, 0x10, 0x062B, 0x11, 0x062C, 0x12, 0x0681, 0x13, 0x0684,
+  0x14, 0x0683, 0x15, 0x0685, 0x16, 0x0686, 0x17, 0x0687, 0x18, 0x062D, 0x19, 0x062E,
+  0x1A, 0x062F, 0x1C, 0x068C, 0x1D, 0x0688, 0x1E, 0x0689, 0x1F, 0x068A, 0x22, 0x068F,
+  0x23, 0x068D, 0x24, 0x0630, 0x25, 0x0631, 0x26, 0x0691, 0x27, 0x0693, 0x28, ')',
+  0x29, '(', 0x2A, 0x0699, 0x2B, 0x0632, 0x2D, 0x0696, 0x2F, 0x0698, 0x3C, 0x069A,
+  0x3D, 0x0633, 0x3E, 0x0634, 0x40, 0x0635, 0x41, 0x0636, 0x42, 0x0637, 0x43, 0x0638,
+  0x44, 0x0639, 0x45, 0x0641, 0x46, 0x0642, 0x47, 0x06A9, 0x48, 0x06AA, 0x49, 0x06AB,
+  0x4A, 0x06AF, 0x4B, 0x06B3, 0x4C, 0x06B1, 0x4D, 0x0644, 0x4E, 0x0645, 0x4F, 0x0646,
+  0x50, 0x06BA, 0x51, 0x06BB, 0x52, 0x06BC, 0x53, 0x0648, 0x54, 0x06C4, 0x55, 0x06D5,
+  0x56, 0x06C1, 0x57, 0x06BE, 0x58, 0x0621, 0x59, 0x06CC, 0x5A, 0x06D0, 0x5B, 0x06D2,
+  0x5C, 0x064D, 0x5D, 0x0650, 0x5E, 0x064F, 0x5F, 0x0657, 0x60, 0x0654, 0x7B, 0x0655,
+  0x7C, 0x0651, 0x7D, 0x0653, 0x7E, 0x0656, 0x7F, 0x0670,
+  TABLE_END
+};
+
+static const
+#ifdef PM
+      PROGMEM
+#endif
+unsigned short urduSingle[] = {
+  0x00, '@', 0x01, 0x00A3, 0x02, '$', 0x03, 0x00A5, 0x04, 0x00BF, 0x05, '"',
+  0x06, 0x00A4, 0x07, '%', 0x08, '&', 0x09, '\'', 0x0A, 0x000C, 0x0B, '*',
+  0x0C, '+', 0x0E, '-', 0x0F, '/', 0x10, '<', 0x11, '=', 0x12, '>',
+  0x13, 0x00A1, 0x14, '^', 0x15, 0x00A1, 0x16, '_', 0x17, '#', 0x18, '*',
+  0x19, 0x0600, 0x1A, 0x0601, 0x1C, 0x06F0, 0x1D, 0x06F1, 0x1E, 0x06F2, 0x1F, 0x06F3,
+  0x20, 0x06F4, 0x21, 0x06F5, 0x22, 0x06F6, 0x23, 0x06F7, 0x24, 0x06F8, 0x25, 0x06F9,
+  0x26, 0x060C, 0x27, 0x060D, 0x28, '{', 0x29, '}', 0x2A, 0x060E, 0x2B, 0x060F,
+  0x2C, 0x0610, 0x2D, 0x0611, 0x2E, 0x0612, 0x2F, '\\', 0x30, 0x0613, 0x31, 0x0614,
+  0x32, 0x061B, 0x33, 0x061F, 0x34, 0x0640, 0x35, 0x0652, 0x36, 0x0658, 0x37, 0x066B,
+  0x38, 0x066C, 0x39, 0x0672, 0x3A, 0x0673, 0x3B, 0x06CD, 0x3C, '[', 0x3D, '~',
+  0x3E, ']', 0x3F, 0x06D4, 0x40, '|', 0x41, 'A', 0x42, 'B', 0x43, 'C',
+  0x44, 'D', 0x45, 'E', 0x46, 'F', 0x47, 'G', 0x48, 'H', 0x49, 'I',
+  0x4A, 'J', 0x4B, 'K', 0x4C, 'L', 0x4D, 'M', 0x4E, 'N', 0x4F, 'O',
+  0x50, 'P', 0x51, 'Q', 0x52, 'R', 0x53, 'S', 0x54, 'T', 0x55, 'U',
+  0x56, 'V', 0x57, 'W', 0x58, 'X', 0x59, 'Y', 0x5A, 'Z', 0x65, 0x20AC,
+  TABLE_END
+};
+// indexed by eNationalLanguage, NULL if the language has no such table
+static const unsigned short *const lockingTables[NATIONAL_LANGUAGES] = {
+  NULL, turkishLocking, NULL, portugueseLocking, bengaliLocking, gujaratiLocking, hindiLocking,
+  kannadaLocking, malayalamLocking, oriyaLocking, punjabiLocking, tamilLocking, teluguLocking, urduLocking
+};
+static const unsigned short *const singleTables[NATIONAL_LANGUAGES] = {
+  defaultSingle, turkishSingle, spanishSingle, portugueseSingle, bengaliSingle, gujaratiSingle, hindiSingle,
+  kannadaSingle, malayalamSingle, oriyaSingle, punjabiSingle, tamilSingle, teluguSingle, urduSingle
+};
+
+static inline unsigned short tableWord(const unsigned short *table, int i) {
+#ifdef PM
+  return pgm_read_word_near(table + i);
+#else
+  return table[i];
+#endif
+}
+
+// codepoint of a septet, -1 if the table does not have it
+static long findSeptet(const unsigned short *table, unsigned char septet) {
+  for (int i = 0; tableWord(table, i) != TABLE_END; i += 2)
+    if (tableWord(table, i) == septet)
+      return tableWord(table, i + 1);
+  return -1;
+}
+
+// septet of a codepoint, -1 if the table does not have it
+static int findCodepoint(const unsigned short *table, unsigned long cp) {
+  for (int i = 0; tableWord(table, i) != TABLE_END; i += 2)
+    if (tableWord(table, i + 1) == cp)
+      return tableWord(table, i);
+  return -1;
+}
+
+static const unsigned short *lockingTable(int language) {
+  return language > 0 && language < NATIONAL_LANGUAGES ? lockingTables[language] : NULL;
+}
+
+static const unsigned short *singleTable(int language) {
+  return language >= 0 && language < NATIONAL_LANGUAGES ? singleTables[language] : NULL;
+}
+
+// bit n set if any table, or the default alphabet, has a character U+nn00 to U+nnFF
+static unsigned long long tablePages() {
+  unsigned long long pages = 1ull | 1ull << 0x03 | 1ull << 0x20;   // Latin-1, Greek, €
+  for (int language = 0; language < NATIONAL_LANGUAGES; language++) {
+    const unsigned short *tables[2] = {lockingTables[language], singleTables[language]};
+    for (int t = 0; t < 2; t++)
+      for (int i = 0; tables[t] != NULL && tableWord(tables[t], i) != TABLE_END; i += 2)
+        if (tableWord(tables[t], i + 1) != UNDEFINED)
+          pages |= 1ull << (tableWord(tables[t], i + 1) >> 8);
+  }
+  return pages;
+}
+
+// bit n set if the locking shift table of language n replaces the septet of a plain ASCII character
+static unsigned movedAscii() {
+  unsigned moved = 0;
+  for (int language = 0; language < NATIONAL_LANGUAGES; language++)
+    for (char c = 0; lockingTables[language] != NULL && c < 0x7f; c++)
+      if (pduAsciiRun(&c, 1, ASCII_KERNEL_SCALAR) == 1 && findSeptet(lockingTables[language], pduGsm7Septet(c)) >= 0)
+        moved |= NATIONAL_MASK(language);
+  return moved;
+}
+
+// worked out once at load time, lets most characters of other scripts skip the table searches
+static const unsigned long long pages = tablePages();
+static const unsigned asciiMoved = movedAscii();
+
+bool pduNationalHasLocking(int language) {
+  return lockingTable(language) != NULL;
+}
+
+bool pduNationalHasSingle(int language) {
+  return language != NATIONAL_DEFAULT && singleTable(language) != NULL;
+}
+
+bool pduNationalKeepsAscii(int locking) {
+  return lockingTable(locking) == NULL || (asciiMoved & NATIONAL_MASK(locking)) == 0;
+}
+
+int pduNationalSeptet(unsigned long cp, int locking, int single) {
+  if (locking == NATIONAL_DEFAULT && single == NATIONAL_DEFAULT)
+    return pduGsm7Septet(cp);
+  if (cp >= 64 * 256 || (pages & 1ull << (cp >> 8)) == 0)
+    return -1;    // also never matches UNDEFINED
+  const unsigned short *table = lockingTable(locking);
+  int septet;
+  if (table != NULL && (septet = findCodepoint(table, cp)) >= 0)
+    return septet;
+  // the default alphabet, less what the locking shift table has replaced
+  septet = pduGsm7Septet(cp);
+  if (septet >= 0 && septet < 256 && (table == NULL || findSeptet(table, septet) < 0))
+    return septet;
+  table = singleTable(single);
+  if (table != NULL && (septet = findCodepoint(table, cp)) >= 0)
+    return 256 + septet;
+  return -1;
+}
+
+long pduNationalChar(unsigned char septet, bool escaped, int locking, int single) {
+  const unsigned short *table;
+  long cp;
+  if (escaped) {
+    table = singleTable(single);
+    if (table == NULL)
+      table = defaultSingle;    // unknown language
+    if ((cp = findSeptet(table, septet)) >= 0)
+      return cp;
+    // not defined, shown as the character of the locking shift table
+  }
+  table = lockingTable(locking);
+  if (table != NULL && (cp = findSeptet(table, septet)) >= 0)
+    return cp == UNDEFINED ? ' ' : cp;
+  return -1;
+}
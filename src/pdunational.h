@@ -0,0 +1,75 @@
+/**
+ * @file pdunational.h
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief GSM 7 bit national language single and locking shift tables
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ * @
+ */
+
+#ifdef PDU_NATIONAL_INCLUDE
+#else
+#define PDU_NATIONAL_INCLUDE
+
+// national language identifiers, 3GPP TS 23.038 6.2.1.2.4
+enum eNationalLanguage {
+  NATIONAL_DEFAULT,       // GSM 7 bit default alphabet and extension table
+  NATIONAL_TURKISH,       // locking and single shift tables
+  NATIONAL_SPANISH,       // single shift table only
+  NATIONAL_PORTUGUESE,    // locking and single shift tables
+  // the rest have both, their locking shift tables replace the Latin capitals
+  NATIONAL_BENGALI,
+  NATIONAL_GUJARATI,
+  NATIONAL_HINDI,
+  NATIONAL_KANNADA,
+  NATIONAL_MALAYALAM,
+  NATIONAL_ORIYA,
+  NATIONAL_PUNJABI,
+  NATIONAL_TAMIL,
+  NATIONAL_TELUGU,
+  NATIONAL_URDU
+};
+#define NATIONAL_LANGUAGES 14
+// bit masks of the languages the encoder may use
+#define NATIONAL_MASK(language) (1u << (language))
+#define NATIONAL_ALL (NATIONAL_MASK(NATIONAL_LANGUAGES) - 1 - NATIONAL_MASK(NATIONAL_DEFAULT))
+
+/**
+ * @brief Check if a language has a locking shift table
+ */
+bool pduNationalHasLocking(int language);
+/**
+ * @brief Check if a language has a single shift table
+ */
+bool pduNationalHasSingle(int language);
+/**
+ * @brief Check if a locking shift table leaves every plain ASCII character (see <b>pduAsciiRun</b>)
+ * at its septet of the default alphabet, so a run of them costs 1 septet each.
+ * True for a language without a locking shift table.
+ */
+bool pduNationalKeepsAscii(int locking);
+/**
+ * @brief Look up a Unicode codepoint, exact matches only.
+ * With both languages NATIONAL_DEFAULT this is the same as <b>pduGsm7Septet</b>.
+ *
+ * @param cp The codepoint
+ * @param locking Language of the locking shift table, replaces the default alphabet
+ * @param single Language of the single shift table, replaces the extension table
+ * @return int The septet, 256 + septet for a character of the single shift table (sent after ESC), -1 if in neither
+ */
+int pduNationalSeptet(unsigned long cp, int locking, int single);
+/**
+ * @brief Look up a received septet in the national tables.
+ * Anything not in them, including an unknown language, comes from the default alphabet.
+ *
+ * @param septet The septet, after the ESC if escaped
+ * @param escaped The septet followed an ESC
+ * @param locking Language of the locking shift table
+ * @param single Language of the single shift table
+ * @return long The codepoint, -1 if the default alphabet character for septet applies
+ */
+long pduNationalChar(unsigned char septet, bool escaped, int locking, int single);
+
+#endif
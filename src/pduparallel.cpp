@@ -0,0 +1,212 @@
+/**
+ * @file pduparallel.cpp
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief Decode large batches of PDUs on several threads
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * A batch is decoded in 2 parallel phases. In the first each chunk is decoded
+ * into the caller's columns, which are written at disjoint indexes, with the
+ * texts going to the arena of the worker. Then the caller's thread lays out the
+ * texts in the caller's arena in order, and in the second phase the texts are
+ * copied there.
+ * The chunks of each worker are a range held in a single atomic word. The owner
+ * takes from the front, others steal from the back, both with compare and swap.
+ */
+
+#ifndef ARDUINO
+
+#include <string.h>
+#include <pduparallel.h>
+
+#define RANGE(begin, end) ((unsigned long long)(begin) | ((unsigned long long)(end) << 32))
+
+PDUParallelDecoder::PDUParallelDecoder(int threads) {
+  if (threads <= 0)
+    threads = std::thread::hardware_concurrency();
+  if (threads <= 0)
+    threads = 1;
+  job = 0;
+  running = 0;
+  stop = false;
+  for (int i = 0; i < threads; i++) {
+    workers.emplace_back(new Worker);
+    workers[i]->used = 0;
+    workers[i]->chunks = 0;
+  }
+  // the caller's thread is worker 0
+  for (int i = 1; i < threads; i++)
+    pool.emplace_back(&PDUParallelDecoder::threadLoop, this, i);
+}
+
+PDUParallelDecoder::~PDUParallelDecoder() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  start.notify_all();
+  for (auto &t : pool)
+    t.join();
+}
+
+int PDUParallelDecoder::threads() {
+  return workers.size();
+}
+
+void PDUParallelDecoder::threadLoop(int id) {
+  unsigned long seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      start.wait(lock, [&] { return stop || job != seen; });
+      if (stop)
+        return;
+      seen = job;
+    }
+    work(id);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--running == 0)
+        done.notify_one();
+    }
+  }
+}
+
+// share the chunks out equally and run a phase on all workers until no chunks are left
+void PDUParallelDecoder::runPhase(ePhase p) {
+  int chunks = (count + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK;
+  int n = workers.size();
+  phase = p;
+  for (int i = 0; i < n; i++)
+    workers[i]->chunks.store(RANGE((long long)chunks * i / n, (long long)chunks * (i + 1) / n));
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    running = pool.size();
+    job++;
+  }
+  start.notify_all();
+  work(0);
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [&] { return running == 0; });
+}
+
+void PDUParallelDecoder::work(int id) {
+  int chunk;
+  while ((chunk = takeChunk(id)) >= 0) {
+    if (phase == PHASE_DECODE)
+      decodeChunk(chunk, workers[id].get(), id);
+    else
+      copyChunk(chunk);
+  }
+}
+
+// next chunk from the front of our own range, else from the back of another's, -1 when none left
+int PDUParallelDecoder::takeChunk(int id) {
+  int n = workers.size();
+  for (int i = 0; i < n; i++) {
+    std::atomic<unsigned long long> &range = workers[(id + i) % n]->chunks;
+    unsigned long long r = range.load();
+    for (;;) {
+      unsigned int begin = r & 0xffffffff;
+      unsigned int end = r >> 32;
+      if (begin >= end)
+        break;
+      if (i == 0) {
+        if (range.compare_exchange_weak(r, RANGE(begin + 1, end)))
+          return begin;
+      }
+      else if (range.compare_exchange_weak(r, RANGE(begin, end - 1)))
+        return end - 1;
+    }
+  }
+  return -1;
+}
+
+template <typename T>
+static T *column(T *p, int i) {
+  return p ? p + i : NULL;
+}
+
+void PDUParallelDecoder::decodeChunk(int chunk, Worker *w, int id) {
+  int first = chunk * PARALLEL_CHUNK;
+  int last = first + PARALLEL_CHUNK < count ? first + PARALLEL_CHUNK : count;
+  PDUBatch sub;
+  sub.status = &status[first];
+  sub.sca = column(batch->sca, first);
+  sub.sender = column(batch->sender, first);
+  sub.timeStamp = column(batch->timeStamp, first);
+  sub.dcs = column(batch->dcs, first);
+  sub.udhIei = column(batch->udhIei, first);
+  sub.udhNumber = column(batch->udhNumber, first);
+  sub.udhTotal = column(batch->udhTotal, first);
+  sub.udhPart = column(batch->udhPart, first);
+  sub.textOffset = &localOffset[first];
+  sub.textLength = &textLength[first];
+  sub.arena = NULL;
+  if (batch->arena) {
+    // room for the longest possible text of every PDU in the chunk
+    size_t need = w->used + (size_t)(last - first) * MAX_TEXT_LENGTH;
+    if (w->arena.size() < need)
+      w->arena.resize(need * 2);
+    sub.arena = w->arena.data();
+    sub.arenaSize = w->arena.size();
+    sub.arenaUsed = w->used;
+  }
+  w->pdu.decodeBatch(&pdus[first], last - first, &sub);
+  if (batch->arena)
+    w->used = sub.arenaUsed;
+  for (int i = first; i < last; i++)
+    owner[i] = id;
+}
+
+void PDUParallelDecoder::copyChunk(int chunk) {
+  int first = chunk * PARALLEL_CHUNK;
+  int last = first + PARALLEL_CHUNK < count ? first + PARALLEL_CHUNK : count;
+  for (int i = first; i < last; i++) {
+    if (batch->status)
+      batch->status[i] = status[i];
+    if (batch->textOffset)
+      batch->textOffset[i] = offset[i];
+    if (batch->textLength)
+      batch->textLength[i] = status[i] == BATCH_OK ? textLength[i] : 0;
+    if (status[i] == BATCH_OK && batch->arena)
+      memcpy(&batch->arena[offset[i]], &workers[owner[i]]->arena[localOffset[i]], textLength[i] + 1);
+  }
+}
+
+int PDUParallelDecoder::decode(const char *const *in, int n, PDUBatch *b) {
+  int ok = 0;
+  if (n <= 0)
+    return 0;
+  pdus = in;
+  count = n;
+  batch = b;
+  status.resize(n);
+  localOffset.resize(n);
+  textLength.resize(n);
+  owner.resize(n);
+  offset.resize(n);
+  for (auto &w : workers)
+    w->used = 0;
+  runPhase(PHASE_DECODE);
+  // lay out the texts in order, as decodeBatch would have
+  for (int i = 0; i < n; i++) {
+    offset[i] = batch->arenaUsed;
+    if (status[i] != BATCH_OK)
+      continue;
+    if (batch->arena) {
+      if (batch->arenaSize - batch->arenaUsed <= textLength[i]) {
+        status[i] = BATCH_ARENA_FULL;
+        continue;
+      }
+      batch->arenaUsed += textLength[i] + 1;
+    }
+    ok++;
+  }
+  runPhase(PHASE_COPY);
+  return ok;
+}
+
+#endif
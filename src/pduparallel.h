@@ -0,0 +1,95 @@
+/**
+ * @file pduparallel.h
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief Decode large batches of PDUs on several threads
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ * @
+ */
+
+#ifdef PDU_PARALLEL_INCLUDE
+#else
+#define PDU_PARALLEL_INCLUDE
+
+// needs threads, not built for Arduino
+#ifndef ARDUINO
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <pdulib.h>
+
+#ifndef PARALLEL_CHUNK
+#define PARALLEL_CHUNK 256    // PDUs per unit of work
+#endif
+
+/**
+ * @brief Decodes a batch of PDUs, as <b>PDU::decodeBatch</b>, sharing the work among a pool of threads.
+ * The batch is split into chunks. Each thread starts with an equal share of the chunks
+ * and when it runs out takes chunks from the end of another thread's share.
+ * Every thread has its own PDU object and text arena, the texts are copied to the caller's
+ * arena in the original order at the end, so the result is exactly as <b>PDU::decodeBatch</b>.
+ * One batch at a time, <b>decode</b> must not be called from several threads at once.
+ */
+class PDUParallelDecoder
+{
+public:
+  /**
+   * @brief Construct a decoder and start its threads
+   *
+   * @param threads Number of threads including the caller's, 0 for 1 per CPU
+   */
+  PDUParallelDecoder(int threads = 0);
+  ~PDUParallelDecoder();
+  /**
+   * @brief Decode many PDUs, see <b>PDU::decodeBatch</b>
+   *
+   * @return int Number of PDUs with status BATCH_OK
+   */
+  int decode(const char *const *pdus, int count, PDUBatch *batch);
+  /**
+   * @brief Number of threads including the caller's
+   */
+  int threads();
+private:
+  enum ePhase { PHASE_DECODE, PHASE_COPY };
+  struct alignas(64) Worker {
+    PDU pdu;
+    std::vector<char> arena;
+    size_t used;
+    std::atomic<unsigned long long> chunks;  // next chunk in the low 32 bits, end in the high 32 bits
+  };
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<std::thread> pool;
+  std::mutex mutex;
+  std::condition_variable start;
+  std::condition_variable done;
+  unsigned long job;      // incremented to start each phase
+  int running;            // pool threads still working on the phase
+  bool stop;
+  // the batch being decoded
+  ePhase phase;
+  const char *const *pdus;
+  int count;
+  PDUBatch *batch;
+  std::vector<unsigned char> status;
+  std::vector<size_t> localOffset;      // in the arena of the worker that decoded it
+  std::vector<unsigned short> textLength;
+  std::vector<unsigned short> owner;    // worker that decoded it
+  std::vector<size_t> offset;           // in the caller's arena
+
+  void threadLoop(int id);
+  void runPhase(ePhase p);
+  void work(int id);
+  int takeChunk(int id);
+  void decodeChunk(int chunk, Worker *w, int id);
+  void copyChunk(int chunk);
+};
+
+#endif
+#endif
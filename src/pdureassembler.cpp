@@ -0,0 +1,202 @@
+/**
+ * @file pdureassembler.cpp
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief Reassemble concatenated SMS from their decoded parts
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * Parts are kept in a fixed pool of buffers, each incomplete message (set)
+ * refers to its parts by pool index. Sets that time out or are evicted return
+ * their buffers to the pool.
+ */
+
+#include <string.h>
+#include <pdureassembler.h>
+
+PDUReassembler::PDUReassembler(unsigned long t, eEvictPolicy p) {
+  timeout = t;
+  policy = p;
+  memset(&stats, 0, sizeof(stats));
+  for (int i = 0; i < REASSEMBLY_MAX_SETS; i++)
+    sets[i].inUse = false;
+  for (int i = 0; i < REASSEMBLY_POOL_SIZE; i++)
+    freeList[i] = i;
+  freeCount = REASSEMBLY_POOL_SIZE;
+  *sender = 0;
+  *message = 0;
+}
+PDUReassembler::~PDUReassembler(){}
+
+void PDUReassembler::setTimeout(unsigned long t) {
+  timeout = t;
+}
+
+void PDUReassembler::setPolicy(eEvictPolicy p) {
+  policy = p;
+}
+
+const char *PDUReassembler::getText() {
+  return message;
+}
+
+const char *PDUReassembler::getSender() {
+  return sender;
+}
+
+const ReassemblyStats *PDUReassembler::getStats() {
+  return &stats;
+}
+
+int PDUReassembler::pending() {
+  int count = 0;
+  for (int i = 0; i < REASSEMBLY_MAX_SETS; i++)
+    if (sets[i].inUse)
+      count++;
+  return count;
+}
+
+eReassembly PDUReassembler::addPart(PDU &pdu, unsigned long now) {
+  const UDH *udh = pdu.getUDH();
+  stats.parts++;
+  expire(now);
+  // not concatenated, or concatenated with only 1 part
+  if (udh == NULL || (udh->iei != IEI_CSM_8 && udh->iei != IEI_CSM_16) || udh->ied.total == 1) {
+    strncpy(sender, pdu.getSender(), MAX_NUMBER_LENGTH - 1);
+    sender[MAX_NUMBER_LENGTH - 1] = 0;
+    strncpy(message, pdu.getText(), sizeof(message) - 1);
+    message[sizeof(message) - 1] = 0;
+    stats.completed++;
+    return REASSEMBLY_COMPLETE;
+  }
+  unsigned char total = udh->ied.total;
+  unsigned char part = udh->ied.part;
+  if (total == 0 || total > REASSEMBLY_MAX_PARTS || part == 0 || part > total) {
+    stats.invalid++;
+    return REASSEMBLY_INVALID;
+  }
+  Set *set = findSet(pdu.getSender(), udh->ied.number, total);
+  if (set == NULL) {
+    set = allocSet(now);
+    if (set == NULL) {
+      stats.dropped++;
+      return REASSEMBLY_DROPPED;
+    }
+    strncpy(set->sender, pdu.getSender(), MAX_NUMBER_LENGTH - 1);
+    set->sender[MAX_NUMBER_LENGTH - 1] = 0;
+    set->number = udh->ied.number;
+    set->total = total;
+    set->created = now;
+  }
+  if (set->slot[part - 1] >= 0) {
+    stats.duplicates++;
+    return REASSEMBLY_DUPLICATE;
+  }
+  if (freeCount == 0 && policy == EVICT_LRU) {
+    Set *victim = oldestSet(set);
+    if (victim != NULL) {
+      releaseSet(victim);
+      stats.evicted++;
+    }
+  }
+  if (freeCount == 0) {
+    if (set->received == 0)
+      releaseSet(set);
+    stats.dropped++;
+    return REASSEMBLY_DROPPED;
+  }
+  // save the part
+  int slot = freeList[--freeCount];
+  const char *text = pdu.getText();
+  int length = strlen(text);
+  if (length > REASSEMBLY_PART_LENGTH)
+    length = REASSEMBLY_PART_LENGTH;
+  memcpy(pool[slot].text, text, length);
+  pool[slot].length = length;
+  set->slot[part - 1] = slot;
+  set->received++;
+  set->updated = now;
+  if (set->received < set->total)
+    return REASSEMBLY_PENDING;
+  join(set);
+  releaseSet(set);
+  stats.completed++;
+  return REASSEMBLY_COMPLETE;
+}
+
+int PDUReassembler::expire(unsigned long now) {
+  int count = 0;
+  if (timeout == 0)
+    return 0;
+  for (int i = 0; i < REASSEMBLY_MAX_SETS; i++) {
+    if (sets[i].inUse && now - sets[i].created >= timeout) {
+      releaseSet(&sets[i]);
+      count++;
+    }
+  }
+  stats.expired += count;
+  return count;
+}
+
+PDUReassembler::Set *PDUReassembler::findSet(const char *from, unsigned short number, unsigned char total) {
+  for (int i = 0; i < REASSEMBLY_MAX_SETS; i++) {
+    Set *set = &sets[i];
+    if (set->inUse && set->number == number && set->total == total && strcmp(set->sender, from) == 0)
+      return set;
+  }
+  return NULL;
+}
+
+// get an unused set, evicting one if policy allows
+PDUReassembler::Set *PDUReassembler::allocSet(unsigned long now) {
+  Set *set = NULL;
+  for (int i = 0; i < REASSEMBLY_MAX_SETS && set == NULL; i++)
+    if (!sets[i].inUse)
+      set = &sets[i];
+  if (set == NULL && policy == EVICT_LRU) {
+    set = oldestSet(NULL);
+    if (set != NULL) {
+      releaseSet(set);
+      stats.evicted++;
+    }
+  }
+  if (set != NULL) {
+    set->inUse = true;
+    set->received = 0;
+    set->updated = now;
+    for (int i = 0; i < REASSEMBLY_MAX_PARTS; i++)
+      set->slot[i] = -1;
+  }
+  return set;
+}
+
+// least recently updated set holding at least 1 part
+PDUReassembler::Set *PDUReassembler::oldestSet(Set *exclude) {
+  Set *oldest = NULL;
+  for (int i = 0; i < REASSEMBLY_MAX_SETS; i++) {
+    Set *set = &sets[i];
+    if (set->inUse && set != exclude && set->received > 0)
+      if (oldest == NULL || (long)(set->updated - oldest->updated) < 0)
+        oldest = set;
+  }
+  return oldest;
+}
+
+void PDUReassembler::releaseSet(Set *set) {
+  for (int i = 0; i < set->total && i < REASSEMBLY_MAX_PARTS; i++)
+    if (set->slot[i] >= 0)
+      freeList[freeCount++] = set->slot[i];
+  set->inUse = false;
+}
+
+void PDUReassembler::join(Set *set) {
+  int offset = 0;
+  for (int i = 0; i < set->total; i++) {
+    Part *p = &pool[(int)set->slot[i]];
+    memcpy(&message[offset], p->text, p->length);
+    offset += p->length;
+  }
+  message[offset] = 0;
+  strcpy(sender, set->sender);
+}
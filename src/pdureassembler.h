@@ -0,0 +1,144 @@
+/**
+ * @file pdureassembler.h
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief Reassemble concatenated SMS from their decoded parts
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ * @
+ */
+
+#ifdef PDU_REASSEMBLER_INCLUDE
+#else
+#define PDU_REASSEMBLER_INCLUDE
+
+#include <pdulib.h>
+
+// capacities, may be overridden from the compiler command line
+#ifndef REASSEMBLY_MAX_SETS
+#define REASSEMBLY_MAX_SETS 8       // incomplete messages held at one time
+#endif
+#ifndef REASSEMBLY_MAX_PARTS
+#define REASSEMBLY_MAX_PARTS 8      // largest number of parts accepted per message
+#endif
+#ifndef REASSEMBLY_POOL_SIZE
+#define REASSEMBLY_POOL_SIZE 16     // part buffers shared by all incomplete messages, at most 32767
+#endif
+#define REASSEMBLY_PART_LENGTH MAX_TEXT_LENGTH  // same as PDU::getText
+
+enum eReassembly {
+  REASSEMBLY_COMPLETE,    // message complete, retrieve with getText
+  REASSEMBLY_PENDING,     // part saved, waiting for more
+  REASSEMBLY_DUPLICATE,   // part already received, ignored
+  REASSEMBLY_DROPPED,     // no room to save the part
+  REASSEMBLY_INVALID      // part number or total out of range
+};
+
+// what to do with a new part when all sets or buffers are in use
+enum eEvictPolicy {
+  EVICT_LRU,      // discard the least recently updated incomplete message
+  EVICT_NONE      // discard the new part
+};
+
+struct ReassemblyStats {
+  unsigned long parts;        // parts offered to addPart
+  unsigned long completed;    // messages delivered, including single part
+  unsigned long duplicates;
+  unsigned long dropped;      // parts discarded for lack of room
+  unsigned long invalid;
+  unsigned long expired;      // incomplete messages discarded by timeout
+  unsigned long evicted;      // incomplete messages discarded by LRU policy
+};
+
+/**
+ * @brief Collects the parts of concatenated messages, in any order, until complete.
+ * All memory is allocated inside the object, nothing is allocated at run time.
+ * Messages are identified by sender, reference number and total number of parts.
+ * Time is supplied by the caller in any unit e.g. millis() or seconds, the timeout uses the same unit.
+ */
+class PDUReassembler
+{
+public:
+  /**
+   * @brief Construct a new reassembler
+   *
+   * @param timeout Incomplete messages older than this are discarded, 0 to keep them until evicted
+   * @param policy What to do when there is no room for a new part
+   */
+  PDUReassembler(unsigned long timeout = 0, eEvictPolicy policy = EVICT_LRU);
+  ~PDUReassembler();
+  /**
+   * @brief Add a part from a PDU that has just been successfully decoded.
+   * A PDU without a concatenation header is a complete message by itself.
+   *
+   * @param pdu The PDU object after a successful <b>decodePDU</b>
+   * @param now Current time
+   * @return eReassembly REASSEMBLY_COMPLETE when the message can be retrieved with <b>getText</b>
+   */
+  eReassembly addPart(PDU &pdu, unsigned long now);
+  /**
+   * @brief Discard incomplete messages that have timed out.
+   * This is also done by <b>addPart</b>, call it when no parts arrive for a long time.
+   *
+   * @param now Current time
+   * @return int Number of messages discarded
+   */
+  int expire(unsigned long now);
+  /**
+   * @brief Get the joined text of the last completed message
+   *
+   * @return const char* The message in UTF-8 format.
+   */
+  const char *getText();
+  /**
+   * @brief Get the sender of the last completed message
+   *
+   * @return const char* Pointer to the number
+   */
+  const char *getSender();
+  /**
+   * @brief Get the counters
+   *
+   * @return const ReassemblyStats* The counters since construction
+   */
+  const ReassemblyStats *getStats();
+  /**
+   * @brief Number of incomplete messages currently held
+   */
+  int pending();
+  void setTimeout(unsigned long timeout);
+  void setPolicy(eEvictPolicy policy);
+private:
+  struct Set {
+    bool inUse;
+    char sender[MAX_NUMBER_LENGTH];
+    unsigned short number;
+    unsigned char total;
+    unsigned char received;
+    unsigned long created;      // for timeout
+    unsigned long updated;      // for LRU
+    short slot[REASSEMBLY_MAX_PARTS];  // index into pool, -1 if not yet received
+  };
+  struct Part {
+    short length;
+    char text[REASSEMBLY_PART_LENGTH];
+  };
+  unsigned long timeout;
+  eEvictPolicy policy;
+  ReassemblyStats stats;
+  Set sets[REASSEMBLY_MAX_SETS];
+  Part pool[REASSEMBLY_POOL_SIZE];
+  short freeList[REASSEMBLY_POOL_SIZE];
+  int freeCount;
+  char sender[MAX_NUMBER_LENGTH];
+  char message[REASSEMBLY_MAX_PARTS * REASSEMBLY_PART_LENGTH + 1];
+
+  Set *findSet(const char *sender, unsigned short number, unsigned char total);
+  Set *allocSet(unsigned long now);
+  Set *oldestSet(Set *exclude);
+  void releaseSet(Set *set);
+  void join(Set *set);
+};
+
+#endif
@@ -0,0 +1,165 @@
+/**
+ * @file pdureceipts.cpp
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief Match status reports to the SMS they report on
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * Entries are kept in a fixed array, linked oldest to newest so that expiry
+ * and eviction start with the oldest, and found through an open addressing
+ * hash table with linear probing. The table has twice as many slots as there
+ * are entries, so a probe sequence is short and always ends at an empty slot.
+ * Removal shifts the rest of a probe sequence back rather than leaving a
+ * tombstone, so the table never needs rebuilding.
+ * The recipient is only kept as part of the hash: two SMS with the same
+ * reference are told apart by their recipient unless the 32 bit hashes collide.
+ */
+
+#include <string.h>
+#include <pdureceipts.h>
+
+PDUReceiptIndex::PDUReceiptIndex(unsigned long t) {
+  timeout = t;
+  memset(&stats, 0, sizeof(stats));
+  for (int i = 0; i < RECEIPT_TABLE_SIZE; i++)
+    slots[i] = -1;
+  for (int i = 0; i < RECEIPT_MAX_PENDING; i++)
+    entries[i].newer = i + 1 < RECEIPT_MAX_PENDING ? i + 1 : -1;
+  freeList = 0;
+  oldest = -1;
+  newest = -1;
+  count = 0;
+}
+PDUReceiptIndex::~PDUReceiptIndex(){}
+
+void PDUReceiptIndex::setTimeout(unsigned long t) {
+  timeout = t;
+}
+
+const ReceiptStats *PDUReceiptIndex::getStats() {
+  return &stats;
+}
+
+int PDUReceiptIndex::pending() {
+  return count;
+}
+
+// FNV-1a of the digits and the reference, finished so that the low bits are well mixed
+unsigned long PDUReceiptIndex::hashKey(unsigned char reference, const char *recipient) {
+  unsigned long h = 2166136261ul;
+  if (*recipient == '+')
+    recipient++;
+  for (; *recipient; recipient++) {
+    h ^= (unsigned char)*recipient;
+    h = (h * 16777619ul) & 0xfffffffful;
+  }
+  h ^= reference;
+  h = (h * 16777619ul) & 0xfffffffful;
+  h ^= h >> 15;
+  h = (h * 0x2c1b3c6dul) & 0xfffffffful;
+  h ^= h >> 12;
+  return h;
+}
+
+// slot holding the entry, -1 if there is none
+int PDUReceiptIndex::findSlot(unsigned long key, unsigned char reference) {
+  for (int i = key % RECEIPT_TABLE_SIZE; slots[i] >= 0; i = (i + 1) % RECEIPT_TABLE_SIZE) {
+    const Entry *e = &entries[slots[i]];
+    if (e->key == key && e->reference == reference)
+      return i;
+  }
+  return -1;
+}
+
+// forget the entry in slot, which must be in use
+void PDUReceiptIndex::remove(int slot) {
+  int index = slots[slot];
+  Entry *e = &entries[index];
+  if (e->older >= 0)
+    entries[e->older].newer = e->newer;
+  else
+    oldest = e->newer;
+  if (e->newer >= 0)
+    entries[e->newer].older = e->older;
+  else
+    newest = e->older;
+  e->newer = freeList;
+  freeList = index;
+  count--;
+  // move back each later entry of the probe sequence that may no longer be reached
+  int hole = slot;
+  for (int i = (slot + 1) % RECEIPT_TABLE_SIZE; slots[i] >= 0; i = (i + 1) % RECEIPT_TABLE_SIZE) {
+    int home = entries[slots[i]].key % RECEIPT_TABLE_SIZE;
+    bool reachable = hole <= i ? home > hole && home <= i : home > hole || home <= i;
+    if (!reachable) {
+      slots[hole] = slots[i];
+      hole = i;
+    }
+  }
+  slots[hole] = -1;
+}
+
+void PDUReceiptIndex::add(unsigned char reference, const char *recipient, unsigned long tag, unsigned long now) {
+  unsigned long key = hashKey(reference, recipient);
+  stats.added++;
+  expire(now);
+  int slot = findSlot(key, reference);
+  if (slot >= 0) {    // the reference has wrapped, the old report is not coming
+    remove(slot);
+    stats.evicted++;
+  }
+  if (count == RECEIPT_MAX_PENDING) {
+    remove(findSlot(entries[oldest].key, entries[oldest].reference));
+    stats.evicted++;
+  }
+  int index = freeList;
+  Entry *e = &entries[index];
+  freeList = e->newer;
+  e->key = key;
+  e->reference = reference;
+  e->tag = tag;
+  e->sent = now;
+  e->older = newest;
+  e->newer = -1;
+  if (newest >= 0)
+    entries[newest].newer = index;
+  else
+    oldest = index;
+  newest = index;
+  count++;
+  for (slot = key % RECEIPT_TABLE_SIZE; slots[slot] >= 0; slot = (slot + 1) % RECEIPT_TABLE_SIZE)
+    ;
+  slots[slot] = index;
+}
+
+bool PDUReceiptIndex::match(unsigned char reference, const char *recipient, bool final, unsigned long *tag) {
+  int slot = findSlot(hashKey(reference, recipient), reference);
+  if (slot < 0) {
+    stats.unknown++;
+    return false;
+  }
+  *tag = entries[slots[slot]].tag;
+  if (final)
+    remove(slot);
+  stats.matched++;
+  return true;
+}
+
+bool PDUReceiptIndex::match(const PDUStatusReport *report, unsigned long *tag) {
+  bool final = pduDeliveryState(report->status) != DELIVERY_PENDING;
+  return match(report->reference, report->recipient, final, tag);
+}
+
+int PDUReceiptIndex::expire(unsigned long now) {
+  int expired = 0;
+  if (timeout == 0)
+    return 0;
+  while (oldest >= 0 && now - entries[oldest].sent >= timeout) {
+    remove(findSlot(entries[oldest].key, entries[oldest].reference));
+    expired++;
+  }
+  stats.expired += expired;
+  return expired;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file pdureceipts.h
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief Match status reports to the SMS they report on
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ * @
+ */
+
+#ifdef PDU_RECEIPTS_INCLUDE
+#else
+#define PDU_RECEIPTS_INCLUDE
+
+#include <pdulib.h>
+
+// capacity, may be overridden from the compiler command line
+#ifndef RECEIPT_MAX_PENDING
+#define RECEIPT_MAX_PENDING 128     // SMS awaiting a final status report at one time, at most 32767
+#endif
+#define RECEIPT_TABLE_SIZE (RECEIPT_MAX_PENDING * 2)  // hash slots, kept at most half full
+
+struct ReceiptStats {
+  unsigned long added;        // SMS offered to add
+  unsigned long matched;      // reports that found their SMS
+  unsigned long unknown;      // reports for no SMS held, e.g. already expired
+  unsigned long expired;      // SMS discarded by timeout
+  unsigned long evicted;      // SMS discarded to make room, or replaced by one with the same reference and recipient
+};
+
+/**
+ * @brief An index of the SMS sent with a status report request, keyed by TP-MR and recipient,
+ * so that each report finds its SMS in constant time however many are awaiting one.
+ * All memory is allocated inside the object, nothing is allocated at run time.
+ * Time is supplied by the caller in any unit e.g. millis() or seconds, the timeout uses the same unit.
+ */
+class PDUReceiptIndex
+{
+public:
+  /**
+   * @brief Construct a new index
+   *
+   * @param timeout SMS with no final report after this long are discarded, 0 to keep them until evicted
+   */
+  PDUReceiptIndex(unsigned long timeout = 0);
+  ~PDUReceiptIndex();
+  /**
+   * @brief Remember an SMS that has just been sent.
+   * If the index is full the oldest SMS is discarded to make room.
+   *
+   * @param reference TP-MR, from <b>getMessageReference</b> or the +CMGS response of the modem
+   * @param recipient Phone number as given to the encoder, a leading '+' is ignored
+   * @param tag Any value of the caller's, e.g. a row id, returned by <b>match</b>
+   * @param now Current time
+   */
+  void add(unsigned char reference, const char *recipient, unsigned long tag, unsigned long now);
+  /**
+   * @brief Find the SMS a status report is for. It is forgotten if the report is final,
+   * i.e. unless <b>pduDeliveryState</b> is DELIVERY_PENDING.
+   *
+   * @param report Filled in by <b>decodeStatusReport</b>
+   * @param tag Receives the tag given to <b>add</b>
+   * @return true If the SMS was found
+   */
+  bool match(const PDUStatusReport *report, unsigned long *tag);
+  /**
+   * @brief As above, from the reference and recipient
+   *
+   * @param final Forget the SMS once found
+   */
+  bool match(unsigned char reference, const char *recipient, bool final, unsigned long *tag);
+  /**
+   * @brief Discard SMS that have timed out.
+   * This is also done by <b>add</b>. The oldest are checked first, so the cost is that of those discarded.
+   *
+   * @param now Current time
+   * @return int Number of SMS discarded
+   */
+  int expire(unsigned long now);
+  /**
+   * @brief Number of SMS awaiting a final report
+   */
+  int pending();
+  /**
+   * @brief Get the counters
+   *
+   * @return const ReceiptStats* The counters since construction
+   */
+  const ReceiptStats *getStats();
+  void setTimeout(unsigned long timeout);
+private:
+  // in a list oldest first, or the free list
+  struct Entry {
+    unsigned long key;          // hash of recipient and reference
+    unsigned long tag;
+    unsigned long sent;
+    short older, newer;         // -1 at the ends
+    unsigned char reference;
+  };
+  unsigned long timeout;
+  ReceiptStats stats;
+  Entry entries[RECEIPT_MAX_PENDING];
+  short slots[RECEIPT_TABLE_SIZE];   // index into entries, -1 if empty
+  short oldest, newest;
+  short freeList;               // linked through newer
+  int count;
+
+  static unsigned long hashKey(unsigned char reference, const char *recipient);
+  int findSlot(unsigned long key, unsigned char reference);
+  void remove(int slot);
+};
+
+#endif
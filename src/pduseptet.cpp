@@ -0,0 +1,218 @@
+/**
+ * @file pduseptet.cpp
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief Packing and unpacking of GSM 7 bit septets
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * 8 septets occupy exactly 7 octets. The word kernels gather 8 septets into
+ * 56 bits of a 64 bit word, shift that to the bit position of the first septet
+ * and merge it into the output. As the user data may start after a UDH the
+ * position need not be on an octet boundary. A word is only read or written
+ * when it lies entirely inside the packed data, the rest is done 1 septet at a time.
+ * The kernel is chosen at run time according to the CPU.
+ */
+
+#include <string.h>
+#include <pduseptet.h>
+#ifdef PDU_SEPTET_BMI2
+#include <immintrin.h>
+#endif
+#ifdef PDU_SEPTET_SWAR
+#include <stdint.h>
+#endif
+
+#define SEPTET_MASK 0x7f
+
+static void packScalar(const unsigned char *septets, int count, unsigned char *out, int bitpos) {
+  for (int r = 0; r < count; r++) {
+    unsigned char septet = septets[r] & SEPTET_MASK;
+    int shift = bitpos & 7;
+    out[bitpos >> 3] |= septet << shift;
+    if (shift > 1)
+      out[(bitpos >> 3) + 1] |= septet >> (8 - shift);
+    bitpos += 7;
+  }
+}
+
+static void unpackScalar(const unsigned char *in, int bitpos, int count, unsigned char *septets) {
+  for (int w = 0; w < count; w++) {
+    int octet = bitpos >> 3;
+    int shift = bitpos & 7;
+    unsigned int x = in[octet] >> shift;
+    if (shift > 1)
+      x |= in[octet + 1] << (8 - shift);
+    septets[w] = x & SEPTET_MASK;
+    bitpos += 7;
+  }
+}
+
+#ifdef PDU_SEPTET_SWAR
+// 8 septets, 1 per octet, to 56 bits
+static inline uint64_t gatherSWAR(uint64_t x) {
+  x &= 0x7f7f7f7f7f7f7f7fULL;
+  x = ((x >> 1) & 0x3f803f803f803f80ULL) | (x & 0x007f007f007f007fULL);
+  x = ((x >> 2) & 0x0fffc0000fffc000ULL) | (x & 0x00003fff00003fffULL);
+  x = ((x >> 4) & 0x00fffffff0000000ULL) | (x & 0x000000000fffffffULL);
+  return x;
+}
+
+// 56 bits to 8 septets, 1 per octet
+static inline uint64_t scatterSWAR(uint64_t x) {
+  x &= 0x00ffffffffffffffULL;
+  x = ((x & 0x00fffffff0000000ULL) << 4) | (x & 0x000000000fffffffULL);
+  x = ((x & 0x0fffc0000fffc000ULL) << 2) | (x & 0x00003fff00003fffULL);
+  x = ((x & 0x3f803f803f803f80ULL) << 1) | (x & 0x007f007f007f007fULL);
+  return x;
+}
+
+/*
+    The word loops are always inlined so that the gather/scatter can be inlined
+    into them even when those need a target attribute.
+    Packing: 56 bits shifted by up to 7 always fit in the 8 octets from bitpos/8,
+    the octets after bitpos/8 have already been cleared.
+    Unpacking: the 8 octets from bitpos/8 hold all 56 bits.
+*/
+template <uint64_t (*gather)(uint64_t)>
+static inline __attribute__((always_inline)) void packWords(const unsigned char *septets, int count, unsigned char *out, int bitpos, int octets) {
+  int r = 0;
+  // 56 bits advance exactly 7 octets, the 8th octet is carried to the next word instead of read back
+  uint64_t carry = out[bitpos >> 3];
+  for (; r + 8 <= count && (bitpos >> 3) + 8 <= octets; r += 8, bitpos += 56) {
+    uint64_t s;
+    memcpy(&s, &septets[r], 8);
+    uint64_t word = carry | (gather(s) << (bitpos & 7));
+    memcpy(&out[bitpos >> 3], &word, 8);
+    carry = word >> 56;
+  }
+  packScalar(&septets[r], count - r, out, bitpos);
+}
+
+template <uint64_t (*scatter)(uint64_t)>
+static inline __attribute__((always_inline)) void unpackWords(const unsigned char *in, int bitpos, int count, unsigned char *septets, int octets) {
+  int w = 0;
+  for (; w + 8 <= count && (bitpos >> 3) + 8 <= octets; w += 8, bitpos += 56) {
+    uint64_t word;
+    memcpy(&word, &in[bitpos >> 3], 8);
+    word = scatter(word >> (bitpos & 7));
+    memcpy(&septets[w], &word, 8);
+  }
+  unpackScalar(in, bitpos, count - w, &septets[w]);
+}
+#endif
+
+#ifdef PDU_SEPTET_BMI2
+__attribute__((target("bmi2")))
+static inline uint64_t gatherBMI2(uint64_t x) {
+  return _pext_u64(x, 0x7f7f7f7f7f7f7f7fULL);
+}
+
+__attribute__((target("bmi2")))
+static inline uint64_t scatterBMI2(uint64_t x) {
+  return _pdep_u64(x, 0x7f7f7f7f7f7f7f7fULL);
+}
+
+__attribute__((target("bmi2")))
+static void packBMI2(const unsigned char *septets, int count, unsigned char *out, int bitpos, int octets) {
+  packWords<gatherBMI2>(septets, count, out, bitpos, octets);
+}
+
+__attribute__((target("bmi2")))
+static void unpackBMI2(const unsigned char *in, int bitpos, int count, unsigned char *septets, int octets) {
+  unpackWords<scatterBMI2>(in, bitpos, count, septets, octets);
+}
+
+static bool detectBMI2() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("bmi2");
+}
+
+static const bool hasBMI2 = detectBMI2();
+
+static eSeptetKernel bestKernel() {
+  // PEXT/PDEP are microcoded and slow before Zen 3
+  if (hasBMI2 && !__builtin_cpu_is("znver1") && !__builtin_cpu_is("znver2"))
+    return SEPTET_KERNEL_BMI2;
+  return SEPTET_KERNEL_SWAR;
+}
+
+// decided once at load time and never changed
+static const eSeptetKernel autoKernel = bestKernel();
+#elif defined(PDU_SEPTET_SWAR)
+static const eSeptetKernel autoKernel = SEPTET_KERNEL_SWAR;
+#else
+static const eSeptetKernel autoKernel = SEPTET_KERNEL_SCALAR;
+#endif
+
+bool pduSeptetKernelSupported(eSeptetKernel kernel) {
+  switch (kernel) {
+#ifdef PDU_SEPTET_BMI2
+    case SEPTET_KERNEL_BMI2:
+      return hasBMI2;
+#endif
+#ifdef PDU_SEPTET_SWAR
+    case SEPTET_KERNEL_SWAR:
+      return true;
+#endif
+    case SEPTET_KERNEL_AUTO:
+    case SEPTET_KERNEL_SCALAR:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static eSeptetKernel chooseKernel(eSeptetKernel kernel) {
+  if (kernel == SEPTET_KERNEL_AUTO)
+    return autoKernel;
+  if (!pduSeptetKernelSupported(kernel))
+    return SEPTET_KERNEL_SCALAR;
+  return kernel;
+}
+
+int pduPackSeptets(const unsigned char *septets, int count, unsigned char *out, int startSeptet, eSeptetKernel kernel) {
+  int bitpos = startSeptet * 7;
+  int octets = (bitpos + count * 7 + 7) / 8;
+  memset(&out[bitpos / 8], 0, octets - bitpos / 8);
+  switch (chooseKernel(kernel)) {
+#ifdef PDU_SEPTET_BMI2
+    case SEPTET_KERNEL_BMI2:
+      packBMI2(septets, count, out, bitpos, octets);
+      break;
+#endif
+#ifdef PDU_SEPTET_SWAR
+    case SEPTET_KERNEL_SWAR:
+      packWords<gatherSWAR>(septets, count, out, bitpos, octets);
+      break;
+#endif
+    default:
+      packScalar(septets, count, out, bitpos);
+      break;
+  }
+  return octets;
+}
+
+int pduUnpackSeptets(const unsigned char *in, int startSeptet, int count, unsigned char *septets, eSeptetKernel kernel) {
+  int bitpos = startSeptet * 7;
+  int octets = (bitpos + count * 7 + 7) / 8;
+  if (count <= 0)
+    return 0;
+  switch (chooseKernel(kernel)) {
+#ifdef PDU_SEPTET_BMI2
+    case SEPTET_KERNEL_BMI2:
+      unpackBMI2(in, bitpos, count, septets, octets);
+      break;
+#endif
+#ifdef PDU_SEPTET_SWAR
+    case SEPTET_KERNEL_SWAR:
+      unpackWords<scatterSWAR>(in, bitpos, count, septets, octets);
+      break;
+#endif
+    default:
+      unpackScalar(in, bitpos, count, septets);
+      break;
+  }
+  return count;
+}
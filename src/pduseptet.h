@@ -0,0 +1,61 @@
+/**
+ * @file pduseptet.h
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief Packing and unpacking of GSM 7 bit septets
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ * @
+ */
+
+#ifdef PDU_SEPTET_INCLUDE
+#else
+#define PDU_SEPTET_INCLUDE
+
+// 8 septets at a time in a 64 bit word, little endian CPUs with fast 64 bit arithmetic only
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && !defined(__AVR__)
+#define PDU_SEPTET_SWAR
+#endif
+// PEXT/PDEP are only built for x86 with gcc/clang
+#if defined(PDU_SEPTET_SWAR) && defined(__GNUC__) && defined(__x86_64__)
+#define PDU_SEPTET_BMI2
+#endif
+
+enum eSeptetKernel {
+  SEPTET_KERNEL_AUTO,     // best for this CPU
+  SEPTET_KERNEL_SCALAR,   // 1 septet at a time
+  SEPTET_KERNEL_SWAR,     // 8 septets with shifts and masks
+  SEPTET_KERNEL_BMI2      // 8 septets with PEXT/PDEP
+};
+
+/**
+ * @brief Pack septets into octets, starting at septet position startSeptet.
+ * Octets before that position, e.g. a UDH, are kept. Fill bits following them are left 0.
+ *
+ * @param septets The septets, bit 7 is ignored
+ * @param count Number of septets
+ * @param out Receives the packed septets
+ * @param startSeptet Septets to skip at the start of out
+ * @param kernel Force a kernel, for benchmarks. An unsupported kernel falls back to the scalar code
+ * @return int Number of octets used in out, including those skipped
+ */
+int pduPackSeptets(const unsigned char *septets, int count, unsigned char *out, int startSeptet, eSeptetKernel kernel = SEPTET_KERNEL_AUTO);
+/**
+ * @brief Unpack septets from octets, starting at septet position startSeptet.
+ * No octet past the last septet is read.
+ *
+ * @param in The packed septets
+ * @param startSeptet Septets to skip at the start of in
+ * @param count Number of septets
+ * @param septets Receives count septets
+ * @param kernel Force a kernel, for benchmarks. An unsupported kernel falls back to the scalar code
+ * @return int count
+ */
+int pduUnpackSeptets(const unsigned char *in, int startSeptet, int count, unsigned char *septets, eSeptetKernel kernel = SEPTET_KERNEL_AUTO);
+/**
+ * @brief Check if the CPU supports a kernel
+ */
+bool pduSeptetKernelSupported(eSeptetKernel kernel);
+
+#endif
@@ -0,0 +1,134 @@
+/**
+ * @file pdutranslit.cpp
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief Close matches in the GSM 7 bit default alphabet for characters it does not have
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ *
+ * Latin-1 uses the close matches already in lookup_ascii8to7 (negated entries).
+ * Blocks where nearly every character has a match are indexed by codepoint:
+ * Latin Extended-A by a single letter each, Cyrillic by up to 4. Everything
+ * else is a short list sorted by codepoint for a binary search.
+ * Replacements only use letters, digits and punctuation whose septet is their
+ * ASCII code, so they are copied as is.
+ */
+
+#include <string.h>
+#include <pdulib.h>
+#include <pdutranslit.h>
+#ifdef PM
+#include <avr/pgmspace.h>
+#endif
+
+#define LATIN_EXT_A_FIRST 0x0100
+#define CYRILLIC_FIRST 0x0400
+#define CYRILLIC_WIDTH (TRANSLIT_MAX_SEPTETS + 1)
+
+// U+0100 to U+017F, ligatures are in the list below
+static const
+#ifdef PM
+      PROGMEM
+#endif
+char latinExtA[] =
+  "AaAaAaCcCcCcCcDdDdEeEeEeEeEeGgGgGgGgHhHhIiIiIiIiIi"   // 0100-0131
+  "  JjKkkLlLlLlLlLlNnNnNnnNnOoOoOo  RrRrRrSsSsSsSsTt"   // 0132-0163
+  "TtTtUuUuUuUuUuUuWwYyYZzZzZzs";                        // 0164-017F
+
+// U+0400 to U+045F
+static const
+#ifdef PM
+      PROGMEM
+#endif
+char cyrillic[][CYRILLIC_WIDTH] = {
+  "E", "Yo", "Dj", "Gj", "Ye", "Dz", "I", "Yi", "J", "Lj", "Nj", "C", "Kj", "I", "U", "Dz",
+  "A", "B", "V", "G", "D", "E", "Zh", "Z", "I", "Y", "K", "L", "M", "N", "O", "P",
+  "R", "S", "T", "U", "F", "Kh", "Ts", "Ch", "Sh", "Shch", "'", "Y", "'", "E", "Yu", "Ya",
+  "a", "b", "v", "g", "d", "e", "zh", "z", "i", "y", "k", "l", "m", "n", "o", "p",
+  "r", "s", "t", "u", "f", "kh", "ts", "ch", "sh", "shch", "'", "y", "'", "e", "yu", "ya",
+  "e", "yo", "dj", "gj", "ye", "dz", "i", "yi", "j", "lj", "nj", "c", "kj", "i", "u", "dz"
+};
+
+static const struct Translit {
+  unsigned short cp;
+  char text[TRANSLIT_MAX_SEPTETS];    // not terminated if all 4 are used
+}
+#ifdef PM
+  PROGMEM
+#endif
+others[] = {
+  {0x00A9, "(c)"}, {0x00AA, "a"}, {0x00AC, "-"}, {0x00AE, "(R)"}, {0x00AF, "-"},
+  {0x00B0, "o"}, {0x00B1, "+-"}, {0x00B7, "."}, {0x00B8, ","}, {0x00BA, "o"},
+  {0x00BC, "1/4"}, {0x00BD, "1/2"}, {0x00BE, "3/4"}, {0x00DE, "Th"}, {0x00F0, "d"},
+  {0x00FE, "th"},
+  {0x0132, "IJ"}, {0x0133, "ij"}, {0x0152, "OE"}, {0x0153, "oe"},
+  {0x0490, "G"}, {0x0491, "g"},
+  {0x2002, " "}, {0x2003, " "}, {0x2004, " "}, {0x2005, " "}, {0x2006, " "},
+  {0x2007, " "}, {0x2008, " "}, {0x2009, " "}, {0x200A, " "},
+  {0x2010, "-"}, {0x2011, "-"}, {0x2012, "-"}, {0x2013, "-"}, {0x2014, "-"}, {0x2015, "-"},
+  {0x2018, "'"}, {0x2019, "'"}, {0x201A, "'"}, {0x201B, "'"},
+  {0x201C, "\""}, {0x201D, "\""}, {0x201E, "\""}, {0x201F, "\""},
+  {0x2020, "+"}, {0x2022, "*"}, {0x2026, "..."}, {0x202F, " "},
+  {0x2032, "'"}, {0x2033, "\""}, {0x2039, "<"}, {0x203A, ">"}, {0x2044, "/"},
+  {0x2122, "TM"}, {0x2212, "-"}
+};
+
+// copy a replacement of up to TRANSLIT_MAX_SEPTETS characters, returns its length
+static int copyText(const char *text, unsigned char *septets) {
+  char buf[TRANSLIT_MAX_SEPTETS];
+#ifdef PM
+  memcpy_P(buf, text, TRANSLIT_MAX_SEPTETS);
+#else
+  memcpy(buf, text, TRANSLIT_MAX_SEPTETS);
+#endif
+  int n = 0;
+  while (n < TRANSLIT_MAX_SEPTETS && buf[n] != 0) {
+    septets[n] = buf[n];
+    n++;
+  }
+  return n;
+}
+
+int pduTransliterate(unsigned long cp, unsigned char *septets) {
+  if (cp >= 0xA0 && cp <= 0xFF) {
+#ifdef PM
+    short x = (short)pgm_read_word_near(lookup_ascii8to7 + cp);
+#else
+    short x = lookup_ascii8to7[cp];
+#endif
+    if (x < 0) {
+      septets[0] = -x;
+      return 1;
+    }
+  }
+  else if (cp >= LATIN_EXT_A_FIRST && cp < LATIN_EXT_A_FIRST + sizeof(latinExtA) - 1) {
+#ifdef PM
+    char c = pgm_read_byte_near(latinExtA + cp - LATIN_EXT_A_FIRST);
+#else
+    char c = latinExtA[cp - LATIN_EXT_A_FIRST];
+#endif
+    if (c != ' ') {
+      septets[0] = c;
+      return 1;
+    }
+  }
+  else if (cp >= CYRILLIC_FIRST && cp < CYRILLIC_FIRST + sizeof(cyrillic) / CYRILLIC_WIDTH)
+    return copyText(cyrillic[cp - CYRILLIC_FIRST], septets);
+  int low = 0, high = sizeof(others) / sizeof(others[0]) - 1;
+  while (low <= high) {
+    int mid = (low + high) / 2;
+#ifdef PM
+    unsigned short midcp = pgm_read_word_near(&others[mid].cp);
+#else
+    unsigned short midcp = others[mid].cp;
+#endif
+    if (midcp == cp)
+      return copyText(others[mid].text, septets);
+    if (midcp < cp)
+      low = mid + 1;
+    else
+      high = mid - 1;
+  }
+  return 0;
+}
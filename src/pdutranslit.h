@@ -0,0 +1,29 @@
+/**
+ * @file pdutranslit.h
+ * @author David Henry (mgadriver@gmail.com)
+ * @brief Close matches in the GSM 7 bit default alphabet for characters it does not have
+ * @version 0.1
+ * @date 2021-09-23
+ *
+ * @copyright Copyright (c) 2021
+ * @
+ */
+
+#ifdef PDU_TRANSLIT_INCLUDE
+#else
+#define PDU_TRANSLIT_INCLUDE
+
+#define TRANSLIT_MAX_SEPTETS 4    // longest replacement, e.g. Cyrillic shcha
+
+/**
+ * @brief Transliterate a Unicode codepoint into the GSM 7 bit default alphabet.
+ * Covers accented Latin, Cyrillic, typographic quotes, dashes, spaces and ellipsis
+ * and a few symbols. Replacements never need an escape.
+ *
+ * @param cp The codepoint, one not in the GSM 7 bit alphabet
+ * @param septets Receives up to TRANSLIT_MAX_SEPTETS septets
+ * @return int Number of septets, 0 if there is no close match
+ */
+int pduTransliterate(unsigned long cp, unsigned char *septets);
+
+#endif